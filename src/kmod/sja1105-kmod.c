@@ -426,6 +426,7 @@ static int sja1105_probe(struct spi_device *spi)
 
 	INIT_LIST_HEAD(&(priv->port_list_head.list));
 	mutex_init(&priv->lock);
+	mutex_init(&priv->spi_buf_lock);
 
 	mutex_lock(&priv->lock); /* Lock mutex until end of initialization */
 
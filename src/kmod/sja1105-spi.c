@@ -12,8 +12,6 @@
 #include <lib/include/gtable.h>
 #include "sja1105.h"
 
-#define SPI_TRANSFER_SIZE_MAX  (SIZE_SPI_MSG_HEADER + SIZE_SPI_MSG_MAXLEN)
-
 static int sja1105_spi_transfer(const struct sja1105_spi_private *priv,
                                 const void *tx, void *rx, int size)
 {
@@ -77,6 +75,9 @@ static void sja1105_spi_message_access(void  *buf,
  * This function should only be called if it is priorly known that
  * size_bytes is smaller than SIZE_SPI_MSG_MAXLEN. Larger packed buffers
  * are chunked in smaller pieces by sja1105_spi_send_long_packed_buf below.
+ *
+ * The message goes through the preallocated priv->spi_tx_buf and
+ * priv->spi_rx_buf, so packed_buf may live on the caller's stack.
  */
 inline int
 sja1105_spi_send_packed_buf(struct sja1105_spi_private *priv,
@@ -86,28 +87,32 @@ sja1105_spi_send_packed_buf(struct sja1105_spi_private *priv,
 {
 	const int MSG_LEN = size_bytes + SIZE_SPI_MSG_HEADER;
 	struct sja1105_spi_message msg;
-	uint8_t tx_buf[MSG_LEN];
-	uint8_t rx_buf[MSG_LEN];
+	uint8_t *tx_buf = priv->spi_tx_buf;
+	uint8_t *rx_buf = priv->spi_rx_buf;
 	int rc;
 
-	memset(rx_buf, 0, MSG_LEN);
+	if (read_or_write != SPI_READ && read_or_write != SPI_WRITE) {
+		loge("read_or_write must be SPI_READ or SPI_WRITE");
+		return -EINVAL;
+	}
+	if (size_bytes > SIZE_SPI_MSG_MAXLEN) {
+		loge("SPI message of %d bytes too long", MSG_LEN);
+		return -EMSGSIZE;
+	}
 
 	msg.access     = read_or_write;
 	msg.read_count = (read_or_write == SPI_READ) ? (size_bytes / 4) : 0;
 	msg.address    = reg_addr;
-	sja1105_spi_message_pack(tx_buf, &msg);
 
-	if (read_or_write == SPI_READ) {
+	mutex_lock(&priv->spi_buf_lock);
+
+	sja1105_spi_message_pack(tx_buf, &msg);
+	if (read_or_write == SPI_READ)
 		memset(tx_buf + SIZE_SPI_MSG_HEADER, 0, size_bytes);
-	} else if (read_or_write == SPI_WRITE) {
+	else
 		memcpy(tx_buf + SIZE_SPI_MSG_HEADER, /* dest */
 		       packed_buf,                   /* src */
 		       size_bytes);                  /* size */
-	} else {
-		loge("read_or_write must be SPI_READ or SPI_WRITE");
-		rc = -EINVAL;
-		goto out;
-	}
 
 	rc = sja1105_spi_transfer(priv, tx_buf, rx_buf, MSG_LEN);
 	if (rc < 0) {
@@ -120,6 +125,7 @@ sja1105_spi_send_packed_buf(struct sja1105_spi_private *priv,
 		       size_bytes);                  /* size */
 	}
 out:
+	mutex_unlock(&priv->spi_buf_lock);
 	return rc;
 }
 
@@ -140,9 +146,13 @@ sja1105_spi_send_int(struct sja1105_spi_private *priv,
                      enum sja1105_spi_access_mode read_or_write,
                      uint64_t reg_addr, uint64_t *value, uint64_t size_bytes)
 {
-	uint8_t packed_buf[size_bytes];
+	uint8_t packed_buf[sizeof(*value)];
 	int rc;
 
+	if (size_bytes > sizeof(packed_buf)) {
+		loge("Cannot access %d bytes as an integer", (int) size_bytes);
+		return -EINVAL;
+	}
 	if (read_or_write == SPI_WRITE)
 		gtable_pack(packed_buf, value, 8 * size_bytes - 1, 0,
 		            size_bytes);
@@ -158,47 +168,79 @@ sja1105_spi_send_int(struct sja1105_spi_private *priv,
 
 /*
  * Should be used if a packed_buf larger than SIZE_SPI_MSG_MAXLEN must be
- * sent/received. Splitting the buffer into chunks and assembling those
- * into SPI messages is done automatically by this function.
+ * sent/received. The buffer is split into chunks, each of which gets a
+ * header transfer followed by a payload transfer, and all of them go out
+ * in a single spi_message, with chip select toggled between chunks.
+ * The payload transfers point directly into packed_buf, which must
+ * therefore be DMA-safe (i.e. not on the stack).
  */
 int sja1105_spi_send_long_packed_buf(struct sja1105_spi_private *priv,
                                      enum sja1105_spi_access_mode read_or_write,
                                      uint64_t base_addr, char *packed_buf,
                                      uint64_t buf_len)
 {
-	struct chunk {
-		char    *buf_ptr;
-		int      len;
-		uint64_t spi_address;
-	} chunk;
-	int distance_to_end;
-	int rc = 0;
-
-	/* Initialize chunk */
-	chunk.buf_ptr = packed_buf;
-	chunk.spi_address = base_addr;
-	chunk.len = min((int)buf_len, SIZE_SPI_MSG_MAXLEN);
-
-	while (chunk.len) {
-		rc = sja1105_spi_send_packed_buf(priv, read_or_write,
-		                                 chunk.spi_address,
-		                                 chunk.buf_ptr,
-		                                 chunk.len);
-		if (rc < 0) {
-			loge("spi_send_packed_buf returned %d", rc);
-			goto out_send_failed;
-		}
-		chunk.buf_ptr += chunk.len;
-		chunk.spi_address += chunk.len / 4;
-		distance_to_end = (int) ((packed_buf + buf_len) -
-		                          chunk.buf_ptr);
-		chunk.len = min(distance_to_end, SIZE_SPI_MSG_MAXLEN);
+	struct spi_device *spi = priv->spi_dev;
+	struct sja1105_spi_message hdr;
+	struct spi_transfer *xfers;
+	struct spi_message msg;
+	uint8_t *hdr_bufs;
+	int num_chunks;
+	int offset;
+	int len;
+	int rc;
+	int i;
+
+	if (read_or_write != SPI_READ && read_or_write != SPI_WRITE) {
+		loge("read_or_write must be SPI_READ or SPI_WRITE");
+		return -EINVAL;
+	}
+	if (buf_len == 0)
+		return 0;
+
+	num_chunks = DIV_ROUND_UP((int) buf_len, SIZE_SPI_MSG_MAXLEN);
+	/* Two transfers per chunk, followed by the packed chunk headers */
+	xfers = kzalloc(num_chunks * (2 * sizeof(*xfers) + SIZE_SPI_MSG_HEADER),
+	                GFP_KERNEL);
+	if (!xfers) {
+		loge("malloc failed");
+		return -ENOMEM;
+	}
+	hdr_bufs = (uint8_t*) (xfers + 2 * num_chunks);
+
+	spi_message_init(&msg);
+	for (i = 0; i < num_chunks; i++) {
+		offset = i * SIZE_SPI_MSG_MAXLEN;
+		len = min((int) (buf_len - offset), SIZE_SPI_MSG_MAXLEN);
+
+		hdr.access     = read_or_write;
+		hdr.read_count = (read_or_write == SPI_READ) ? (len / 4) : 0;
+		hdr.address    = base_addr + offset / 4;
+		sja1105_spi_message_pack(hdr_bufs + i * SIZE_SPI_MSG_HEADER,
+		                         &hdr);
+
+		xfers[2 * i].tx_buf = hdr_bufs + i * SIZE_SPI_MSG_HEADER;
+		xfers[2 * i].len    = SIZE_SPI_MSG_HEADER;
+		spi_message_add_tail(&xfers[2 * i], &msg);
+
+		if (read_or_write == SPI_READ)
+			xfers[2 * i + 1].rx_buf = packed_buf + offset;
+		else
+			xfers[2 * i + 1].tx_buf = packed_buf + offset;
+		xfers[2 * i + 1].len = len;
+		/* Deassert chip select before the next chunk header,
+		 * but not after the last one */
+		xfers[2 * i + 1].cs_change = (i != num_chunks - 1);
+		spi_message_add_tail(&xfers[2 * i + 1], &msg);
 	}
-out_send_failed:
+
+	rc = spi_sync(spi, &msg);
+	if (rc < 0)
+		dev_err(&spi->dev, "Spi transfer failed: rc = %d\n", rc);
+
+	kfree(xfers);
 	return rc;
 }
 
-
 static int
 static_config_upload(struct sja1105_spi_private *priv,
                      struct sja1105_static_config *config)
@@ -379,6 +379,64 @@ out:
 	return rc;
 }
 
+void sja1105_port_status_show(struct sja1105_port_status *status,
+		char *print_buf,
+		size_t len,
+		uint64_t device_id)
+{
+	char *fmt = "%s\n";
+	int i;
+
+	formatted_append(print_buf, len, fmt, "N_RUNT         %" PRIX64, status->mac.n_runt);
+	formatted_append(print_buf, len, fmt, "N_SOFERR       %" PRIX64, status->mac.n_soferr);
+	formatted_append(print_buf, len, fmt, "N_ALIGNERR     %" PRIX64, status->mac.n_alignerr);
+	formatted_append(print_buf, len, fmt, "N_MIIERR       %" PRIX64, status->mac.n_miierr);
+	formatted_append(print_buf, len, fmt, "TYPEERR        %" PRIX64, status->mac.typeerr);
+	formatted_append(print_buf, len, fmt, "SIZEERR        %" PRIX64, status->mac.sizeerr);
+	formatted_append(print_buf, len, fmt, "TCTIMEOUT      %" PRIX64, status->mac.tctimeout);
+	formatted_append(print_buf, len, fmt, "PRIORERR       %" PRIX64, status->mac.priorerr);
+	formatted_append(print_buf, len, fmt, "NOMASTER       %" PRIX64, status->mac.nomaster);
+	formatted_append(print_buf, len, fmt, "MEMOV          %" PRIX64, status->mac.memov);
+	formatted_append(print_buf, len, fmt, "MEMERR         %" PRIX64, status->mac.memerr);
+	formatted_append(print_buf, len, fmt, "INVTYP         %" PRIX64, status->mac.invtyp);
+	formatted_append(print_buf, len, fmt, "INTCYOV        %" PRIX64, status->mac.intcyov);
+	formatted_append(print_buf, len, fmt, "DOMERR         %" PRIX64, status->mac.domerr);
+	formatted_append(print_buf, len, fmt, "PCFBAGDROP     %" PRIX64, status->mac.pcfbagdrop);
+	formatted_append(print_buf, len, fmt, "SPCPRIOR       %" PRIX64, status->mac.spcprior);
+	formatted_append(print_buf, len, fmt, "AGEPRIOR       %" PRIX64, status->mac.ageprior);
+	formatted_append(print_buf, len, fmt, "PORTDROP       %" PRIX64, status->mac.portdrop);
+	formatted_append(print_buf, len, fmt, "LENDROP        %" PRIX64, status->mac.lendrop);
+	formatted_append(print_buf, len, fmt, "BAGDROP        %" PRIX64, status->mac.bagdrop);
+	formatted_append(print_buf, len, fmt, "POLICEERR      %" PRIX64, status->mac.policeerr);
+	formatted_append(print_buf, len, fmt, "DRPNONA664ERR  %" PRIX64, status->mac.drpnona664err);
+	formatted_append(print_buf, len, fmt, "SPCERR         %" PRIX64, status->mac.spcerr);
+	formatted_append(print_buf, len, fmt, "AGEDRP         %" PRIX64, status->mac.agedrp);
+	formatted_append(print_buf, len, fmt, "N_N664ERR      %" PRIX64, status->hl1.n_n664err);
+	formatted_append(print_buf, len, fmt, "N_VLANERR      %" PRIX64, status->hl1.n_vlanerr);
+	formatted_append(print_buf, len, fmt, "N_UNRELEASED   %" PRIX64, status->hl1.n_unreleased);
+	formatted_append(print_buf, len, fmt, "N_SIZERR       %" PRIX64, status->hl1.n_sizerr);
+	formatted_append(print_buf, len, fmt, "N_CRCERR       %" PRIX64, status->hl1.n_crcerr);
+	formatted_append(print_buf, len, fmt, "N_VLNOTFOUND   %" PRIX64, status->hl1.n_vlnotfound);
+	formatted_append(print_buf, len, fmt, "N_CTPOLERR     %" PRIX64, status->hl1.n_ctpolerr);
+	formatted_append(print_buf, len, fmt, "N_POLERR       %" PRIX64, status->hl1.n_polerr);
+	formatted_append(print_buf, len, fmt, "N_RXFRM        %" PRIX64, status->hl1.n_rxfrm);
+	formatted_append(print_buf, len, fmt, "N_RXBYTE       %" PRIX64, status->hl1.n_rxbyte);
+	formatted_append(print_buf, len, fmt, "N_TXFRM        %" PRIX64, status->hl1.n_txfrm);
+	formatted_append(print_buf, len, fmt, "N_TXBYTE       %" PRIX64, status->hl1.n_txbyte);
+	formatted_append(print_buf, len, fmt, "N_QFULL        %" PRIX64, status->hl2.n_qfull);
+	formatted_append(print_buf, len, fmt, "N_PART_DROP    %" PRIX64, status->hl2.n_part_drop);
+	formatted_append(print_buf, len, fmt, "N_EGR_DISABLED %" PRIX64, status->hl2.n_egr_disabled);
+	formatted_append(print_buf, len, fmt, "N_NOT_REACH    %" PRIX64, status->hl2.n_not_reach);
+	if (!IS_PQRS(device_id))
+		return;
+	for (i = 0; i < 8; i++)
+		formatted_append(print_buf, len, fmt, "QLEVEL_HWM_%d   %" PRIX64,
+		                 i, status->hl2.qlevel_hwm[i]);
+	for (i = 0; i < 8; i++)
+		formatted_append(print_buf, len, fmt, "QLEVEL_%d       %" PRIX64,
+		                 i, status->hl2.qlevel[i]);
+}
+
 int sja1105_port_status_clear(struct sja1105_spi_private *priv,
                               int port)
 {
@@ -153,6 +153,8 @@ static DEVICE_ATTR(device_id,         S_IRUGO,
                    sja1105_sysfs_rd,  NULL);
 static DEVICE_ATTR(general_status,    S_IRUGO,
                    sja1105_sysfs_rd,  NULL);
+static DEVICE_ATTR(port_status,       S_IRUGO | S_IWUSR,
+                   sja1105_sysfs_rd,  sja1105_sysfs_wr);
 static DEVICE_ATTR(port_status_clear, S_IWUSR,
                    NULL,              sja1105_sysfs_wr);
 static DEVICE_ATTR(port_mapping,      S_IRUGO,
@@ -203,6 +205,16 @@ static ssize_t sja1105_sysfs_wr(struct device *dev,
 		}
 
 		rc = count;
+	} else if (attr == &dev_attr_port_status) {
+		/* remember the port and read its status
+		 * on sysfs read operation */
+		port = sja1105_parse_port(priv, buf);
+		if (port) {
+			priv->port_status_index = port->index;
+			rc = count;
+		} else {
+			rc = -ENOENT;
+		}
 	} else if (attr == &dev_attr_port_status_clear) {
 		if (sysfs_streq(buf, "all")) {
 			port_no = -1;
@@ -284,6 +296,7 @@ static ssize_t sja1105_sysfs_rd(struct device *dev,
 	struct spi_device *spi = to_spi_device(dev);
 	struct sja1105_spi_private *priv = spi_get_drvdata(spi);
 	struct sja1105_general_status gen_status;
+	struct sja1105_port_status port_status;
 	struct list_head *pos, *q;
 	struct sja1105_port *port = NULL;
 	u64 value;
@@ -311,6 +324,16 @@ static ssize_t sja1105_sysfs_rd(struct device *dev,
 		sja1105_general_status_show(&gen_status, buf, PAGE_SIZE,
 		                            priv->device_id);
 		rc = strlen(buf);
+	} else if (attr == &dev_attr_port_status) {
+		rc = sja1105_port_status_get(priv, &port_status,
+		                             priv->port_status_index);
+		if (rc) {
+			rc = -EIO;
+			goto err_out;
+		}
+		sja1105_port_status_show(&port_status, buf, PAGE_SIZE,
+		                         priv->device_id);
+		rc = strlen(buf);
 	} else if (attr == &dev_attr_port_mapping) {
 		list_for_each_safe(pos, q, &(priv->port_list_head.list)) {
 			port = list_entry(pos, struct sja1105_port, list);
@@ -354,6 +377,61 @@ err_out:
 	return rc;
 }
 
+/*
+ * Binary attribute "regs": the switch register space, with register
+ * address A found at file offset 4 * A. Reads and writes must be made
+ * of whole registers and transfer them in SPI (big endian) byte order,
+ * in as few SPI messages as the maximum message length allows.
+ * Unlike reg_access, accesses are not logged.
+ */
+#define SJA1105_REGS_SIZE (4 << 21) /* 21-bit register address */
+
+static ssize_t sja1105_regs_access(struct kobject *kobj, char *buf,
+                                   loff_t pos, size_t count,
+                                   enum sja1105_spi_access_mode rw)
+{
+	struct device *dev = container_of(kobj, struct device, kobj);
+	struct spi_device *spi = to_spi_device(dev);
+	struct sja1105_spi_private *priv = spi_get_drvdata(spi);
+	int rc;
+
+	if ((pos % 4) || (count % 4))
+		return -EINVAL;
+	if (pos >= SJA1105_REGS_SIZE)
+		return 0;
+	if (count > SJA1105_REGS_SIZE - pos)
+		count = SJA1105_REGS_SIZE - pos;
+	if (count == 0)
+		return 0;
+
+	mutex_lock(&priv->lock);
+	rc = sja1105_spi_send_long_packed_buf(priv, rw, pos / 4, buf, count);
+	mutex_unlock(&priv->lock);
+
+	return (rc < 0) ? -EIO : count;
+}
+
+static ssize_t sja1105_regs_rd(struct file *filp, struct kobject *kobj,
+                               struct bin_attribute *attr,
+                               char *buf, loff_t pos, size_t count)
+{
+	return sja1105_regs_access(kobj, buf, pos, count, SPI_READ);
+}
+
+static ssize_t sja1105_regs_wr(struct file *filp, struct kobject *kobj,
+                               struct bin_attribute *attr,
+                               char *buf, loff_t pos, size_t count)
+{
+	return sja1105_regs_access(kobj, buf, pos, count, SPI_WRITE);
+}
+
+static struct bin_attribute bin_attr_regs = {
+	.attr  = { .name = "regs", .mode = S_IRUSR | S_IWUSR },
+	.size  = SJA1105_REGS_SIZE,
+	.read  = sja1105_regs_rd,
+	.write = sja1105_regs_wr,
+};
+
 int sja1105_sysfs_init(struct sja1105_spi_private *priv)
 {
 	int rc;
@@ -361,11 +439,13 @@ int sja1105_sysfs_init(struct sja1105_spi_private *priv)
 
 	rc  = device_create_file(dev, &dev_attr_device_id);
 	rc |= device_create_file(dev, &dev_attr_general_status);
+	rc |= device_create_file(dev, &dev_attr_port_status);
 	rc |= device_create_file(dev, &dev_attr_port_status_clear);
 	rc |= device_create_file(dev, &dev_attr_port_mapping);
 	rc |= device_create_file(dev, &dev_attr_reg_access);
 	rc |= device_create_file(dev, &dev_attr_vlan_lookup);
 	rc |= device_create_file(dev, &dev_attr_config_upload);
+	rc |= device_create_bin_file(dev, &bin_attr_regs);
 
 	return (rc) ? -1 : 0;
 }
@@ -376,9 +456,11 @@ void sja1105_sysfs_remove(struct sja1105_spi_private *priv)
 
 	device_remove_file(dev, &dev_attr_device_id);
 	device_remove_file(dev, &dev_attr_general_status);
+	device_remove_file(dev, &dev_attr_port_status);
 	device_remove_file(dev, &dev_attr_port_status_clear);
 	device_remove_file(dev, &dev_attr_port_mapping);
 	device_remove_file(dev, &dev_attr_reg_access);
 	device_remove_file(dev, &dev_attr_vlan_lookup);
 	device_remove_file(dev, &dev_attr_config_upload);
+	device_remove_bin_file(dev, &bin_attr_regs);
 }
@@ -18,6 +18,10 @@
 #include <lib/include/static-config.h>
 
 #define SJA1105_MGMT_ROUTE_COUNT 4
+
+#define SIZE_SPI_MSG_HEADER    4
+#define SIZE_SPI_MSG_MAXLEN    (64 * 4)
+#define SPI_TRANSFER_SIZE_MAX  (SIZE_SPI_MSG_HEADER + SIZE_SPI_MSG_MAXLEN)
 #define SJA1105_SKB_RING_SIZE    20
 
 enum sja1105_ptp_clk_add_mode {
@@ -69,6 +73,7 @@ struct sja1105_spi_private {
 
 	u64 reg_addr; /* register address to read from */
 	u64 vlanid; /* vlan lookup entry to read */
+	int port_status_index; /* port to read status of */
 
 	u64 device_id;
 	u64 part_nr; /* Needed for P/R distinction (same switch core) */
@@ -85,6 +90,15 @@ struct sja1105_spi_private {
 
 	struct net_device *host_net_dev;
 	struct sja1105_port *switch_host_port;
+
+	/* Bounce buffers of sja1105_spi_send_packed_buf(). They are part of
+	 * the kzalloc'ed priv, so they can be DMA-mapped by the SPI
+	 * controller, and each starts a cacheline of its own. Register
+	 * accesses come from sysfs, PTP and netdev paths which do not all
+	 * hold priv->lock, hence the separate mutex. */
+	struct mutex spi_buf_lock;
+	uint8_t spi_tx_buf[SPI_TRANSFER_SIZE_MAX] ____cacheline_aligned;
+	uint8_t spi_rx_buf[SPI_TRANSFER_SIZE_MAX] ____cacheline_aligned;
 };
 
 struct sja1105_spi_message {
@@ -108,9 +122,6 @@ int sja1105_spi_send_long_packed_buf(struct sja1105_spi_private*,
                                      enum sja1105_spi_access_mode,
                                      uint64_t, char *, uint64_t);
 
-#define SIZE_SPI_MSG_HEADER    4
-#define SIZE_SPI_MSG_MAXLEN    64 * 4
-
 /* sja1105-kmod.c */
 int sja1105_load_firmware(struct sja1105_spi_private *priv);
 
@@ -356,5 +367,8 @@ int  sja1105_general_status_get(struct sja1105_spi_private*,
 void sja1105_general_status_show(struct sja1105_general_status*,
                                  char*, size_t,
                                  uint64_t device_id);
+void sja1105_port_status_show(struct sja1105_port_status*,
+                              char*, size_t,
+                              uint64_t device_id);
 
 #endif
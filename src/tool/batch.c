@@ -0,0 +1,194 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <ctype.h>
+#include "internal.h"
+
+#define BATCH_MAX_ARGS 64
+
+static void print_usage()
+{
+	printf("Usage: sja1105-tool batch [<filename>]\n");
+	printf("Runs the sja1105-tool commands found in <filename> (or\n");
+	printf("standard input), one per line, without the leading\n");
+	printf("\"sja1105-tool\". Lines starting with # are ignored.\n");
+	printf("The staging area is loaded once and written back\n");
+	printf("after the last command.\n");
+}
+
+/* Split line in place into whitespace-separated words. Words may be
+ * enclosed in single or double quotes (e.g. for array values), the
+ * same way they would be given on the shell command line.
+ */
+static int batch_split_line(char *line, char **argv, int max_args)
+{
+	int argc = 0;
+	char *p = line;
+	char quote;
+
+	while (*p) {
+		while (*p && isspace((unsigned char) *p)) {
+			*p++ = '\0';
+		}
+		if (*p == '\0' || *p == '#') {
+			break;
+		}
+		if (argc == max_args) {
+			return -E2BIG;
+		}
+		if (*p == '"' || *p == '\'') {
+			quote = *p++;
+			argv[argc++] = p;
+			while (*p && *p != quote) {
+				p++;
+			}
+			if (*p == '\0') {
+				return -EINVAL;
+			}
+			*p++ = '\0';
+			continue;
+		}
+		argv[argc++] = p;
+		while (*p && !isspace((unsigned char) *p)) {
+			p++;
+		}
+	}
+	return argc;
+}
+
+int batch_parse_args(struct sja1105_spi_setup *spi_setup,
+                     int argc, char **argv)
+{
+	struct sja1105_spi_setup line_setup;
+	char *line_argv[BATCH_MAX_ARGS];
+	int   line_argc;
+	char *line = NULL;
+	size_t line_len = 0;
+	int   line_no = 0;
+	const char *refused;
+	FILE *f;
+	int   owner;
+	int   rc = 0;
+	int   tmp;
+
+	if (argc > 1) {
+		goto parse_error;
+	}
+	if (argc == 1 && matches(argv[0], "help") == 0) {
+		print_usage();
+		return 0;
+	}
+	if (argc == 0 || strcmp(argv[0], "-") == 0) {
+		/* Use a private stream, since stdin might have been
+		 * redirected underneath us by the daemon. */
+		f = fdopen(dup(STDIN_FILENO), "r");
+	} else {
+		f = fopen(argv[0], "r");
+	}
+	if (f == NULL) {
+		loge("could not open %s", (argc == 1) ? argv[0] : "stdin");
+		rc = -1;
+		sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
+		goto out;
+	}
+	/* Inside the daemon, the resident staging area is already
+	 * active and is written back by the daemon itself */
+	owner = !staging_area_resident_active();
+	if (owner) {
+		rc = staging_area_resident_init(spi_setup->staging_area);
+		if (rc < 0) {
+			sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
+			goto out_close;
+		}
+	}
+	while (getline(&line, &line_len, f) > 0) {
+		line_no++;
+		line_argc = batch_split_line(line, line_argv, BATCH_MAX_ARGS);
+		if (line_argc < 0) {
+			loge("batch: line %d: %s", line_no,
+			     (line_argc == -E2BIG) ? "too many arguments" :
+			                             "unterminated quote");
+			rc = -1;
+			sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+			break;
+		}
+		if (line_argc == 0) {
+			continue;
+		}
+		if (matches(line_argv[0], "batch") == 0 ||
+		    matches(line_argv[0], "daemon") == 0) {
+			loge("batch: line %d: %s not allowed here",
+			     line_no, line_argv[0]);
+			rc = -1;
+			sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+			break;
+		}
+		/* Running inside sja1105d */
+		refused = owner ? NULL : daemon_request_refused(line_argc,
+		                                                line_argv);
+		if (refused) {
+			loge("batch: line %d: %s", line_no, refused);
+			rc = -1;
+			sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+			break;
+		}
+		/* Options such as --flush must not leak into
+		 * the following commands */
+		line_setup = *spi_setup;
+		rc = parse_args(&line_setup, line_argc, line_argv);
+		if (rc < 0) {
+			loge("batch: line %d failed: %s", line_no,
+			     sja1105_err_code_to_string(-rc));
+			break;
+		}
+	}
+	if (owner) {
+		/* Commands that succeeded stay applied */
+		tmp = staging_area_resident_sync();
+		if (rc == 0) {
+			rc = tmp;
+		}
+		staging_area_resident_free();
+	}
+	free(line);
+out_close:
+	fclose(f);
+out:
+	return rc;
+parse_error:
+	rc = -1;
+	sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+	print_usage();
+	return rc;
+}
@@ -0,0 +1,344 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "xml/read/external.h"
+#include "internal.h"
+/* From libsja1105 */
+#include <lib/include/static-config.h>
+#include <lib/helpers.h>
+#include <common.h>
+
+enum diff_kind {
+	DIFF_ADDED,
+	DIFF_REMOVED,
+	DIFF_MODIFIED,
+};
+
+static const char *diff_kind_names[] = {
+	[DIFF_ADDED]    = "added",
+	[DIFF_REMOVED]  = "removed",
+	[DIFF_MODIFIED] = "modified",
+};
+
+struct diff_context {
+	/* NULL for human-readable output */
+	struct sja1105_output *out;
+	uint64_t device_id;
+	int      changes;
+};
+
+/* Staging areas start with the device ID, XML files with '<'
+ * and JSON files (config save --json) with '{' */
+static int
+diff_load(const char *file_name, struct sja1105_staging_area *staging_area)
+{
+	FILE *f;
+	int c;
+
+	f = fopen(file_name, "r");
+	if (f == NULL) {
+		loge("could not open %s", file_name);
+		return -SJA1105_ERR_FILESYSTEM;
+	}
+	do {
+		c = fgetc(f);
+	} while (c != EOF && isspace(c));
+	fclose(f);
+
+	if (c == '{') {
+		if (sja1105_staging_area_from_json(file_name,
+		                                   staging_area) < 0) {
+			return -SJA1105_ERR_INVALID_XML;
+		}
+		return 0;
+	}
+	if (c != '<') {
+		return staging_area_load(file_name, staging_area);
+	}
+	if (sja1105_staging_area_from_xml(file_name, staging_area) < 0) {
+		return -SJA1105_ERR_INVALID_XML;
+	}
+	return 0;
+}
+
+static void
+diff_value_sprintf(char *buf, const struct sja1105_field *field,
+                   uint64_t *value)
+{
+	if (value == NULL) {
+		snprintf(buf, MAX_LINE_SIZE, "-");
+	} else if (field->count > 1) {
+		print_array(buf, value, field->count);
+	} else if (field->flags & SJA1105_FIELD_MAC) {
+		mac_addr_sprintf(buf, *value);
+	} else {
+		snprintf(buf, MAX_LINE_SIZE, "0x%" PRIX64, *value);
+	}
+}
+
+static void
+diff_value_output(struct sja1105_output *out, const char *name,
+                  const struct sja1105_field *field, uint64_t *value)
+{
+	if (field == NULL || value == NULL) {
+		sja1105_output_none(out, name);
+	} else if (field->count > 1) {
+		sja1105_output_array(out, name, value, field->count);
+	} else if (field->flags & SJA1105_FIELD_MAC) {
+		sja1105_output_mac(out, name, *value);
+	} else {
+		sja1105_output_u64(out, name, *value);
+	}
+}
+
+/* Report one change. field, old and new are only given for
+ * DIFF_MODIFIED, and old or new is NULL when the field only
+ * applies to one side of the entry.
+ */
+static void
+diff_report(struct diff_context *ctx, const struct sja1105_table *table,
+            int index, enum diff_kind kind, const struct sja1105_field *field,
+            uint64_t *old, uint64_t *new)
+{
+	char old_buf[MAX_LINE_SIZE];
+	char new_buf[MAX_LINE_SIZE];
+
+	ctx->changes++;
+	if (ctx->out == NULL) {
+		if (kind != DIFF_MODIFIED) {
+			printf("%s[%d]: %s\n", table->name, index,
+			       diff_kind_names[kind]);
+			return;
+		}
+		diff_value_sprintf(old_buf, field, old);
+		diff_value_sprintf(new_buf, field, new);
+		printf("%s[%d]: %s %s -> %s\n", table->name, index,
+		       field->name, old_buf, new_buf);
+		return;
+	}
+	sja1105_output_record_begin(ctx->out);
+	sja1105_output_str(ctx->out, "table", table->name);
+	sja1105_output_u64(ctx->out, "entry", index);
+	sja1105_output_str(ctx->out, "change", diff_kind_names[kind]);
+	if (field != NULL) {
+		sja1105_output_str(ctx->out, "field", field->name);
+	} else {
+		sja1105_output_none(ctx->out, "field");
+	}
+	diff_value_output(ctx->out, "old", field, old);
+	diff_value_output(ctx->out, "new", field, new);
+	sja1105_output_record_end(ctx->out);
+}
+
+static void
+diff_entry(struct diff_context *ctx, const struct sja1105_table *table,
+           int index, void *a, void *b)
+{
+	const struct sja1105_field *field;
+	uint64_t *old, *new;
+	int i;
+
+	/* Entries are plain arrays of uint64_t, so identical
+	 * entries (the common case) are skipped at once */
+	if (memcmp(a, b, table->entry_size) == 0) {
+		return;
+	}
+	for (i = 0; i < table->field_count; i++) {
+		field = &table->fields[i];
+		if (field->flags & SJA1105_FIELD_INTERNAL ||
+		    sja1105_field_width(field, ctx->device_id) == 0) {
+			continue;
+		}
+		old = sja1105_field_present(table, field, a) ?
+		      sja1105_field_get(field, a) : NULL;
+		new = sja1105_field_present(table, field, b) ?
+		      sja1105_field_get(field, b) : NULL;
+		if (old == NULL && new == NULL) {
+			continue;
+		}
+		if (old != NULL && new != NULL &&
+		    memcmp(old, new, field->count * sizeof(*old)) == 0) {
+			continue;
+		}
+		diff_report(ctx, table, index, DIFF_MODIFIED, field, old, new);
+	}
+}
+
+#define RAW_TABLE(name, member)                                               \
+	{                                                                     \
+		name, NULL, NULL, NULL, NULL,                                 \
+		offsetof(struct sja1105_static_config, member),               \
+		offsetof(struct sja1105_static_config, member##_count),       \
+		sizeof(struct sja1105_##member##_entry),                      \
+		ARRAY_SIZE(((struct sja1105_static_config*) 0)->member),      \
+		NULL, 0,                                                      \
+	}
+
+/* Tables which the tool has no field description for, and which can
+ * therefore only be told apart as a whole */
+static const struct sja1105_table diff_raw_tables[] = {
+	RAW_TABLE("xmii-mode-parameters-table", xmii_params),
+	RAW_TABLE("retagging-table", retagging),
+	RAW_TABLE("sgmii-table", sgmii),
+};
+
+static void
+diff_table_raw(struct diff_context *ctx, const struct sja1105_table *table,
+               struct sja1105_static_config *a,
+               struct sja1105_static_config *b)
+{
+	int count_a = *sja1105_table_count_get(table, a);
+	int count_b = *sja1105_table_count_get(table, b);
+	int i;
+
+	if (count_a == count_b) {
+		for (i = 0; i < count_a; i++) {
+			if (memcmp(sja1105_table_entry_get(table, a, i),
+			           sja1105_table_entry_get(table, b, i),
+			           table->entry_size) != 0) {
+				break;
+			}
+		}
+		if (i == count_a) {
+			return;
+		}
+	}
+	ctx->changes++;
+	if (ctx->out == NULL) {
+		printf("%s: differs\n", table->name);
+		return;
+	}
+	sja1105_output_record_begin(ctx->out);
+	sja1105_output_str(ctx->out, "table", table->name);
+	sja1105_output_none(ctx->out, "entry");
+	sja1105_output_str(ctx->out, "change", "differs");
+	sja1105_output_none(ctx->out, "field");
+	sja1105_output_none(ctx->out, "old");
+	sja1105_output_none(ctx->out, "new");
+	sja1105_output_record_end(ctx->out);
+}
+
+static void
+diff_table(struct diff_context *ctx, const struct sja1105_table *table,
+           struct sja1105_static_config *a, struct sja1105_static_config *b)
+{
+	int count_a = *sja1105_table_count_get(table, a);
+	int count_b = *sja1105_table_count_get(table, b);
+	int i;
+
+	if (table->fields == NULL) {
+		/* Not unpacked, so there is nothing to compare */
+		return;
+	}
+	/* Entries are compared by position, since that is
+	 * how the switch addresses them */
+	for (i = 0; i < count_a && i < count_b; i++) {
+		diff_entry(ctx, table, i, sja1105_table_entry_get(table, a, i),
+		           sja1105_table_entry_get(table, b, i));
+	}
+	for (i = count_b; i < count_a; i++) {
+		diff_report(ctx, table, i, DIFF_REMOVED, NULL, NULL, NULL);
+	}
+	for (i = count_a; i < count_b; i++) {
+		diff_report(ctx, table, i, DIFF_ADDED, NULL, NULL, NULL);
+	}
+}
+
+/* Returns the number of changes between the two files, which may
+ * each be either a staging area or an XML configuration */
+int
+sja1105_staging_area_diff(const char *file_a, const char *file_b,
+                          enum sja1105_output_format format)
+{
+	static struct sja1105_output output;
+	struct sja1105_staging_area *a;
+	struct sja1105_staging_area *b;
+	struct diff_context ctx;
+	int rc;
+	int i;
+
+	memset(&ctx, 0, sizeof(ctx));
+	a = malloc(sizeof(*a));
+	b = malloc(sizeof(*b));
+	if (a == NULL || b == NULL) {
+		loge("malloc failed");
+		rc = -SJA1105_ERR_FILESYSTEM;
+		goto out;
+	}
+	rc = diff_load(file_a, a);
+	if (rc < 0) {
+		goto out;
+	}
+	rc = diff_load(file_b, b);
+	if (rc < 0) {
+		goto out;
+	}
+	ctx.device_id = a->static_config.device_id;
+	if (format != SJA1105_OUTPUT_TEXT) {
+		ctx.out = &output;
+		sja1105_output_begin(ctx.out, format);
+		sja1105_output_u64(ctx.out, "old_device_id",
+		                   a->static_config.device_id);
+		sja1105_output_u64(ctx.out, "new_device_id",
+		                   b->static_config.device_id);
+		sja1105_output_section_begin(ctx.out, "changes", NULL);
+	} else if (a->static_config.device_id != b->static_config.device_id) {
+		printf("device-id: 0x%08" PRIX64 " -> 0x%08" PRIX64 "\n",
+		       a->static_config.device_id,
+		       b->static_config.device_id);
+	}
+	for (i = 0; i < sja1105_table_count; i++) {
+		diff_table(&ctx, &sja1105_tables[i], &a->static_config,
+		           &b->static_config);
+	}
+	for (i = 0; i < (int) ARRAY_SIZE(diff_raw_tables); i++) {
+		diff_table_raw(&ctx, &diff_raw_tables[i], &a->static_config,
+		               &b->static_config);
+	}
+	if (ctx.out != NULL) {
+		sja1105_output_section_end(ctx.out);
+		sja1105_output_end(ctx.out);
+	}
+	rc = ctx.changes;
+	if (a->static_config.device_id != b->static_config.device_id) {
+		rc++;
+	}
+out:
+	free(a);
+	free(b);
+	return rc;
+}
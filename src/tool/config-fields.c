@@ -0,0 +1,599 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdio.h>
+#include "internal.h"
+/* From libsja1105 */
+#include <common.h>
+
+/* Every static config table known to the tool is described below once,
+ * field by field, in the order in which the fields appear in the XML
+ * export. Modify, show and XML import/export all walk these descriptors
+ * instead of carrying their own copy of the field list.
+ *
+ * Bit widths are those of the packed hardware layout (see
+ * src/lib/static-config/tables). A width of 0 means that the field does
+ * not exist on that switch family.
+ */
+#define FIELD_IF(entry, member, et, pqrs, flags, cond, value)                 \
+	{                                                                     \
+		#member,                                                      \
+		offsetof(struct sja1105_##entry##_entry, member),             \
+		sizeof(((struct sja1105_##entry##_entry*) 0)->member) /       \
+		       sizeof(uint64_t),                                      \
+		et, pqrs, flags, cond, value,                                 \
+	}
+
+#define FIELD(entry, member, et, pqrs, flags)                                 \
+	FIELD_IF(entry, member, et, pqrs, flags, -1, 0)
+
+#define TABLE_SHOW_FN(member)                                                 \
+	static void                                                           \
+	member##_fmt_show(char *buf, size_t len, char *fmt, void *entry)      \
+	{                                                                     \
+		sja1105_##member##_entry_fmt_show(buf, len, fmt, entry);      \
+	}
+
+#define TABLE_NAMED(name, description, show_name, fmt, member)                \
+	{                                                                     \
+		name, description, fmt, show_name, member##_fmt_show,         \
+		offsetof(struct sja1105_static_config, member),               \
+		offsetof(struct sja1105_static_config, member##_count),       \
+		sizeof(struct sja1105_##member##_entry),                      \
+		ARRAY_SIZE(((struct sja1105_static_config*) 0)->member),      \
+		member##_fields, ARRAY_SIZE(member##_fields),                 \
+	}
+
+#define TABLE(name, description, fmt, member)                                 \
+	TABLE_NAMED(name, description, description, fmt, member)
+
+#define TABLE_UNIMPLEMENTED(name, description)                                \
+	{ name, description, NULL, description, NULL, 0, 0, 0, 0, NULL, 0 }
+
+static const struct sja1105_field schedule_fields[] = {
+	FIELD(schedule, winstindex,  10, 10, 0),
+	FIELD(schedule, winend,       1,  1, 0),
+	FIELD(schedule, winst,        1,  1, 0),
+	FIELD(schedule, destports,    5,  5, 0),
+	FIELD(schedule, setvalid,     1,  1, 0),
+	FIELD(schedule, txen,         1,  1, 0),
+	FIELD(schedule, resmedia_en,  1,  1, 0),
+	FIELD(schedule, resmedia,     8,  8, 0),
+	FIELD(schedule, vlindex,     10, 10, 0),
+	FIELD(schedule, delta,       18, 18, 0),
+};
+
+static const struct sja1105_field schedule_entry_points_fields[] = {
+	FIELD(schedule_entry_points, subschindx,  3,  3, 0),
+	FIELD(schedule_entry_points, delta,      18, 18, 0),
+	FIELD(schedule_entry_points, address,    10, 10, 0),
+};
+
+/* The VL Lookup entry is a union selected by general_params.vllupformat.
+ * The format member itself is not user-visible: it only decides which
+ * half of the union gets shown and exported. */
+#define VL_LOOKUP_FORMAT 0
+static const struct sja1105_field vl_lookup_fields[] = {
+	FIELD(vl_lookup, format, 1, 1, SJA1105_FIELD_INTERNAL),
+	FIELD_IF(vl_lookup, destports,   5,  5, 0, VL_LOOKUP_FORMAT, 0),
+	FIELD_IF(vl_lookup, iscritical,  1,  1, 0, VL_LOOKUP_FORMAT, 0),
+	FIELD_IF(vl_lookup, macaddr,    48, 48, SJA1105_FIELD_MAC,
+	         VL_LOOKUP_FORMAT, 0),
+	FIELD_IF(vl_lookup, vlanid,     12, 12, 0, VL_LOOKUP_FORMAT, 0),
+	FIELD(vl_lookup, port,           3,  3, 0),
+	FIELD_IF(vl_lookup, vlanprior,   3,  3, 0, VL_LOOKUP_FORMAT, 0),
+	FIELD_IF(vl_lookup, egrmirr,     5,  5, 0, VL_LOOKUP_FORMAT, 1),
+	FIELD_IF(vl_lookup, ingrmirr,    1,  1, 0, VL_LOOKUP_FORMAT, 1),
+	FIELD_IF(vl_lookup, vlid,       16, 16, 0, VL_LOOKUP_FORMAT, 1),
+};
+
+/* BAG and JITTER only exist for rate-constrained (type 0) VLs */
+#define VL_POLICING_TYPE 0
+static const struct sja1105_field vl_policing_fields[] = {
+	FIELD(vl_policing, type,      1,  1, 0),
+	FIELD(vl_policing, maxlen,   11, 11, 0),
+	FIELD(vl_policing, sharindx, 10, 10, 0),
+	FIELD_IF(vl_policing, bag,    14, 14, 0, VL_POLICING_TYPE, 0),
+	FIELD_IF(vl_policing, jitter, 10, 10, 0, VL_POLICING_TYPE, 0),
+};
+
+static const struct sja1105_field vl_forwarding_fields[] = {
+	FIELD(vl_forwarding, type,      1, 1, 0),
+	FIELD(vl_forwarding, priority,  3, 3, 0),
+	FIELD(vl_forwarding, partition, 3, 3, 0),
+	FIELD(vl_forwarding, destports, 5, 5, 0),
+};
+
+static const struct sja1105_field l2_lookup_fields[] = {
+	FIELD(l2_lookup, tsreg,         0,  1, 0),
+	FIELD(l2_lookup, mirrvlan,      0, 12, 0),
+	FIELD(l2_lookup, takets,        0,  1, 0),
+	FIELD(l2_lookup, mirr,          0,  1, 0),
+	FIELD(l2_lookup, retag,         0,  1, 0),
+	FIELD(l2_lookup, mask_iotag,    0,  1, 0),
+	FIELD(l2_lookup, mask_vlanid,   0, 12, 0),
+	FIELD(l2_lookup, mask_macaddr,  0, 48, SJA1105_FIELD_MAC),
+	FIELD(l2_lookup, iotag,         0,  1, 0),
+	FIELD(l2_lookup, vlanid,       12, 12, 0),
+	FIELD(l2_lookup, macaddr,      48, 48, SJA1105_FIELD_MAC),
+	FIELD(l2_lookup, destports,     5,  5, 0),
+	FIELD(l2_lookup, enfport,       1,  1, 0),
+	FIELD(l2_lookup, index,        10, 10, 0),
+};
+
+static const struct sja1105_field l2_policing_fields[] = {
+	FIELD(l2_policing, sharindx,   6,  6, 0),
+	FIELD(l2_policing, smax,      16, 16, 0),
+	FIELD(l2_policing, rate,      16, 16, 0),
+	FIELD(l2_policing, maxlen,    11, 11, 0),
+	FIELD(l2_policing, partition,  3,  3, 0),
+};
+
+static const struct sja1105_field vlan_lookup_fields[] = {
+	FIELD(vlan_lookup, ving_mirr,   5,  5, 0),
+	FIELD(vlan_lookup, vegr_mirr,   5,  5, 0),
+	FIELD(vlan_lookup, vmemb_port,  5,  5, 0),
+	FIELD(vlan_lookup, vlan_bc,     5,  5, 0),
+	FIELD(vlan_lookup, tag_port,    5,  5, 0),
+	FIELD(vlan_lookup, vlanid,     12, 12, 0),
+};
+
+static const struct sja1105_field l2_forwarding_fields[] = {
+	FIELD(l2_forwarding, bc_domain,  5, 5, 0),
+	FIELD(l2_forwarding, reach_port, 5, 5, 0),
+	FIELD(l2_forwarding, fl_domain,  5, 5, 0),
+	FIELD(l2_forwarding, vlan_pmap,  3, 3, 0),
+};
+
+static const struct sja1105_field mac_config_fields[] = {
+	FIELD(mac_config, top,         9,  9, 0),
+	FIELD(mac_config, base,        9,  9, 0),
+	FIELD(mac_config, enabled,     1,  1, 0),
+	FIELD(mac_config, ifg,         5,  5, 0),
+	FIELD(mac_config, speed,       2,  2, SJA1105_FIELD_NO_XML),
+	FIELD(mac_config, tp_delin,   16, 16, 0),
+	FIELD(mac_config, tp_delout,  16, 16, 0),
+	FIELD(mac_config, maxage,      8,  8, 0),
+	FIELD(mac_config, vlanprio,    3,  3, 0),
+	FIELD(mac_config, vlanid,     12, 12, 0),
+	FIELD(mac_config, ing_mirr,    1,  1, 0),
+	FIELD(mac_config, egr_mirr,    1,  1, 0),
+	FIELD(mac_config, drpnona664,  1,  1, 0),
+	FIELD(mac_config, drpdtag,     1,  1, 0),
+	FIELD(mac_config, drpsotag,    0,  1, 0),
+	FIELD(mac_config, drpsitag,    0,  1, 0),
+	FIELD(mac_config, drpuntag,    1,  1, 0),
+	FIELD(mac_config, retag,       1,  1, 0),
+	FIELD(mac_config, dyn_learn,   1,  1, 0),
+	FIELD(mac_config, egress,      1,  1, 0),
+	FIELD(mac_config, ingress,     1,  1, 0),
+	FIELD(mac_config, mirrcie,     0,  1, 0),
+	FIELD(mac_config, mirrcetag,   0,  1, 0),
+	FIELD(mac_config, ingmirrvid,  0, 12, 0),
+	FIELD(mac_config, ingmirrpcp,  0,  3, 0),
+	FIELD(mac_config, ingmirrdei,  0,  1, 0),
+};
+
+static const struct sja1105_field schedule_params_fields[] = {
+	FIELD(schedule_params, subscheind, 10, 10, 0),
+};
+
+static const struct sja1105_field schedule_entry_points_params_fields[] = {
+	FIELD(schedule_entry_points_params, clksrc,    2, 2, 0),
+	FIELD(schedule_entry_points_params, actsubsch, 3, 3, 0),
+};
+
+static const struct sja1105_field vl_forwarding_params_fields[] = {
+	FIELD(vl_forwarding_params, partspc, 10, 10, 0),
+	FIELD(vl_forwarding_params, debugen,  1,  1, 0),
+};
+
+static const struct sja1105_field l2_lookup_params_fields[] = {
+	FIELD(l2_lookup_params, drpbc,          0,  5, SJA1105_FIELD_NO_XML),
+	FIELD(l2_lookup_params, drpmc,          0,  5, SJA1105_FIELD_NO_XML),
+	FIELD(l2_lookup_params, drpuni,         0,  5, SJA1105_FIELD_NO_XML),
+	FIELD(l2_lookup_params, maxaddrp,       0, 11, SJA1105_FIELD_NO_XML),
+	FIELD(l2_lookup_params, start_dynspc,   0, 10, SJA1105_FIELD_NO_XML),
+	FIELD(l2_lookup_params, drpnolearn,     0,  5, SJA1105_FIELD_NO_XML),
+	FIELD(l2_lookup_params, use_static,     0,  1, SJA1105_FIELD_NO_XML),
+	FIELD(l2_lookup_params, owr_dyn,        0,  1, SJA1105_FIELD_NO_XML),
+	FIELD(l2_lookup_params, learn_once,     0,  1, SJA1105_FIELD_NO_XML),
+	FIELD(l2_lookup_params, maxage,        15, 15, 0),
+	FIELD(l2_lookup_params, dyn_tbsz,       3,  0, 0),
+	FIELD(l2_lookup_params, poly,           8,  0, 0),
+	FIELD(l2_lookup_params, shared_learn,   1,  1, 0),
+	FIELD(l2_lookup_params, no_enf_hostprt, 1,  1, 0),
+	FIELD(l2_lookup_params, no_mgmt_learn,  1,  1, 0),
+};
+
+static const struct sja1105_field l2_forwarding_params_fields[] = {
+	FIELD(l2_forwarding_params, max_dynp,  3,  3, 0),
+	FIELD(l2_forwarding_params, part_spc, 10, 10, 0),
+};
+
+static const struct sja1105_field avb_params_fields[] = {
+	FIELD(avb_params, l2cbs,       0,  1, 0),
+	FIELD(avb_params, cas_master,  0,  1, 0),
+	FIELD(avb_params, destmeta,   48, 48, SJA1105_FIELD_MAC),
+	FIELD(avb_params, srcmeta,    48, 48, SJA1105_FIELD_MAC),
+};
+
+static const struct sja1105_field general_params_fields[] = {
+	FIELD(general_params, vllupformat,  1,  1, 0),
+	FIELD(general_params, mirr_ptacu,   1,  1, 0),
+	FIELD(general_params, switchid,     3,  3, 0),
+	FIELD(general_params, hostprio,     3,  3, 0),
+	FIELD(general_params, mac_fltres1, 48, 48, SJA1105_FIELD_MAC),
+	FIELD(general_params, mac_fltres0, 48, 48, SJA1105_FIELD_MAC),
+	FIELD(general_params, mac_flt1,    48, 48, SJA1105_FIELD_MAC),
+	FIELD(general_params, mac_flt0,    48, 48, SJA1105_FIELD_MAC),
+	FIELD(general_params, incl_srcpt1,  1,  1, 0),
+	FIELD(general_params, incl_srcpt0,  1,  1, 0),
+	FIELD(general_params, send_meta1,   1,  1, 0),
+	FIELD(general_params, send_meta0,   1,  1, 0),
+	FIELD(general_params, casc_port,    3,  3, 0),
+	FIELD(general_params, host_port,    3,  3, SJA1105_FIELD_NO_XML),
+	FIELD(general_params, mirr_port,    3,  3, 0),
+	FIELD(general_params, vlmarker,    32, 32, 0),
+	FIELD(general_params, vlmask,      32, 32, 0),
+	FIELD(general_params, tpid,        16, 16, 0),
+	FIELD(general_params, ignore2stf,   1,  1, 0),
+	FIELD(general_params, tpid2,       16, 16, 0),
+	FIELD(general_params, queue_ts,     0,  1, 0),
+	FIELD(general_params, egrmirrvid,   0, 12, 0),
+	FIELD(general_params, egrmirrpcp,   0,  3, 0),
+	FIELD(general_params, egrmirrdei,   0,  1, 0),
+	FIELD(general_params, replay_port,  0,  3, 0),
+};
+
+TABLE_SHOW_FN(schedule)
+TABLE_SHOW_FN(schedule_entry_points)
+TABLE_SHOW_FN(vl_lookup)
+TABLE_SHOW_FN(vl_policing)
+TABLE_SHOW_FN(vl_forwarding)
+TABLE_SHOW_FN(l2_lookup)
+TABLE_SHOW_FN(l2_policing)
+TABLE_SHOW_FN(vlan_lookup)
+TABLE_SHOW_FN(l2_forwarding)
+TABLE_SHOW_FN(mac_config)
+TABLE_SHOW_FN(schedule_params)
+TABLE_SHOW_FN(schedule_entry_points_params)
+TABLE_SHOW_FN(vl_forwarding_params)
+TABLE_SHOW_FN(l2_lookup_params)
+TABLE_SHOW_FN(l2_forwarding_params)
+TABLE_SHOW_FN(avb_params)
+TABLE_SHOW_FN(general_params)
+
+const struct sja1105_table sja1105_tables[] = {
+	TABLE("schedule-table", "Schedule Table", "%-30s\n", schedule),
+	TABLE("schedule-entry-points-table", "Schedule Entry Points Table",
+	      "%-30s\n", schedule_entry_points),
+	TABLE_NAMED("vl-lookup-table", "Virtual Link Address Lookup Table",
+	            "Virtual Link Address Lookup Table:", "%-35s\n",
+	            vl_lookup),
+	TABLE_NAMED("vl-policing-table", "Virtual Link Policing Table",
+	            "Virtual Link Policing Table:", "%-35s\n", vl_policing),
+	TABLE("vl-forwarding-table", "Virtual Link Forwarding Table",
+	      "%-35s\n", vl_forwarding),
+	TABLE("l2-address-lookup-table", "L2 Address Lookup Table",
+	      "%-30s\n", l2_lookup),
+	TABLE("l2-policing-table", "L2 Policing Table", "%-20s\n",
+	      l2_policing),
+	TABLE("vlan-lookup-table", "VLAN Lookup Table", "%-20s\n",
+	      vlan_lookup),
+	TABLE("l2-forwarding-table", "L2 Forwarding Table", "%-45s\n",
+	      l2_forwarding),
+	TABLE("mac-configuration-table", "MAC Configuration Table",
+	      "%-60s\n", mac_config),
+	TABLE("schedule-parameters-table", "Schedule Parameters Table",
+	      "%-50s\n", schedule_params),
+	TABLE("schedule-entry-points-parameters-table",
+	      "Schedule Entry Points Parameters Table", "%-30s\n",
+	      schedule_entry_points_params),
+	TABLE("vl-forwarding-parameters-table",
+	      "Virtual Link Forwarding Parameters Table", "%-50s\n",
+	      vl_forwarding_params),
+	TABLE("l2-address-lookup-parameters-table",
+	      "L2 Address Lookup Parameters Table", "%-30s\n",
+	      l2_lookup_params),
+	TABLE("l2-forwarding-parameters-table",
+	      "L2 Forwarding Parameters Table", "%-50s\n",
+	      l2_forwarding_params),
+	TABLE_UNIMPLEMENTED("clock-synchronization-parameters-table",
+	                    "Clock Synchronization Table"),
+	TABLE("avb-parameters-table", "Audio/Video Bridging Parameters Table",
+	      "%-35s\n", avb_params),
+	TABLE("general-parameters-table", "General Parameters Table",
+	      "%-30s\n", general_params),
+	TABLE_UNIMPLEMENTED("retagging-table", "Retagging Table"),
+};
+
+const int sja1105_table_count = ARRAY_SIZE(sja1105_tables);
+
+/* Name lookup.
+ * The set of names is fixed at compile time, so on first use we search
+ * for a seed under which the hash is collision-free over the slot array
+ * (a perfect hash). From then on, resolving an exact name costs one hash
+ * and one strcmp. Abbreviated names fall back to get_match() prefix
+ * matching, which also prints the available choices on failure.
+ */
+#define NAME_INDEX_MAX_SLOTS  128
+#define NAME_INDEX_MAX_SEEDS  65536
+#define NAME_AT(base, stride, i) \
+	(*(const char * const *) ((const char *) (base) + (i) * (stride)))
+
+struct name_index {
+	int      built;
+	uint32_t seed;
+	uint32_t mask;
+	/* Index of the name hashing to this slot plus one, 0 if empty */
+	uint8_t  slot[NAME_INDEX_MAX_SLOTS];
+};
+
+static struct name_index table_index;
+static struct name_index field_index[ARRAY_SIZE(sja1105_tables)];
+
+static uint32_t name_hash(const char *name, uint32_t seed)
+{
+	/* FNV-1a, with the seed folded into the offset basis */
+	uint32_t hash = 2166136261u ^ seed;
+
+	while (*name) {
+		hash ^= (uint8_t) *name++;
+		hash *= 16777619u;
+	}
+	return hash ^ (hash >> 15);
+}
+
+/* @base points to an array of @count structures of size @stride,
+ * each starting with a "const char *name" member. */
+static void name_index_build(struct name_index *index, const void *base,
+                             size_t stride, int count)
+{
+	uint32_t slots;
+	uint32_t seed;
+	uint32_t h;
+	int i;
+
+	for (slots = 4; slots < (uint32_t) count * 4 &&
+	     slots < NAME_INDEX_MAX_SLOTS; slots <<= 1)
+		;
+	for (seed = 0; seed < NAME_INDEX_MAX_SEEDS; seed++) {
+		memset(index->slot, 0, sizeof(index->slot));
+		for (i = 0; i < count; i++) {
+			h = name_hash(NAME_AT(base, stride, i), seed) &
+			    (slots - 1);
+			if (index->slot[h] != 0) {
+				break;
+			}
+			index->slot[h] = i + 1;
+		}
+		if (i == count) {
+			break;
+		}
+	}
+	if (seed == NAME_INDEX_MAX_SEEDS) {
+		/* Cannot happen for the names above, but stay correct
+		 * anyway: an empty index sends every lookup to the
+		 * prefix matcher. */
+		logv("no perfect hash found for %d names", count);
+		memset(index->slot, 0, sizeof(index->slot));
+	}
+	index->seed  = seed;
+	index->mask  = slots - 1;
+	index->built = 1;
+}
+
+static int name_index_lookup(struct name_index *index, const void *base,
+                             size_t stride, int count, const char *name)
+{
+	int i;
+
+	if (!index->built) {
+		name_index_build(index, base, stride, count);
+	}
+	i = index->slot[name_hash(name, index->seed) & index->mask] - 1;
+	if (i >= 0 && strcmp(NAME_AT(base, stride, i), name) == 0) {
+		return i;
+	}
+	return -1;
+}
+
+const struct sja1105_table *sja1105_table_lookup(const char *name)
+{
+	const char *options[ARRAY_SIZE(sja1105_tables)];
+	int i;
+
+	i = name_index_lookup(&table_index, sja1105_tables,
+	                      sizeof(*sja1105_tables),
+	                      sja1105_table_count, name);
+	if (i >= 0) {
+		return &sja1105_tables[i];
+	}
+	for (i = 0; i < sja1105_table_count; i++) {
+		options[i] = sja1105_tables[i].name;
+	}
+	i = get_match(name, options, sja1105_table_count);
+	return (i < 0) ? NULL : &sja1105_tables[i];
+}
+
+const struct sja1105_field *
+sja1105_field_lookup(const struct sja1105_table *table, const char *name)
+{
+	const char *options[SJA1105_MAX_FIELD_COUNT];
+	int indices[SJA1105_MAX_FIELD_COUNT];
+	int count = 0;
+	int i;
+
+	i = name_index_lookup(&field_index[table - sja1105_tables],
+	                      table->fields, sizeof(*table->fields),
+	                      table->field_count, name);
+	if (i >= 0 && !(table->fields[i].flags & SJA1105_FIELD_INTERNAL)) {
+		return &table->fields[i];
+	}
+	for (i = 0; i < table->field_count; i++) {
+		if (table->fields[i].flags & SJA1105_FIELD_INTERNAL) {
+			continue;
+		}
+		indices[count] = i;
+		options[count++] = table->fields[i].name;
+	}
+	i = get_match(name, options, count);
+	return (i < 0) ? NULL : &table->fields[indices[i]];
+}
+
+/* Exact field name to index in table->fields, -1 if there is none.
+ * For decoders, which must neither accept abbreviations nor print. */
+int sja1105_field_index(const struct sja1105_table *table, const char *name)
+{
+	return name_index_lookup(&field_index[table - sja1105_tables],
+	                         table->fields, sizeof(*table->fields),
+	                         table->field_count, name);
+}
+
+/* Accessors into a struct sja1105_static_config */
+
+int *sja1105_table_count_get(const struct sja1105_table *table,
+                             struct sja1105_static_config *config)
+{
+	return (int*) ((char*) config + table->count_offset);
+}
+
+void *sja1105_table_entry_get(const struct sja1105_table *table,
+                              struct sja1105_static_config *config,
+                              int index)
+{
+	return (char*) config + table->entries_offset +
+	       index * table->entry_size;
+}
+
+uint64_t *sja1105_field_get(const struct sja1105_field *field, void *entry)
+{
+	return (uint64_t*) ((char*) entry + field->offset);
+}
+
+int sja1105_field_width(const struct sja1105_field *field,
+                        uint64_t device_id)
+{
+	if (IS_ET(device_id)) {
+		return field->width_et;
+	}
+	if (IS_PQRS(device_id)) {
+		return field->width_pqrs;
+	}
+	/* Unknown device: be permissive */
+	return (field->width_et > field->width_pqrs) ?
+	        field->width_et : field->width_pqrs;
+}
+
+int sja1105_field_present(const struct sja1105_table *table,
+                          const struct sja1105_field *field,
+                          void *entry)
+{
+	const struct sja1105_field *cond;
+
+	if (field->cond_field < 0) {
+		return 1;
+	}
+	cond = &table->fields[field->cond_field];
+	return *sja1105_field_get(cond, entry) == field->cond_value;
+}
+
+int sja1105_field_check(const struct sja1105_field *field,
+                        uint64_t device_id, uint64_t *values)
+{
+	int width = sja1105_field_width(field, device_id);
+	int i;
+
+	if (width == 0) {
+		loge("Field %s is not available on %s", field->name,
+		     sja1105_device_id_string_get(device_id,
+		     SJA1105_PART_NR_DONT_CARE));
+		return -EINVAL;
+	}
+	if (width >= 64) {
+		return 0;
+	}
+	for (i = 0; i < field->count; i++) {
+		if (values[i] >> width) {
+			loge("Value 0x%" PRIX64 " does not fit in the "
+			     "%d bits of field %s", values[i], width,
+			     field->name);
+			return -ERANGE;
+		}
+	}
+	return 0;
+}
+
+int sja1105_static_config_check(struct sja1105_static_config *config)
+{
+	const struct sja1105_table *table;
+	const struct sja1105_field *field;
+	void *entry;
+	int count;
+	int rc;
+	int i, j, k;
+
+	for (i = 0; i < sja1105_table_count; i++) {
+		table = &sja1105_tables[i];
+		if (table->fields == NULL) {
+			continue;
+		}
+		count = *sja1105_table_count_get(table, config);
+		for (j = 0; j < count; j++) {
+			entry = sja1105_table_entry_get(table, config, j);
+			for (k = 0; k < table->field_count; k++) {
+				field = &table->fields[k];
+				if (sja1105_field_width(field,
+				    config->device_id) == 0) {
+					/* Ignored by the packing code */
+					continue;
+				}
+				if (!sja1105_field_present(table, field, entry)) {
+					continue;
+				}
+				rc = sja1105_field_check(field,
+				                         config->device_id,
+				                         sja1105_field_get(field,
+				                         entry));
+				if (rc < 0) {
+					loge("%s entry %d is out of range",
+					     table->name, j);
+					return rc;
+				}
+			}
+		}
+	}
+	return 0;
+}
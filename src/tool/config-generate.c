@@ -0,0 +1,767 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include "internal.h"
+/* From libsja1105 */
+#include <lib/include/static-config.h>
+#include <common.h>
+
+/* Expand a compact JSON description of the switch into a complete
+ * static config. Whatever the spec does not mention takes the value
+ * of the ls1021atsn built-in config, so that "{}" generates exactly
+ * that config.
+ */
+#define GENERATE_PORTS    5
+#define GENERATE_PRIOS    8
+#define GENERATE_VLANS    4096
+/* Value of HOST_PORT, CASC_PORT and MIRR_PORT that selects no port */
+#define GENERATE_NO_PORT  6
+#define GENERATE_ALL_PORTS ((1 << GENERATE_PORTS) - 1)
+
+struct generate_vlan {
+	uint8_t  used;
+	uint64_t vmemb_port;
+	uint64_t vlan_bc;
+	uint64_t tag_port;
+};
+
+static int generate_error(struct sja1105_json *json, int token,
+                          const char *what)
+{
+	loge("%s:%d: %s", json->name, json->tokens[token].line, what);
+	return -EINVAL;
+}
+
+/* A list of indices: a single number, an array of numbers, or a string
+ * such as "0,2-4" or "all". Returns the number of selected indices. */
+static int generate_list(struct sja1105_json *json, int token,
+                         uint8_t *selected, int max)
+{
+	char buf[MAX_LINE_SIZE];
+	uint64_t index;
+	int element;
+	int count = 0;
+	int rc;
+
+	if (json->tokens[token].type != SJA1105_JSON_ARRAY) {
+		rc = sja1105_json_string(json, token, buf, sizeof(buf));
+		if (rc < 0) {
+			return rc;
+		}
+		rc = read_index_list(buf, selected, max);
+		if (rc < 0) {
+			return generate_error(json, token, "invalid list");
+		}
+		return rc;
+	}
+	memset(selected, 0, max);
+	for (element = sja1105_json_child(json, token); element >= 0;
+	     element = sja1105_json_sibling(json, element)) {
+		rc = sja1105_json_u64(json, element, &index);
+		if (rc < 0) {
+			return rc;
+		}
+		if (index >= (uint64_t) max) {
+			return generate_error(json, element, "index out of range");
+		}
+		count += !selected[index];
+		selected[index] = 1;
+	}
+	return count;
+}
+
+/* Optional list of ports, as a mask */
+static int generate_port_mask(struct sja1105_json *json, int object,
+                              const char *name, uint64_t *mask)
+{
+	uint8_t selected[GENERATE_PORTS];
+	int token;
+	int rc;
+	int i;
+
+	token = sja1105_json_member(json, object, name);
+	if (token < 0) {
+		return 0;
+	}
+	rc = generate_list(json, token, selected, GENERATE_PORTS);
+	if (rc < 0) {
+		return rc;
+	}
+	for (*mask = 0, i = 0; i < GENERATE_PORTS; i++) {
+		*mask |= (uint64_t) selected[i] << i;
+	}
+	return 0;
+}
+
+/* Optional number, left untouched if not given */
+static int generate_u64(struct sja1105_json *json, int object,
+                        const char *name, uint64_t *value)
+{
+	int token;
+
+	token = sja1105_json_member(json, object, name);
+	if (token < 0) {
+		return 0;
+	}
+	return sja1105_json_u64(json, token, value);
+}
+
+/* Optional choice among names, stored as the index of the name */
+static int generate_enum(struct sja1105_json *json, int object,
+                         const char *name, const char **names, int count,
+                         uint64_t *value)
+{
+	char buf[MAX_LINE_SIZE];
+	int token;
+	int rc;
+	int i;
+
+	token = sja1105_json_member(json, object, name);
+	if (token < 0) {
+		return 0;
+	}
+	rc = sja1105_json_string(json, token, buf, sizeof(buf));
+	if (rc < 0) {
+		return rc;
+	}
+	for (i = 0; i < count; i++) {
+		if (strcmp(buf, names[i]) == 0) {
+			*value = i;
+			return 0;
+		}
+	}
+	loge("%s:%d: unknown %s \"%s\"", json->name, json->tokens[token].line,
+	     name, buf);
+	return -EINVAL;
+}
+
+static int generate_bool(struct sja1105_json *json, int object,
+                         const char *name, uint64_t *value)
+{
+	const char *names[] = {
+		"false",
+		"true",
+	};
+
+	return generate_enum(json, object, name, names, ARRAY_SIZE(names),
+	                     value);
+}
+
+/* Optional port number, or "none" */
+static int generate_port(struct sja1105_json *json, int object,
+                         const char *name, uint64_t *port)
+{
+	int token;
+	int rc;
+
+	token = sja1105_json_member(json, object, name);
+	if (token < 0) {
+		return 0;
+	}
+	if (sja1105_json_eq(json, token, "none")) {
+		*port = GENERATE_NO_PORT;
+		return 0;
+	}
+	rc = sja1105_json_u64(json, token, port);
+	if (rc < 0) {
+		return rc;
+	}
+	if (*port >= GENERATE_PORTS) {
+		return generate_error(json, token, "no such port");
+	}
+	return 0;
+}
+
+/* The ls1021atsn built-in config */
+static void generate_defaults(struct sja1105_static_config *config)
+{
+	struct sja1105_general_params_entry *general;
+	struct sja1105_l2_policing_entry *policer;
+	struct sja1105_mac_config_entry *mac;
+	int port, prio;
+	int i;
+
+	config->l2_policing_count = GENERATE_PORTS * GENERATE_PRIOS;
+	for (i = 0; i < MAX_L2_POLICING_COUNT; i++) {
+		policer = &config->l2_policing[i];
+		policer->sharindx = i;
+		policer->smax     = 0xFFFF;
+		policer->rate     = 1000 * SJA1105_POLICER_RATE_PER_MBPS;
+		policer->maxlen   = 1518;
+	}
+	config->mac_config_count = GENERATE_PORTS;
+	for (port = 0; port < GENERATE_PORTS; port++) {
+		mac = &config->mac_config[port];
+		for (prio = 0; prio < GENERATE_PRIOS; prio++) {
+			mac->base[prio]    = prio * 64;
+			mac->top[prio]     = prio * 64 + 63;
+			mac->enabled[prio] = 1;
+		}
+		/* 1 Gbps */
+		mac->speed     = 1;
+		mac->maxage    = 0xFF;
+		mac->dyn_learn = 1;
+		mac->egress    = 1;
+		mac->ingress   = 1;
+		/* RGMII, the LS1021 CPU on port 4 and PHYs on the others */
+		config->xmii_params[0].xmii_mode[port] = 2;
+		config->xmii_params[0].phy_mac[port] = (port != 4);
+	}
+	config->xmii_params_count = 1;
+	/* Port entries, then one egress entry per priority */
+	config->l2_forwarding_count = MAX_L2_FORWARDING_COUNT;
+	for (port = 0; port < GENERATE_PORTS; port++) {
+		for (prio = 0; prio < GENERATE_PRIOS; prio++) {
+			config->l2_forwarding[port].vlan_pmap[prio] = prio;
+			config->l2_forwarding[GENERATE_PORTS + prio].vlan_pmap[port] = prio;
+		}
+	}
+	config->l2_forwarding_params_count = 1;
+	config->l2_forwarding_params[0].part_spc[0] = MAX_FRAME_MEMORY;
+
+	config->l2_lookup_params_count = 1;
+	config->l2_lookup_params[0].shared_learn = 1;
+	if (IS_ET(config->device_id)) {
+		config->l2_lookup_params[0].dyn_tbsz = 4;
+		config->l2_lookup_params[0].poly = 0x97;
+	} else {
+		for (port = 0; port < GENERATE_PORTS; port++) {
+			config->l2_lookup_params[0].maxaddrp[port] =
+				MAX_L2_LOOKUP_COUNT / GENERATE_PORTS;
+		}
+	}
+	config->general_params_count = 1;
+	general = &config->general_params[0];
+	general->mirr_ptacu = 1;
+	general->switchid   = 3;
+	general->mac_flt1   = 0xFFFFFFFFFFFFull;
+	general->mac_flt0   = 0xFFFFFFFFFFFFull;
+	general->casc_port  = GENERATE_NO_PORT;
+	general->host_port  = GENERATE_NO_PORT;
+	general->mirr_port  = 4;
+	general->tpid       = 0x8100;
+	general->ignore2stf = 1;
+	general->tpid2      = 0x9100;
+}
+
+static int generate_general(struct sja1105_json *json, int root,
+                            struct sja1105_static_config *config)
+{
+	struct sja1105_general_params_entry *general;
+	int rc;
+
+	general = &config->general_params[0];
+	rc = generate_u64(json, root, "switch-id", &general->switchid);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_u64(json, root, "host-prio", &general->hostprio);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_port(json, root, "host-port", &general->host_port);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_port(json, root, "cascade-port", &general->casc_port);
+	if (rc < 0) {
+		return rc;
+	}
+	return generate_port(json, root, "mirror-port", &general->mirr_port);
+}
+
+static int generate_port_apply(struct sja1105_json *json, int object,
+                               struct sja1105_static_config *config,
+                               int port, uint64_t *reach, uint64_t *enabled)
+{
+	const char *roles[] = {
+		"mac",
+		"phy",
+	};
+	const char *modes[] = {
+		"mii",
+		"rmii",
+		"rgmii",
+		"sgmii",
+	};
+	const char *speeds[] = {
+		"auto",
+		"1000",
+		"100",
+		"10",
+	};
+	struct sja1105_mac_config_entry *mac = &config->mac_config[port];
+	struct sja1105_xmii_params_entry *xmii = &config->xmii_params[0];
+	uint64_t on = (*enabled >> port) & 1;
+	int token;
+	int prio;
+	int rc;
+
+	rc = generate_enum(json, object, "role", roles, ARRAY_SIZE(roles),
+	                   &xmii->phy_mac[port]);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_enum(json, object, "xmii", modes, ARRAY_SIZE(modes),
+	                   &xmii->xmii_mode[port]);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_enum(json, object, "speed", speeds, ARRAY_SIZE(speeds),
+	                   &mac->speed);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_bool(json, object, "enabled", &on);
+	if (rc < 0) {
+		return rc;
+	}
+	mac->ingress = mac->egress = on;
+	*enabled = (*enabled & ~(1ull << port)) | (on << port);
+	rc = generate_bool(json, object, "learning", &mac->dyn_learn);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_bool(json, object, "drop-untagged", &mac->drpuntag);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_bool(json, object, "drop-double-tagged", &mac->drpdtag);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_u64(json, object, "pvid", &mac->vlanid);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_u64(json, object, "default-prio", &mac->vlanprio);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_port_mask(json, object, "reach", &reach[port]);
+	if (rc < 0) {
+		return rc;
+	}
+	/* Ingress PCP to switch priority */
+	token = sja1105_json_member(json, object, "priority-map");
+	if (token < 0) {
+		return 0;
+	}
+	if (json->tokens[token].type != SJA1105_JSON_ARRAY ||
+	    json->tokens[token].size != GENERATE_PRIOS) {
+		return generate_error(json, token,
+		                      "priority-map needs 8 priorities");
+	}
+	for (prio = 0, token = sja1105_json_child(json, token); token >= 0;
+	     token = sja1105_json_sibling(json, token), prio++) {
+		rc = sja1105_json_u64(json, token,
+		                      &config->l2_forwarding[port].vlan_pmap[prio]);
+		if (rc < 0) {
+			return rc;
+		}
+	}
+	return 0;
+}
+
+/* The forwarding domains derive from which ports are enabled, and from
+ * which ports each one may reach */
+static int generate_ports(struct sja1105_json *json, int root,
+                          struct sja1105_static_config *config)
+{
+	struct sja1105_l2_forwarding_entry *fwd;
+	uint8_t selected[GENERATE_PORTS];
+	uint64_t reach[GENERATE_PORTS];
+	uint64_t enabled = GENERATE_ALL_PORTS;
+	int ports, object, token;
+	int port;
+	int rc;
+
+	for (port = 0; port < GENERATE_PORTS; port++) {
+		reach[port] = GENERATE_ALL_PORTS;
+	}
+	ports = sja1105_json_member(json, root, "ports");
+	if (ports >= 0 && json->tokens[ports].type != SJA1105_JSON_ARRAY) {
+		return generate_error(json, ports, "expected an array of ports");
+	}
+	for (object = sja1105_json_child(json, ports); object >= 0;
+	     object = sja1105_json_sibling(json, object)) {
+		token = sja1105_json_member(json, object, "port");
+		if (token < 0) {
+			return generate_error(json, object, "expected \"port\"");
+		}
+		rc = generate_list(json, token, selected, GENERATE_PORTS);
+		if (rc < 0) {
+			return rc;
+		}
+		for (port = 0; port < GENERATE_PORTS; port++) {
+			if (!selected[port]) {
+				continue;
+			}
+			rc = generate_port_apply(json, object, config, port,
+			                         reach, &enabled);
+			if (rc < 0) {
+				return rc;
+			}
+		}
+	}
+	for (port = 0; port < GENERATE_PORTS; port++) {
+		fwd = &config->l2_forwarding[port];
+		fwd->reach_port = reach[port] & enabled & ~(1ull << port);
+		fwd->bc_domain  = fwd->reach_port;
+		fwd->fl_domain  = fwd->reach_port;
+	}
+	return 0;
+}
+
+static int generate_vlan_apply(struct sja1105_json *json, int object,
+                               struct generate_vlan *vlans)
+{
+	static uint8_t vids[GENERATE_VLANS];
+	struct generate_vlan vlan = {
+		.used       = 1,
+		.vmemb_port = GENERATE_ALL_PORTS,
+		.tag_port   = 0,
+	};
+	int broadcast = 0;
+	int token;
+	int vid;
+	int rc;
+
+	token = sja1105_json_member(json, object, "vid");
+	if (token < 0) {
+		return generate_error(json, object, "expected \"vid\"");
+	}
+	rc = generate_list(json, token, vids, GENERATE_VLANS);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_port_mask(json, object, "members", &vlan.vmemb_port);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_port_mask(json, object, "tagged", &vlan.tag_port);
+	if (rc < 0) {
+		return rc;
+	}
+	vlan.vlan_bc = vlan.vmemb_port;
+	broadcast = sja1105_json_member(json, object, "broadcast");
+	rc = generate_port_mask(json, object, "broadcast", &vlan.vlan_bc);
+	if (rc < 0) {
+		return rc;
+	}
+	if (vlan.tag_port & ~vlan.vmemb_port) {
+		return generate_error(json, token, "tagged ports must be members");
+	}
+	if (broadcast >= 0 && (vlan.vlan_bc & ~vlan.vmemb_port)) {
+		return generate_error(json, broadcast,
+		                      "broadcast ports must be members");
+	}
+	/* Later ranges override earlier ones */
+	for (vid = 0; vid < GENERATE_VLANS; vid++) {
+		if (vids[vid]) {
+			vlans[vid] = vlan;
+		}
+	}
+	return 0;
+}
+
+static int generate_vlans(struct sja1105_json *json, int root,
+                          struct sja1105_static_config *config)
+{
+	static struct generate_vlan vlans[GENERATE_VLANS];
+	struct sja1105_vlan_lookup_entry *entry;
+	int array, object;
+	int vid;
+	int rc;
+
+	memset(vlans, 0, sizeof(vlans));
+	array = sja1105_json_member(json, root, "vlans");
+	if (array < 0) {
+		/* VLAN 0 on all ports */
+		vlans[0].used = 1;
+		vlans[0].vmemb_port = vlans[0].vlan_bc = GENERATE_ALL_PORTS;
+	} else if (json->tokens[array].type != SJA1105_JSON_ARRAY) {
+		return generate_error(json, array, "expected an array of vlans");
+	}
+	for (object = sja1105_json_child(json, array); object >= 0;
+	     object = sja1105_json_sibling(json, object)) {
+		rc = generate_vlan_apply(json, object, vlans);
+		if (rc < 0) {
+			return rc;
+		}
+	}
+	config->vlan_lookup_count = 0;
+	for (vid = 0; vid < GENERATE_VLANS; vid++) {
+		if (!vlans[vid].used) {
+			continue;
+		}
+		entry = &config->vlan_lookup[config->vlan_lookup_count++];
+		entry->vlanid     = vid;
+		entry->vmemb_port = vlans[vid].vmemb_port;
+		entry->vlan_bc    = vlans[vid].vlan_bc;
+		entry->tag_port   = vlans[vid].tag_port;
+	}
+	return 0;
+}
+
+/* Optional "rate-mbps" of a "policers" element, to RATE units.
+ * Returns 1 if given, 0 if not. */
+static int generate_rate_mbps(struct sja1105_json *json, int object,
+                              uint64_t *rate)
+{
+	int rounded;
+	int token;
+	int rc;
+
+	token = sja1105_json_member(json, object, "rate-mbps");
+	if (token < 0) {
+		return 0;
+	}
+	rc = sja1105_json_fixed(json, token, SJA1105_POLICER_RATE_PER_MBPS,
+	                        rate, &rounded);
+	if (rc < 0) {
+		return rc;
+	}
+	if (rounded) {
+		logi("%s:%d: rate-mbps rounded to %" PRIu64 "/%d Mbps",
+		     json->name, json->tokens[token].line, *rate,
+		     SJA1105_POLICER_RATE_PER_MBPS);
+	}
+	if (*rate == 0 && rounded) {
+		loge("%s:%d: rate-mbps is below the resolution of 1/%d Mbps",
+		     json->name, json->tokens[token].line,
+		     SJA1105_POLICER_RATE_PER_MBPS);
+		return -ERANGE;
+	}
+	return 1;
+}
+
+/* Fields given in a "policers" element, over the policer's defaults.
+ * rate is NULL if the element has no "rate-mbps". */
+static int generate_policer_value(struct sja1105_json *json, int object,
+                                  const uint64_t *rate,
+                                  struct sja1105_l2_policing_entry *entry)
+{
+	int rc;
+
+	if (rate != NULL) {
+		entry->rate = *rate;
+	}
+	rc = generate_u64(json, object, "burst", &entry->smax);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = generate_u64(json, object, "mtu", &entry->maxlen);
+	if (rc < 0) {
+		return rc;
+	}
+	return generate_u64(json, object, "partition", &entry->partition);
+}
+
+static int generate_policer_apply(struct sja1105_json *json, int object,
+                                  struct sja1105_static_config *config)
+{
+	uint8_t ports[GENERATE_PORTS];
+	uint8_t prios[GENERATE_PRIOS];
+	const uint64_t *given_rate;
+	uint64_t rate = 0;
+	int bcast = 0;
+	int token;
+	int port, prio;
+	int rc;
+
+	token = sja1105_json_member(json, object, "port");
+	if (token < 0) {
+		return generate_error(json, object, "expected \"port\"");
+	}
+	rc = generate_list(json, token, ports, GENERATE_PORTS);
+	if (rc < 0) {
+		return rc;
+	}
+	token = sja1105_json_member(json, object, "prio");
+	if (token < 0) {
+		return generate_error(json, object, "expected \"prio\"");
+	}
+	if (sja1105_json_eq(json, token, "bcast")) {
+		/* Broadcast policers follow the per-priority ones */
+		bcast = 1;
+		config->l2_policing_count = MAX_L2_POLICING_COUNT;
+	} else {
+		rc = generate_list(json, token, prios, GENERATE_PRIOS);
+		if (rc < 0) {
+			return rc;
+		}
+	}
+	rc = generate_rate_mbps(json, object, &rate);
+	if (rc < 0) {
+		return rc;
+	}
+	given_rate = rc ? &rate : NULL;
+	for (port = 0; port < GENERATE_PORTS; port++) {
+		if (!ports[port]) {
+			continue;
+		}
+		if (bcast) {
+			rc = generate_policer_value(json, object, given_rate,
+			     &config->l2_policing[GENERATE_PORTS *
+			                          GENERATE_PRIOS + port]);
+			if (rc < 0) {
+				return rc;
+			}
+			continue;
+		}
+		for (prio = 0; prio < GENERATE_PRIOS; prio++) {
+			if (!prios[prio]) {
+				continue;
+			}
+			rc = generate_policer_value(json, object, given_rate,
+			     &config->l2_policing[port * GENERATE_PRIOS + prio]);
+			if (rc < 0) {
+				return rc;
+			}
+		}
+	}
+	return 0;
+}
+
+static int generate_policers(struct sja1105_json *json, int root,
+                             struct sja1105_static_config *config)
+{
+	int array, object;
+	int rc;
+
+	array = sja1105_json_member(json, root, "policers");
+	if (array >= 0 && json->tokens[array].type != SJA1105_JSON_ARRAY) {
+		return generate_error(json, array, "expected an array of policers");
+	}
+	for (object = sja1105_json_child(json, array); object >= 0;
+	     object = sja1105_json_sibling(json, object)) {
+		rc = generate_policer_apply(json, object, config);
+		if (rc < 0) {
+			return rc;
+		}
+	}
+	return 0;
+}
+
+/* Frame memory in 128-byte blocks for each of the 8 partitions */
+static int generate_partitions(struct sja1105_json *json, int root,
+                               struct sja1105_static_config *config)
+{
+	uint64_t *part_spc = config->l2_forwarding_params[0].part_spc;
+	int array, token;
+	int i;
+	int rc;
+
+	array = sja1105_json_member(json, root, "partitions");
+	if (array < 0) {
+		return 0;
+	}
+	if (json->tokens[array].type != SJA1105_JSON_ARRAY ||
+	    json->tokens[array].size > 8) {
+		return generate_error(json, array,
+		                      "expected an array of at most 8 partitions");
+	}
+	memset(part_spc, 0, 8 * sizeof(*part_spc));
+	for (i = 0, token = sja1105_json_child(json, array); token >= 0;
+	     token = sja1105_json_sibling(json, token), i++) {
+		rc = sja1105_json_u64(json, token, &part_spc[i]);
+		if (rc < 0) {
+			return rc;
+		}
+	}
+	return 0;
+}
+
+int sja1105_staging_area_generate(const char *spec_file,
+                                  struct sja1105_staging_area *staging_area)
+{
+	struct sja1105_static_config *config = &staging_area->static_config;
+	struct sja1105_json json;
+	int rc;
+
+	rc = sja1105_json_load(&json, spec_file);
+	if (rc < 0) {
+		goto out;
+	}
+	if (json.tokens[0].type != SJA1105_JSON_OBJECT) {
+		rc = generate_error(&json, 0, "expected an object");
+		goto out;
+	}
+	memset(config, 0, sizeof(*config));
+	config->device_id = SJA1105T_DEVICE_ID;
+	rc = generate_u64(&json, 0, "device-id", &config->device_id);
+	if (rc < 0) {
+		goto out;
+	}
+	if (!DEVICE_ID_VALID(config->device_id)) {
+		rc = generate_error(&json, sja1105_json_member(&json, 0,
+		                    "device-id"), "unknown device id");
+		goto out;
+	}
+	generate_defaults(config);
+	rc = generate_general(&json, 0, config);
+	if (rc < 0) {
+		goto out;
+	}
+	rc = generate_ports(&json, 0, config);
+	if (rc < 0) {
+		goto out;
+	}
+	rc = generate_vlans(&json, 0, config);
+	if (rc < 0) {
+		goto out;
+	}
+	rc = generate_policers(&json, 0, config);
+	if (rc < 0) {
+		goto out;
+	}
+	rc = generate_partitions(&json, 0, config);
+	if (rc < 0) {
+		goto out;
+	}
+	rc = sja1105_l2_policing_check(config);
+	if (rc < 0) {
+		goto out;
+	}
+	rc = sja1105_static_config_check_valid(config);
+	if (rc < 0) {
+		goto out;
+	}
+	logi("Generated %d VLANs and %d policers", config->vlan_lookup_count,
+	     config->l2_policing_count);
+out:
+	sja1105_json_free(&json);
+	return rc;
+}
@@ -0,0 +1,363 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include "internal.h"
+/* From libsja1105 */
+#include <lib/include/static-config.h>
+#include <common.h>
+
+/* The staging area as JSON, with the same names as the XML format:
+ *
+ * {
+ *   "device-id": 2650800910,
+ *   "static": {
+ *     "l2-policing-table": [
+ *       {"sharindx": 0, "smax": 65535, "rate": 6432, ...},
+ *       ...
+ *     ],
+ *     ...
+ *   }
+ * }
+ *
+ * Entries are numbered by their position in the table array. Numbers
+ * may also be given as strings ("0x1F"), and arrays either as JSON
+ * arrays or in the "[0x1 0x2 ...]" notation of the XML format.
+ */
+
+static int json_error(struct sja1105_json *json, int token, const char *what)
+{
+	loge("%s:%d: %s", json->name, json->tokens[token].line, what);
+	return -EINVAL;
+}
+
+static int json_array_read(struct sja1105_json *json, int token,
+                           uint64_t *values, int count)
+{
+	char buf[MAX_LINE_SIZE];
+	int element;
+	int i = 0;
+	int rc;
+
+	if (json->tokens[token].type != SJA1105_JSON_ARRAY) {
+		rc = sja1105_json_string(json, token, buf, sizeof(buf));
+		if (rc < 0) {
+			return rc;
+		}
+		return read_array(buf, values, count);
+	}
+	for (element = sja1105_json_child(json, token); element >= 0;
+	     element = sja1105_json_sibling(json, element)) {
+		if (i == count) {
+			return count + 1;
+		}
+		rc = sja1105_json_u64(json, element, &values[i++]);
+		if (rc < 0) {
+			return rc;
+		}
+	}
+	return i;
+}
+
+static int json_entry_read(struct sja1105_json *json, int object,
+                           const struct sja1105_table *table,
+                           struct sja1105_static_config *config)
+{
+	int values[SJA1105_MAX_FIELD_COUNT];
+	const struct sja1105_field *field;
+	char name[MAX_LINE_SIZE];
+	int  *count;
+	void *entry;
+	int   key;
+	int   rc;
+	int   i;
+
+	if (json->tokens[object].type != SJA1105_JSON_OBJECT) {
+		return json_error(json, object, "entry must be an object");
+	}
+	count = sja1105_table_count_get(table, config);
+	if (*count >= table->max_count) {
+		loge("Cannot have more than %d %s entries!",
+		     table->max_count, table->description);
+		return -ERANGE;
+	}
+	for (i = 0; i < table->field_count; i++) {
+		values[i] = -1;
+	}
+	for (key = sja1105_json_child(json, object); key >= 0;
+	     key = sja1105_json_sibling(json, key)) {
+		rc = sja1105_json_string(json, key, name, sizeof(name));
+		if (rc < 0) {
+			return rc;
+		}
+		i = sja1105_field_index(table, name);
+		if (i < 0) {
+			logv("%s:%d: ignoring member %s", json->name,
+			     json->tokens[key].line, name);
+			continue;
+		}
+		values[i] = key + 1;
+	}
+	entry = sja1105_table_entry_get(table, config, *count);
+	memset(entry, 0, table->entry_size);
+	for (i = 0; i < table->field_count; i++) {
+		field = &table->fields[i];
+		if (field->flags & (SJA1105_FIELD_NO_XML |
+		                    SJA1105_FIELD_INTERNAL)) {
+			continue;
+		}
+		if (!sja1105_field_present(table, field, entry)) {
+			continue;
+		}
+		if (values[i] < 0) {
+			loge("%s:%d: %s entry has no member \"%s\"",
+			     json->name, json->tokens[object].line,
+			     table->description, field->name);
+			return -EINVAL;
+		}
+		if (field->count == 1) {
+			rc = sja1105_json_u64(json, values[i],
+			                      sja1105_field_get(field, entry));
+		} else {
+			rc = json_array_read(json, values[i],
+			                     sja1105_field_get(field, entry),
+			                     field->count);
+			if (rc >= 0 && rc != field->count) {
+				loge("%s:%d: %s must have %d elements!",
+				     json->name, json->tokens[values[i]].line,
+				     field->name, field->count);
+				rc = -ERANGE;
+			}
+		}
+		if (rc < 0) {
+			return rc;
+		}
+	}
+	(*count)++;
+	return 0;
+}
+
+static int json_static_read(struct sja1105_json *json, int object,
+                            struct sja1105_static_config *config)
+{
+	const struct sja1105_table *table;
+	char name[MAX_LINE_SIZE];
+	int key, entry;
+	int rc;
+
+	if (object < 0 || json->tokens[object].type != SJA1105_JSON_OBJECT) {
+		loge("%s: \"static\" object not present in JSON!", json->name);
+		return -EINVAL;
+	}
+	for (key = sja1105_json_child(json, object); key >= 0;
+	     key = sja1105_json_sibling(json, key)) {
+		rc = sja1105_json_string(json, key, name, sizeof(name));
+		if (rc < 0) {
+			return rc;
+		}
+		table = sja1105_table_lookup(name);
+		if (table == NULL) {
+			loge("ignoring JSON table %s", name);
+			continue;
+		}
+		if (table->fields == NULL) {
+			logv("%s unimplemented", table->description);
+			continue;
+		}
+		if (json->tokens[key + 1].type != SJA1105_JSON_ARRAY) {
+			return json_error(json, key + 1,
+			                  "table must be an array");
+		}
+		for (entry = sja1105_json_child(json, key + 1); entry >= 0;
+		     entry = sja1105_json_sibling(json, entry)) {
+			rc = json_entry_read(json, entry, table, config);
+			if (rc < 0) {
+				return rc;
+			}
+		}
+		logv("read %d %s entries",
+		     *sja1105_table_count_get(table, config),
+		     table->description);
+	}
+	return 0;
+}
+
+int
+sja1105_staging_area_from_json(const char *json_file,
+                               struct sja1105_staging_area *staging_area)
+{
+	struct sja1105_static_config *config = &staging_area->static_config;
+	struct sja1105_json json;
+	int device_id;
+	int rc;
+	int prof;
+
+	prof = sja1105_profile_begin("json-parse", NULL);
+	rc = sja1105_json_load(&json, json_file);
+	if (rc < 0) {
+		goto out;
+	}
+	if (json.tokens[0].type != SJA1105_JSON_OBJECT) {
+		rc = json_error(&json, 0, "expected an object");
+		goto out;
+	}
+	memset(staging_area, 0, sizeof(*staging_area));
+	device_id = sja1105_json_member(&json, 0, "device-id");
+	if (device_id < 0) {
+		loge("%s: \"device-id\" not present in JSON!", json.name);
+		rc = -EINVAL;
+		goto out;
+	}
+	rc = sja1105_json_u64(&json, device_id, &config->device_id);
+	if (rc < 0) {
+		goto out;
+	}
+	rc = json_static_read(&json, sja1105_json_member(&json, 0, "static"),
+	                      config);
+	if (rc < 0) {
+		goto out;
+	}
+	/* Catch values that packing would silently truncate */
+	rc = sja1105_static_config_check(config);
+out:
+	sja1105_json_free(&json);
+	sja1105_profile_end(prof);
+	return rc;
+}
+
+/* Numbers are written in decimal, which is what JSON consumers expect */
+static void json_u64_write(FILE *f, uint64_t value)
+{
+	char  buf[24];
+	char *p = buf + sizeof(buf);
+
+	do {
+		*--p = '0' + value % 10;
+		value /= 10;
+	} while (value);
+	fwrite(p, 1, buf + sizeof(buf) - p, f);
+}
+
+static void json_entry_write(FILE *f, const struct sja1105_table *table,
+                             void *entry)
+{
+	const struct sja1105_field *field;
+	uint64_t *value;
+	int first = 1;
+	int i, j;
+
+	fputs("\t\t\t{", f);
+	for (i = 0; i < table->field_count; i++) {
+		field = &table->fields[i];
+		if (field->flags & (SJA1105_FIELD_NO_XML |
+		                    SJA1105_FIELD_INTERNAL)) {
+			continue;
+		}
+		if (!sja1105_field_present(table, field, entry)) {
+			continue;
+		}
+		fputs(first ? "\"" : ", \"", f);
+		fputs(field->name, f);
+		fputs("\": ", f);
+		first = 0;
+		value = sja1105_field_get(field, entry);
+		if (field->count == 1) {
+			json_u64_write(f, *value);
+			continue;
+		}
+		fputc('[', f);
+		for (j = 0; j < field->count; j++) {
+			if (j) {
+				fputs(", ", f);
+			}
+			json_u64_write(f, value[j]);
+		}
+		fputc(']', f);
+	}
+	fputc('}', f);
+}
+
+int
+sja1105_staging_area_to_json(const char *json_file,
+                             struct sja1105_staging_area *staging_area)
+{
+	static char buf[65536];
+	struct sja1105_static_config *config = &staging_area->static_config;
+	const struct sja1105_table *table;
+	FILE *f;
+	int count;
+	int rc = 0;
+	int prof;
+	int i, j;
+
+	prof = sja1105_profile_begin("json-write", NULL);
+	f = (strcmp(json_file, "-") == 0) ? stdout : fopen(json_file, "w");
+	if (f == NULL) {
+		loge("cannot open %s: %s", json_file, strerror(errno));
+		rc = -errno;
+		goto out;
+	}
+	if (f != stdout) {
+		setvbuf(f, buf, _IOFBF, sizeof(buf));
+	}
+	fputs("{\n\t\"device-id\": ", f);
+	json_u64_write(f, config->device_id);
+	fputs(",\n\t\"static\": {\n", f);
+	for (i = 0; i < sja1105_table_count; i++) {
+		table = &sja1105_tables[i];
+		count = (table->fields == NULL) ? 0 :
+		        *sja1105_table_count_get(table, config);
+		fprintf(f, "\t\t\"%s\": [%s", table->name, count ? "\n" : "");
+		for (j = 0; j < count; j++) {
+			json_entry_write(f, table,
+			                 sja1105_table_entry_get(table, config, j));
+			fputs((j == count - 1) ? "\n\t\t" : ",\n", f);
+		}
+		fputs((i == sja1105_table_count - 1) ? "]\n" : "],\n", f);
+	}
+	fputs("\t}\n}\n", f);
+	if (f == stdout) {
+		if (fflush(f) != 0) {
+			rc = -EIO;
+		}
+	} else if (fclose(f) != 0) {
+		rc = -EIO;
+	}
+	if (rc < 0) {
+		loge("could not write %s", json_file);
+	}
+out:
+	sja1105_profile_end(prof);
+	return rc;
+}
@@ -39,886 +39,146 @@
 static void print_usage(const char *prog)
 {
 	printf("%s config modify <table-name>[<entry-index>] <field-name> <field-value>\n", prog);
+	printf("<entry-index> can also be a range first:last[:stride], or all\n");
 	printf("Please run \"%s config modify help\" to see more details\n", prog);
 }
 
-static int generic_table_entry_modify(
-		uint64_t *field_addr,
-		int       entry_index,
-		int       entry_count,
-		int       entry_field_count,
-		char     *field_val)
-{
-	int rc;
-
-	if (entry_index < 0 || entry_index >= entry_count) {
-		loge("Index out of bounds!");
-		loge("Please adjust the entry count of the table:");
-		loge("* config modify <table> entry-count <value>)");
-		rc = -ERANGE;
-		goto out;
-	}
-	if (entry_field_count == 1) {
-		/* Entry is single element */
-		rc = reliable_uint64_from_string(field_addr, field_val, NULL);
-	} else {
-		/* Entry is an array */
-		rc = read_array(field_val, field_addr, entry_field_count);
-	}
-out:
-	return rc;
-}
-
-static int schedule_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"winstindex",
-		"winend",
-		"winst",
-		"destports",
-		"setvalid",
-		"txen",
-		"resmedia_en",
-		"resmedia",
-		"vlindex",
-		"delta",
-	};
-	uint64_t *fields[] = {
-		&config->schedule[entry_index].winstindex,
-		&config->schedule[entry_index].winend,
-		&config->schedule[entry_index].winst,
-		&config->schedule[entry_index].destports,
-		&config->schedule[entry_index].setvalid,
-		&config->schedule[entry_index].txen,
-		&config->schedule[entry_index].resmedia_en,
-		&config->schedule[entry_index].resmedia,
-		&config->schedule[entry_index].vlindex,
-		&config->schedule[entry_index].delta,
-	};
-	int entry_field_counts[] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->schedule_count = tmp;
-		goto out;
-	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
-	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->schedule_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int schedule_entry_points_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"subschindx",
-		"delta",
-		"address",
-	};
-	uint64_t *fields[] = {
-		&config->schedule_entry_points[entry_index].subschindx,
-		&config->schedule_entry_points[entry_index].delta,
-		&config->schedule_entry_points[entry_index].address,
-	};
-	int entry_field_counts[] = {1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->schedule_entry_points_count = tmp;
-		goto out;
-	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
-	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->schedule_entry_points_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int l2_lookup_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"tsreg",        /* P/Q/R/S only - LOCKEDS=1 */
-		"mirrvlan",     /* P/Q/R/S only - LOCKEDS=1 */
-		"takets",       /* P/Q/R/S only - LOCKEDS=1 */
-		"mirr",         /* P/Q/R/S only - LOCKEDS=1 */
-		"retag",        /* P/Q/R/S only - LOCKEDS=1 */
-		"mask_iotag",   /* P/Q/R/S only */
-		"mask_vlanid",  /* P/Q/R/S only */
-		"mask_macaddr", /* P/Q/R/S only */
-		"iotag",        /* P/Q/R/S only */
-		"vlanid",
-		"macaddr",
-		"destports",
-		"enfport",
-		"index",
-	};
-	uint64_t *fields[] = {
-		&config->l2_lookup[entry_index].tsreg,
-		&config->l2_lookup[entry_index].mirrvlan,
-		&config->l2_lookup[entry_index].takets,
-		&config->l2_lookup[entry_index].mirr,
-		&config->l2_lookup[entry_index].retag,
-		&config->l2_lookup[entry_index].mask_iotag,
-		&config->l2_lookup[entry_index].mask_vlanid,
-		&config->l2_lookup[entry_index].mask_macaddr,
-		&config->l2_lookup[entry_index].iotag,
-		&config->l2_lookup[entry_index].vlanid,
-		&config->l2_lookup[entry_index].macaddr,
-		&config->l2_lookup[entry_index].destports,
-		&config->l2_lookup[entry_index].enfport,
-		&config->l2_lookup[entry_index].index,
-	};
-	int entry_field_counts[] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->l2_lookup_count = tmp;
-		goto out;
-	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
-	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->l2_lookup_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int l2_policing_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"sharindx",
-		"smax",
-		"rate",
-		"maxlen",
-		"partition",
-	};
-	uint64_t *fields[] = {
-		&config->l2_policing[entry_index].sharindx,
-		&config->l2_policing[entry_index].smax,
-		&config->l2_policing[entry_index].rate,
-		&config->l2_policing[entry_index].maxlen,
-		&config->l2_policing[entry_index].partition,
-	};
-	int entry_field_counts[] = {1, 1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->l2_policing_count = tmp;
-		goto out;
-	}
-
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
-	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->l2_policing_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int vlan_lookup_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"ving_mirr",
-		"vegr_mirr",
-		"vmemb_port",
-		"vlan_bc",
-		"tag_port",
-		"vlanid",
-	};
-	uint64_t *fields[] = {
-		&config->vlan_lookup[entry_index].ving_mirr,
-		&config->vlan_lookup[entry_index].vegr_mirr,
-		&config->vlan_lookup[entry_index].vmemb_port,
-		&config->vlan_lookup[entry_index].vlan_bc,
-		&config->vlan_lookup[entry_index].tag_port,
-		&config->vlan_lookup[entry_index].vlanid,
-	};
-	int entry_field_counts[] = {1, 1, 1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->vlan_lookup_count = tmp;
-		goto out;
-	}
-
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
-	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->vlan_lookup_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int l2_fw_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"bc_domain",
-		"reach_port",
-		"fl_domain",
-		"vlan_pmap",
-	};
-	uint64_t *fields[] = {
-		&config->l2_forwarding[entry_index].bc_domain,
-		&config->l2_forwarding[entry_index].reach_port,
-		&config->l2_forwarding[entry_index].fl_domain,
-		config->l2_forwarding[entry_index].vlan_pmap,
-	};
-	int entry_field_counts[] = {1, 1, 1, 8, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->l2_forwarding_count = tmp;
-		goto out;
-	}
-
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
-	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->l2_forwarding_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int mac_config_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"top",
-		"base",
-		"enabled",
-		"ifg",
-		"tp_delin",
-		"tp_delout",
-		"maxage",
-		"vlanprio",
-		"vlanid",
-		"ing_mirr",
-		"egr_mirr",
-		"drpnona664",
-		"drpdtag",
-		"drpsotag", /* P/Q/R/S only */
-		"drpsitag", /* P/Q/R/S only */
-		"drpuntag",
-		"retag",
-		"dyn_learn",
-		"egress",
-		"ingress",
-		"mirrcie", /* P/Q/R/S only */
-		"mirrcetag", /* P/Q/R/S only */
-		"ingmirrvid", /* P/Q/R/S only */
-		"ingmirrpcp", /* P/Q/R/S only */
-		"ingmirrdei", /* P/Q/R/S only */
-	};
-	uint64_t *fields[] = {
-		config->mac_config[entry_index].top,
-		config->mac_config[entry_index].base,
-		config->mac_config[entry_index].enabled,
-		&config->mac_config[entry_index].ifg,
-		&config->mac_config[entry_index].tp_delin,
-		&config->mac_config[entry_index].tp_delout,
-		&config->mac_config[entry_index].maxage,
-		&config->mac_config[entry_index].vlanprio,
-		&config->mac_config[entry_index].vlanid,
-		&config->mac_config[entry_index].ing_mirr,
-		&config->mac_config[entry_index].egr_mirr,
-		&config->mac_config[entry_index].drpnona664,
-		&config->mac_config[entry_index].drpdtag,
-		&config->mac_config[entry_index].drpsotag,
-		&config->mac_config[entry_index].drpsitag,
-		&config->mac_config[entry_index].drpuntag,
-		&config->mac_config[entry_index].retag,
-		&config->mac_config[entry_index].dyn_learn,
-		&config->mac_config[entry_index].egress,
-		&config->mac_config[entry_index].ingress,
-		&config->mac_config[entry_index].mirrcie,
-		&config->mac_config[entry_index].mirrcetag,
-		&config->mac_config[entry_index].ingmirrvid,
-		&config->mac_config[entry_index].ingmirrpcp,
-		&config->mac_config[entry_index].ingmirrdei,
-	};
-	int entry_field_counts[] = {8, 8, 8, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->mac_config_count = tmp;
-		goto out;
-	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
-	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->mac_config_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int schedule_params_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"subscheind",
-	};
-	uint64_t *fields[] = {
-		config->schedule_params[entry_index].subscheind,
-	};
-	int entry_field_counts[] = {8,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->schedule_params_count = tmp;
-		goto out;
-	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
-	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->schedule_params_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int schedule_entry_points_params_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
+static int
+table_entry_count_modify(const struct sja1105_table *table,
+                         struct sja1105_static_config *config,
+                         char *field_val)
 {
-	const char *options[] = {
-		"clksrc",
-		"actsubsch",
-	};
-	uint64_t *fields[] = {
-		&config->schedule_entry_points_params[entry_index].clksrc,
-		&config->schedule_entry_points_params[entry_index].actsubsch,
-	};
-	int entry_field_counts[] = {1, 1,};
 	uint64_t tmp;
+	int *count;
 	int rc;
 
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->schedule_entry_points_params_count = tmp;
-		goto out;
-	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
+	rc = reliable_uint64_from_string(&tmp, field_val, NULL);
 	if (rc < 0) {
 		goto out;
 	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->schedule_entry_points_params_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int l2_lookup_params_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"drpbc", /* P/Q/R/S only */
-		"drpmc", /* P/Q/R/S only */
-		"drpuni", /* P/Q/R/S only */
-		"maxaddrp", /* P/Q/R/S only */
-		"maxage",
-		"start_dynspc", /* P/Q/R/S only */
-		"drpnolearn", /* P/Q/R/S only */
-		"dyn_tbsz",
-		"poly",
-		"shared_learn",
-		"no_enf_hostprt",
-		"no_mgmt_learn",
-		"use_static", /* P/Q/R/S only */
-		"owr_dyn", /* P/Q/R/S only */
-		"learn_once", /* P/Q/R/S only */
-	};
-	uint64_t *fields[] = {
-		&config->l2_lookup_params[entry_index].drpbc,
-		&config->l2_lookup_params[entry_index].drpmc,
-		&config->l2_lookup_params[entry_index].drpuni,
-		config->l2_lookup_params[entry_index].maxaddrp,
-		&config->l2_lookup_params[entry_index].maxage,
-		&config->l2_lookup_params[entry_index].start_dynspc,
-		&config->l2_lookup_params[entry_index].drpnolearn,
-		&config->l2_lookup_params[entry_index].dyn_tbsz,
-		&config->l2_lookup_params[entry_index].poly,
-		&config->l2_lookup_params[entry_index].shared_learn,
-		&config->l2_lookup_params[entry_index].no_enf_hostprt,
-		&config->l2_lookup_params[entry_index].no_mgmt_learn,
-		&config->l2_lookup_params[entry_index].use_static,
-		&config->l2_lookup_params[entry_index].owr_dyn,
-		&config->l2_lookup_params[entry_index].learn_once,
-	};
-	int entry_field_counts[] = {1, 1, 1, 5, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->l2_lookup_params_count = tmp;
+	if (tmp > (uint64_t) table->max_count) {
+		loge("%s cannot have more than %d entries",
+		     table->description, table->max_count);
+		rc = -ERANGE;
 		goto out;
 	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
+	count = sja1105_table_count_get(table, config);
+	/* New entries start out zeroed */
+	if (tmp > (uint64_t) *count) {
+		memset(sja1105_table_entry_get(table, config, *count), 0,
+		       (tmp - *count) * table->entry_size);
 	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->l2_lookup_params_count,
-			entry_field_counts[rc],
-			field_val);
+	*count = tmp;
 out:
 	return rc;
 }
 
-static int l2_fw_params_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
+/* Entries selected by the index in square brackets after the table name:
+ * [index], [first:last], [first:last:stride] or [all].
+ * Both ends of a range are inclusive. */
+struct entry_range {
+	uint64_t first;
+	uint64_t last;
+	uint64_t stride;
+	int      all;
+};
+
+static int entry_range_parse(char *str, struct entry_range *range)
 {
-	const char *options[] = {
-		"max_dynp",
-		"part_spc",
-	};
-	uint64_t *fields[] = {
-		&config->l2_forwarding_params[entry_index].max_dynp,
-		config->l2_forwarding_params[entry_index].part_spc,
-	};
-	int entry_field_counts[] = {1, 8,};
-	uint64_t tmp;
-	int rc;
+	uint64_t *bounds[] = {&range->first, &range->last, &range->stride};
+	char buf[64];
+	char *p, *next;
+	unsigned int i;
+	int rc = 0;
 
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->l2_forwarding_params_count = tmp;
+	/* Skip the opening bracket */
+	snprintf(buf, sizeof(buf), "%s", str + 1);
+	p = strchr(buf, ']');
+	if (p == NULL) {
+		loge("Entry index must be enclosed in square brackets");
+		rc = -EINVAL;
 		goto out;
 	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
+	*p = '\0';
+	p = trimwhitespace(buf);
+	memset(range, 0, sizeof(*range));
+	range->stride = 1;
+	if (strcmp(p, "all") == 0) {
+		range->all = 1;
 		goto out;
 	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->l2_forwarding_params_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int general_params_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"vllupformat",
-		"mirr_ptacu",
-		"switchid",
-		"hostprio",
-		"mac_fltres1",
-		"mac_fltres0",
-		"mac_flt1",
-		"mac_flt0",
-		"incl_srcpt1",
-		"incl_srcpt0",
-		"send_meta1",
-		"send_meta0",
-		"casc_port",
-		"mirr_port",
-		"vlmarker",
-		"vlmask",
-		"tpid",
-		"ignore2stf",
-		"tpid2",
-		"queue_ts", /* P/Q/R/S only */
-		"egrmirrvid", /* P/Q/R/S only */
-		"egrmirrpcp", /* P/Q/R/S only */
-		"egrmirrdei", /* P/Q/R/S only */
-		"replay_port", /* P/Q/R/S only */
-	};
-	uint64_t *fields[] = {
-		&config->general_params[entry_index].vllupformat,
-		&config->general_params[entry_index].mirr_ptacu,
-		&config->general_params[entry_index].switchid,
-		&config->general_params[entry_index].hostprio,
-		&config->general_params[entry_index].mac_fltres1,
-		&config->general_params[entry_index].mac_fltres0,
-		&config->general_params[entry_index].mac_flt1,
-		&config->general_params[entry_index].mac_flt0,
-		&config->general_params[entry_index].incl_srcpt1,
-		&config->general_params[entry_index].incl_srcpt0,
-		&config->general_params[entry_index].send_meta1,
-		&config->general_params[entry_index].send_meta0,
-		&config->general_params[entry_index].casc_port,
-		&config->general_params[entry_index].mirr_port,
-		&config->general_params[entry_index].vlmarker,
-		&config->general_params[entry_index].vlmask,
-		&config->general_params[entry_index].tpid,
-		&config->general_params[entry_index].ignore2stf,
-		&config->general_params[entry_index].tpid2,
-		&config->general_params[entry_index].queue_ts,
-		&config->general_params[entry_index].egrmirrvid,
-		&config->general_params[entry_index].egrmirrpcp,
-		&config->general_params[entry_index].egrmirrdei,
-		&config->general_params[entry_index].replay_port,
-	};
-	int entry_field_counts[] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->general_params_count = tmp;
-		goto out;
+	/* Split at colons ourselves: the number parser would take
+	 * "0:4095" for a MAC address */
+	for (i = 0; i < ARRAY_SIZE(bounds) && p != NULL; i++) {
+		next = strchr(p, ':');
+		if (next != NULL) {
+			*next++ = '\0';
+		}
+		rc = reliable_uint64_from_string(bounds[i], p, NULL);
+		if (rc < 0) {
+			goto out;
+		}
+		p = next;
 	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
+	if (p != NULL) {
+		loge("Entry range must be first:last[:stride]");
+		rc = -EINVAL;
 		goto out;
 	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->general_params_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int vl_lookup_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"port",
-		"destports",
-		"iscritical",
-		"macaddr",
-		"vlanid",
-		"vlanprior",
-		"egrmirr",
-		"ingrmirr",
-		"vlid",
-	};
-	uint64_t *fields[] = {
-		&config->vl_lookup[entry_index].port,
-		&config->vl_lookup[entry_index].destports,
-		&config->vl_lookup[entry_index].iscritical,
-		&config->vl_lookup[entry_index].macaddr,
-		&config->vl_lookup[entry_index].vlanid,
-		&config->vl_lookup[entry_index].vlanprior,
-		&config->vl_lookup[entry_index].egrmirr,
-		&config->vl_lookup[entry_index].ingrmirr,
-		&config->vl_lookup[entry_index].vlid,
-	};
-	int entry_field_counts[] = {1, 1, 1, 1, 1, 1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->vl_lookup_count = tmp;
-		goto out;
+	if (i == 1) {
+		range->last = range->first;
 	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
+	if (range->first > range->last || range->stride == 0) {
+		loge("Invalid entry range %" PRIu64 ":%" PRIu64 ":%" PRIu64,
+		     range->first, range->last, range->stride);
+		rc = -EINVAL;
 		goto out;
 	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->vl_lookup_count,
-			entry_field_counts[rc],
-			field_val);
+	/* Only the entries actually stepped on need to exist */
+	range->last -= (range->last - range->first) % range->stride;
 out:
 	return rc;
 }
 
-static int vl_policing_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
+static int
+table_entries_field_modify(const struct sja1105_table *table,
+                           const struct sja1105_field *field,
+                           struct sja1105_static_config *config,
+                           struct entry_range *range,
+                           char *field_val)
 {
-	const char *options[] = {
-		"type",
-		"maxlen",
-		"sharindx",
-		"bag",
-		"jitter",
-	};
-	uint64_t *fields[] = {
-		&config->vl_policing[entry_index].type,
-		&config->vl_policing[entry_index].maxlen,
-		&config->vl_policing[entry_index].sharindx,
-		&config->vl_policing[entry_index].bag,
-		&config->vl_policing[entry_index].jitter,
-	};
-	int entry_field_counts[] = {1, 1, 1, 1, 1,};
-	uint64_t tmp;
+	uint64_t values[SJA1105_MAX_FIELD_ARRAY];
+	uint64_t i;
+	int count;
 	int rc;
 
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->vl_policing_count = tmp;
-		goto out;
-	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
-	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->vl_policing_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int vl_fw_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"type",
-		"priority",
-		"partition",
-		"destports",
-	};
-	uint64_t *fields[] = {
-		&config->vl_forwarding[entry_index].type,
-		&config->vl_forwarding[entry_index].priority,
-		&config->vl_forwarding[entry_index].partition,
-		&config->vl_forwarding[entry_index].destports,
-	};
-	int entry_field_counts[] = {1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->vl_forwarding_count = tmp;
-		goto out;
+	/* Parse and validate the value once, up front, so that an
+	 * out-of-range value leaves all entries untouched */
+	memset(values, 0, sizeof(values));
+	if (field->count == 1) {
+		/* Entry is single element */
+		rc = reliable_uint64_from_string(values, field_val, NULL);
+		count = 1;
+	} else {
+		/* Entry is an array. Elements past the ones given
+		 * keep their old value. */
+		rc = read_array(field_val, values, field->count);
+		count = rc;
 	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
 	if (rc < 0) {
 		goto out;
 	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->vl_forwarding_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int retagging_table_entry_modify(
-		__attribute__((unused)) struct sja1105_static_config *config,
-		__attribute__((unused)) int entry,
-		__attribute__((unused)) char *field_name,
-		__attribute__((unused)) char *field_val)
-{
-	loge("unimplemented");
-	return -1;
-}
-
-static int avb_params_table_entry_modify(
-		struct sja1105_static_config *config,
-		int    entry_index,
-		char  *field_name,
-		char  *field_val)
-{
-	const char *options[] = {
-		"l2cbs", /* P/Q/R/S only */
-		"cas_master", /* P/Q/R/S only */
-		"destmeta",
-		"srcmeta",
-	};
-	uint64_t *fields[] = {
-		&config->avb_params[entry_index].l2cbs,
-		&config->avb_params[entry_index].cas_master,
-		&config->avb_params[entry_index].destmeta,
-		&config->avb_params[entry_index].srcmeta,
-	};
-	int entry_field_counts[] = {1, 1, 1, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->avb_params_count = tmp;
-		goto out;
-	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
+	rc = sja1105_field_check(field, config->device_id, values);
 	if (rc < 0) {
 		goto out;
 	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->avb_params_count,
-			entry_field_counts[rc],
-			field_val);
-out:
-	return rc;
-}
-
-static int clock_sync_params_table_entry_modify(
-		__attribute__((unused)) struct sja1105_static_config *config,
-		__attribute__((unused)) int entry,
-		__attribute__((unused)) char *field_name,
-		__attribute__((unused)) char *field_val)
-{
-	loge("unimplemented");
-	return -1;
-}
-
-static int
-vl_fw_params_table_entry_modify(struct sja1105_static_config *config,
-                                int    entry_index,
-                                char  *field_name,
-                                char  *field_val)
-{
-	const char *options[] = {
-		"partspc",
-		"debugen",
-	};
-	uint64_t *fields[] = {
-		config->vl_forwarding_params[entry_index].partspc,
-		&config->vl_forwarding_params[entry_index].debugen,
-	};
-	int entry_field_counts[] = {8, 1,};
-	uint64_t tmp;
-	int rc;
-
-	if (matches(field_name, "entry-count") == 0) {
-		rc = reliable_uint64_from_string(&tmp, field_val, NULL);
-		config->vl_forwarding_params_count = tmp;
-		goto out;
-	}
-	rc = get_match(field_name, options, ARRAY_SIZE(options));
-	if (rc < 0) {
-		goto out;
+	for (i = range->first; i <= range->last; i += range->stride) {
+		memcpy(sja1105_field_get(field, sja1105_table_entry_get(
+		       table, config, i)), values, count * sizeof(uint64_t));
 	}
-	rc = generic_table_entry_modify(
-			fields[rc],
-			entry_index,
-			config->vl_forwarding_params_count,
-			entry_field_counts[rc],
-			field_val);
+	logv("Modified %" PRIu64 " entries",
+	     (range->last - range->first) / range->stride + 1);
+	rc = 0;
 out:
 	return rc;
 }
@@ -929,76 +189,34 @@ staging_area_modify(struct sja1105_staging_area *staging_area,
                     char *field_name,
                     char *field_val)
 {
-	const char *static_config_options[] = {
-		"schedule-table",
-		"schedule-entry-points-table",
-		"vl-lookup-table",
-		"vl-policing-table",
-		"vl-forwarding-table",
-		"l2-address-lookup-table",
-		"l2-policing-table",
-		"vlan-lookup-table",
-		"l2-forwarding-table",
-		"mac-configuration-table",
-		"schedule-parameters-table",
-		"schedule-entry-points-parameters-table",
-		"vl-forwarding-parameters-table",
-		"l2-address-lookup-parameters-table",
-		"l2-forwarding-parameters-table",
-		"clock-synchronization-parameters-table",
-		"avb-parameters-table",
-		"general-parameters-table",
-		"retagging-table",
-	};
-	int (*next_static_table_modify[])(struct sja1105_static_config*, \
-	                                  int, char*, char*) = {
-		schedule_table_entry_modify,
-		schedule_entry_points_table_entry_modify,
-		vl_lookup_table_entry_modify,
-		vl_policing_table_entry_modify,
-		vl_fw_table_entry_modify,
-		l2_lookup_table_entry_modify,
-		l2_policing_table_entry_modify,
-		vlan_lookup_table_entry_modify,
-		l2_fw_table_entry_modify,
-		mac_config_table_entry_modify,
-		schedule_params_table_entry_modify,
-		schedule_entry_points_params_table_entry_modify,
-		vl_fw_params_table_entry_modify,
-		l2_lookup_params_table_entry_modify,
-		l2_fw_params_table_entry_modify,
-		clock_sync_params_table_entry_modify,
-		avb_params_table_entry_modify,
-		general_params_table_entry_modify,
-		retagging_table_entry_modify,
-	};
+	const struct sja1105_table *table;
+	const struct sja1105_field *field;
 	struct   sja1105_static_config *static_config;
-	uint64_t entry_index;
+	struct   entry_range range;
 	char    *index_ptr;
+	int      entry_count;
 	int      rc;
 
-	static_config = &staging_area->static_config;
-
 	index_ptr = strchr(table_name, '[');
 	if (index_ptr == NULL) {
-		entry_index = 0;
+		memset(&range, 0, sizeof(range));
+		range.stride = 1;
 	} else {
-		/* Little trick to reuse the code, since the index
-		 * is surrounded by [ ], same as an array would be */
-		rc = read_array(index_ptr, &entry_index, 1);
+		rc = entry_range_parse(index_ptr, &range);
 		if (rc < 0) {
 			goto out;
 		}
 		/* So we only match on the table field_name, but not on the entry index */
 		*index_ptr = '\0';
 	}
-	rc = get_match(table_name, static_config_options,
-	               ARRAY_SIZE(static_config_options));
-	if (rc < 0) {
+	table = sja1105_table_lookup(table_name);
+	if (table == NULL) {
+		rc = -EINVAL;
 		goto out;
 	}
-	logv("Table %s, entry %" PRIu64", field %s, value %s",
-	     static_config_options[rc], entry_index, field_name, field_val);
+	logv("Table %s, entries %" PRIu64 ":%" PRIu64 ":%" PRIu64
+	     "%s, field %s, value %s", table->name, range.first, range.last,
+	     range.stride, range.all ? " (all)" : "", field_name, field_val);
 	if (field_name == NULL) {
 		rc = -EINVAL;
 		print_usage("sja1105-tool");
@@ -1006,15 +224,52 @@ staging_area_modify(struct sja1105_staging_area *staging_area,
 	}
 	if (field_val == NULL) {
 		printf("Please supply a value for field %s!\n", field_name);
+		rc = -EINVAL;
 		goto out;
 	}
-	rc = next_static_table_modify[rc](static_config, entry_index,
-	                                  field_name, field_val);
-	if (rc < 0) {
-		loge("modify failed!");
+	if (table->fields == NULL) {
+		loge("unimplemented");
+		rc = -EINVAL;
+		goto out;
+	}
+	if (staging_area != NULL && matches(field_name, "entry-count") == 0) {
+		static_config = &staging_area->static_config;
+		rc = table_entry_count_modify(table, static_config, field_val);
+		goto out;
+	}
+	field = sja1105_field_lookup(table, field_name);
+	if (field == NULL) {
+		rc = -EINVAL;
+		goto out;
+	}
+	if (staging_area == NULL) {
+		/* Only asked to validate the names */
+		rc = 0;
 		goto out;
 	}
+	static_config = &staging_area->static_config;
+	entry_count = *sja1105_table_count_get(table, static_config);
+	if (range.all) {
+		if (entry_count == 0) {
+			loge("%s is empty", table->description);
+			rc = -ERANGE;
+			goto out;
+		}
+		range.last = entry_count - 1;
+	}
+	if (range.last >= (uint64_t) entry_count) {
+		loge("Index out of bounds!");
+		loge("Please adjust the entry count of the table:");
+		loge("* config modify <table> entry-count <value>)");
+		rc = -ERANGE;
+		goto out;
+	}
+	rc = table_entries_field_modify(table, field, static_config,
+	                                &range, field_val);
 out:
+	if (rc < 0 && staging_area != NULL) {
+		loge("modify failed!");
+	}
 	return rc;
 }
 
@@ -1024,6 +279,7 @@ int staging_area_modify_parse(struct sja1105_staging_area *staging_area,
 	char *table_name;
 	char *field_name;
 	char *field_val;
+	int prof;
 	int rc = 0;
 
 	if ((*argc) == 0) {
@@ -1048,8 +304,10 @@ int staging_area_modify_parse(struct sja1105_staging_area *staging_area,
 	field_val  = (*argv)[1];
 	(*argc) -= 2; (*argv) += 2;
 
+	prof = sja1105_profile_begin("modify", NULL);
 	rc = staging_area_modify(staging_area, table_name,
 	                         field_name, field_val);
+	sja1105_profile_end(prof);
 out:
 	return rc;
 }
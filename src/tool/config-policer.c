@@ -0,0 +1,282 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include "internal.h"
+/* From libsja1105 */
+#include <common.h>
+
+/* The L2 Policing Table has one policer per port and priority, at index
+ * port * 8 + prio, followed by one broadcast policer per port.
+ */
+#define POLICER_PORTS        5
+#define POLICER_PRIOS        8
+#define POLICER_BCAST_BASE   (POLICER_PORTS * POLICER_PRIOS)
+
+static void print_usage()
+{
+	printf("Usage: sja1105-tool config policer set [-f|--flush] [--force] \\\n"
+	       "           --port <ports> --prio <prios>|bcast [--rate-mbps <Mbps>] \\\n"
+	       "           [--burst <bytes>] [--mtu <bytes>] [--sharindx <index>] \\\n"
+	       "           [--partition <0-7>]\n");
+	printf("<ports> and <prios> are lists such as 0,2-4, or all\n");
+}
+
+/* Mbps given as a decimal number (e.g. 12.5) to RATE units */
+static int rate_mbps_parse(const char *str, uint64_t *rate)
+{
+	int rounded;
+	int rc;
+
+	rc = reliable_fixed_from_string(rate, str,
+	                                SJA1105_POLICER_RATE_PER_MBPS,
+	                                &rounded);
+	if (rc < 0) {
+		return rc;
+	}
+	if (rounded) {
+		logi("Rate %s Mbps rounded to %" PRIu64 "/%d Mbps",
+		     str, *rate, SJA1105_POLICER_RATE_PER_MBPS);
+	}
+	if (*rate == 0 && rounded) {
+		loge("Rate %s Mbps is below the resolution of 1/%d Mbps",
+		     str, SJA1105_POLICER_RATE_PER_MBPS);
+		return -ERANGE;
+	}
+	return 0;
+}
+
+struct policer_set {
+	uint8_t  ports[POLICER_PORTS];
+	uint8_t  prios[POLICER_PRIOS];
+	int      port_count;
+	int      prio_count;
+	int      bcast;
+	/* Which of the values below were given */
+	int      has_rate, has_smax, has_maxlen, has_sharindx, has_partition;
+	uint64_t rate, smax, maxlen, sharindx, partition;
+};
+
+static int
+policer_set_parse(struct policer_set *set, int argc, char **argv)
+{
+	const char *opt;
+	uint64_t *value;
+	int *has;
+	int rc;
+
+	memset(set, 0, sizeof(*set));
+	for (; argc; argc -= 2, argv += 2) {
+		opt = argv[0];
+		if (argc < 2) {
+			loge("Missing value for %s", opt);
+			return -EINVAL;
+		}
+		if (strcmp(opt, "--port") == 0) {
+			rc = read_index_list(argv[1], set->ports,
+			                     POLICER_PORTS);
+			if (rc < 0) {
+				return rc;
+			}
+			set->port_count = rc;
+			continue;
+		} else if (strcmp(opt, "--prio") == 0) {
+			if (strcmp(argv[1], "bcast") == 0) {
+				set->bcast = 1;
+				continue;
+			}
+			rc = read_index_list(argv[1], set->prios,
+			                     POLICER_PRIOS);
+			if (rc < 0) {
+				return rc;
+			}
+			set->prio_count = rc;
+			continue;
+		} else if (strcmp(opt, "--rate-mbps") == 0) {
+			rc = rate_mbps_parse(argv[1], &set->rate);
+			if (rc < 0) {
+				return rc;
+			}
+			set->has_rate = 1;
+			continue;
+		} else if (strcmp(opt, "--burst") == 0) {
+			value = &set->smax;
+			has   = &set->has_smax;
+		} else if (strcmp(opt, "--mtu") == 0) {
+			value = &set->maxlen;
+			has   = &set->has_maxlen;
+		} else if (strcmp(opt, "--sharindx") == 0) {
+			value = &set->sharindx;
+			has   = &set->has_sharindx;
+		} else if (strcmp(opt, "--partition") == 0) {
+			value = &set->partition;
+			has   = &set->has_partition;
+		} else {
+			loge("Unknown option %s", opt);
+			return -EINVAL;
+		}
+		rc = reliable_uint64_from_string(value, argv[1], NULL);
+		if (rc < 0) {
+			return rc;
+		}
+		*has = 1;
+	}
+	if (set->port_count == 0 || (set->prio_count == 0 && !set->bcast)) {
+		loge("Both --port and --prio are required");
+		return -EINVAL;
+	}
+	if (!(set->has_rate || set->has_smax || set->has_maxlen ||
+	      set->has_sharindx || set->has_partition)) {
+		loge("Nothing to set");
+		return -EINVAL;
+	}
+	return 0;
+}
+
+static int
+policer_set_apply(struct sja1105_static_config *config,
+                  struct policer_set *set, int index)
+{
+	struct sja1105_l2_policing_entry *entry;
+
+	if (index >= config->l2_policing_count) {
+		loge("Policer %d does not exist, l2-policing-table has %d "
+		     "entries", index, config->l2_policing_count);
+		return -ERANGE;
+	}
+	entry = &config->l2_policing[index];
+	if (set->has_rate) {
+		entry->rate = set->rate;
+	}
+	if (set->has_smax) {
+		entry->smax = set->smax;
+	}
+	if (set->has_maxlen) {
+		entry->maxlen = set->maxlen;
+	}
+	if (set->has_sharindx) {
+		entry->sharindx = set->sharindx;
+	}
+	if (set->has_partition) {
+		entry->partition = set->partition;
+	}
+	logv("l2-policing-table[%d]: rate %" PRIu64 " smax %" PRIu64
+	     " maxlen %" PRIu64 " sharindx %" PRIu64 " partition %" PRIu64,
+	     index, entry->rate, entry->smax, entry->maxlen,
+	     entry->sharindx, entry->partition);
+	return 0;
+}
+
+/* Consistency of the whole table, not only of the policers we touched */
+int sja1105_l2_policing_check(struct sja1105_static_config *config)
+{
+	struct sja1105_l2_policing_entry *entry;
+	uint64_t *part_spc = NULL;
+	int i;
+
+	if (config->l2_forwarding_params_count) {
+		part_spc = config->l2_forwarding_params[0].part_spc;
+	}
+	for (i = 0; i < config->l2_policing_count; i++) {
+		entry = &config->l2_policing[i];
+		if (entry->sharindx >= (uint64_t) config->l2_policing_count) {
+			loge("l2-policing-table[%d]: sharindx %" PRIu64
+			     " points past the end of the table", i,
+			     entry->sharindx);
+			return -ERANGE;
+		}
+		if (entry->partition >= 8) {
+			loge("l2-policing-table[%d]: partition %" PRIu64
+			     " does not exist", i, entry->partition);
+			return -ERANGE;
+		}
+		if (part_spc && part_spc[entry->partition] == 0) {
+			loge("l2-policing-table[%d]: partition %" PRIu64
+			     " has no space in l2-forwarding-parameters-table",
+			     i, entry->partition);
+			return -EINVAL;
+		}
+	}
+	/* And the hardware field widths */
+	return sja1105_static_config_check(config);
+}
+
+/* config policer set: all the selected policers are modified in memory
+ * and checked together, so that the staging area is either saved once
+ * with all of them, or not touched at all.
+ */
+int staging_area_policer_set(struct sja1105_staging_area *staging_area,
+                             int argc, char **argv)
+{
+	struct sja1105_static_config *config = &staging_area->static_config;
+	struct policer_set set;
+	int port, prio;
+	int count = 0;
+	int rc;
+
+	rc = policer_set_parse(&set, argc, argv);
+	if (rc < 0) {
+		print_usage();
+		return rc;
+	}
+	for (port = 0; port < POLICER_PORTS; port++) {
+		if (!set.ports[port]) {
+			continue;
+		}
+		for (prio = 0; prio < POLICER_PRIOS; prio++) {
+			if (!set.prios[prio]) {
+				continue;
+			}
+			rc = policer_set_apply(config, &set,
+			                       port * POLICER_PRIOS + prio);
+			if (rc < 0) {
+				return rc;
+			}
+			count++;
+		}
+		if (set.bcast) {
+			rc = policer_set_apply(config, &set,
+			                       POLICER_BCAST_BASE + port);
+			if (rc < 0) {
+				return rc;
+			}
+			count++;
+		}
+	}
+	rc = sja1105_l2_policing_check(config);
+	if (rc < 0) {
+		return rc;
+	}
+	logi("Modified %d policers", count);
+	return 0;
+}
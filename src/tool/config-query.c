@@ -0,0 +1,555 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "internal.h"
+/* From libsja1105 */
+#include <common.h>
+
+/* Predicates for "config show <table> where <expr>".
+ *
+ * The expression is compiled into a short postfix program over the
+ * fields of one table, which is then run over the table a block of
+ * entries at a time: every instruction processes a whole column of
+ * values before the next one starts, so the per-entry cost is a few
+ * array operations and no interpretation overhead.
+ *
+ * Grammar, loosest binding first:
+ *     expr    := and { ("or" | "||") and }
+ *     and     := not { ("and" | "&&") not }
+ *     not     := ("not" | "!") not | cmp
+ *     cmp     := bitor [ ("==" | "!=" | "<" | "<=" | ">" | ">=") bitor ]
+ *     bitor   := bitxor { "|" bitxor }
+ *     bitxor  := bitand { "^" bitand }
+ *     bitand  := shift { "&" shift }
+ *     shift   := unary { ("<<" | ">>") unary }
+ *     unary   := "~" unary | primary
+ *     primary := number | field [ "[" number "]" ] | "entry" | "(" expr ")"
+ * Field names are those of "config modify", "entry" is the position of
+ * the entry in the table. Numbers are anything "config modify" accepts
+ * as a value, MAC addresses included.
+ */
+
+enum query_op {
+	OP_CONST,
+	OP_FIELD,
+	OP_ENTRY,
+	OP_LNOT,
+	OP_BNOT,
+	OP_LOR,
+	OP_LAND,
+	OP_EQ,
+	OP_NE,
+	OP_LT,
+	OP_LE,
+	OP_GT,
+	OP_GE,
+	OP_BOR,
+	OP_BXOR,
+	OP_BAND,
+	OP_SHL,
+	OP_SHR,
+};
+
+#define QUERY_MAX_INSNS  64
+#define QUERY_MAX_DEPTH  16
+#define QUERY_BLOCK_SIZE 256
+#define QUERY_MAX_TOKEN  64
+
+struct query_insn {
+	enum query_op op;
+	/* OP_CONST: the value. OP_FIELD: offset inside the entry. */
+	uint64_t      arg;
+};
+
+struct sja1105_query {
+	const struct sja1105_table *table;
+	struct query_insn insns[QUERY_MAX_INSNS];
+	int insn_count;
+	int depth;
+	int max_depth;
+};
+
+struct query_parser {
+	struct sja1105_query *query;
+	const char *p;
+	char token[QUERY_MAX_TOKEN];
+};
+
+/* Tokens are operators, parentheses, brackets, and words: runs of
+ * letters, digits, '_' and ':' (the latter for MAC addresses). */
+static int next_token(struct query_parser *parser)
+{
+	static const char *ops[] = {
+		"==", "!=", "<=", ">=", "<<", ">>", "&&", "||",
+		"<", ">", "!", "~", "&", "|", "^", "(", ")", "[", "]",
+	};
+	const char *p = parser->p;
+	unsigned int i;
+	size_t len;
+
+	while (isspace((unsigned char) *p)) {
+		p++;
+	}
+	parser->token[0] = '\0';
+	if (*p == '\0') {
+		parser->p = p;
+		return 0;
+	}
+	for (i = 0; i < ARRAY_SIZE(ops); i++) {
+		len = strlen(ops[i]);
+		if (strncmp(p, ops[i], len) == 0) {
+			memcpy(parser->token, p, len);
+			parser->token[len] = '\0';
+			parser->p = p + len;
+			return 0;
+		}
+	}
+	for (len = 0; isalnum((unsigned char) p[len]) || p[len] == '_' ||
+	     p[len] == ':'; len++)
+		;
+	if (len == 0) {
+		loge("Unexpected character '%c' in expression", *p);
+		return -EINVAL;
+	}
+	if (len >= QUERY_MAX_TOKEN) {
+		loge("Token too long in expression");
+		return -EINVAL;
+	}
+	memcpy(parser->token, p, len);
+	parser->token[len] = '\0';
+	parser->p = p + len;
+	return 0;
+}
+
+static int emit(struct query_parser *parser, enum query_op op, uint64_t arg)
+{
+	struct sja1105_query *query = parser->query;
+
+	if (query->insn_count == QUERY_MAX_INSNS) {
+		loge("Expression too long");
+		return -E2BIG;
+	}
+	query->insns[query->insn_count].op  = op;
+	query->insns[query->insn_count].arg = arg;
+	query->insn_count++;
+	switch (op) {
+	case OP_CONST:
+	case OP_FIELD:
+	case OP_ENTRY:
+		if (++query->depth > QUERY_MAX_DEPTH) {
+			loge("Expression too deeply nested");
+			return -E2BIG;
+		}
+		if (query->max_depth < query->depth) {
+			query->max_depth = query->depth;
+		}
+		break;
+	case OP_LNOT:
+	case OP_BNOT:
+		break;
+	default:
+		query->depth--;
+		break;
+	}
+	return 0;
+}
+
+static int parse_expr(struct query_parser *parser);
+
+static int expect(struct query_parser *parser, const char *token)
+{
+	if (strcmp(parser->token, token) != 0) {
+		loge("Expected \"%s\" in expression, got \"%s\"", token,
+		     parser->token[0] ? parser->token : "end of input");
+		return -EINVAL;
+	}
+	return next_token(parser);
+}
+
+static int parse_primary(struct query_parser *parser)
+{
+	const struct sja1105_table *table = parser->query->table;
+	const struct sja1105_field *field;
+	uint64_t value;
+	uint64_t index = 0;
+	int rc;
+
+	if (strcmp(parser->token, "(") == 0) {
+		rc = next_token(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		rc = parse_expr(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		return expect(parser, ")");
+	}
+	if (isdigit((unsigned char) parser->token[0]) ||
+	    strchr(parser->token, ':') != NULL) {
+		rc = reliable_uint64_from_string(&value, parser->token, NULL);
+		if (rc < 0) {
+			return rc;
+		}
+		rc = emit(parser, OP_CONST, value);
+		if (rc < 0) {
+			return rc;
+		}
+		return next_token(parser);
+	}
+	if (strcmp(parser->token, "entry") == 0) {
+		rc = emit(parser, OP_ENTRY, 0);
+		if (rc < 0) {
+			return rc;
+		}
+		return next_token(parser);
+	}
+	if (!isalpha((unsigned char) parser->token[0])) {
+		loge("Expected a field name or a number, got \"%s\"",
+		     parser->token[0] ? parser->token : "end of input");
+		return -EINVAL;
+	}
+	field = sja1105_field_lookup(table, parser->token);
+	if (field == NULL) {
+		return -EINVAL;
+	}
+	rc = next_token(parser);
+	if (rc < 0) {
+		return rc;
+	}
+	if (strcmp(parser->token, "[") == 0) {
+		rc = next_token(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		rc = reliable_uint64_from_string(&index, parser->token, NULL);
+		if (rc < 0) {
+			return rc;
+		}
+		rc = next_token(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		rc = expect(parser, "]");
+		if (rc < 0) {
+			return rc;
+		}
+	} else if (field->count > 1) {
+		loge("%s is an array, please pick an element: %s[0..%d]",
+		     field->name, field->name, field->count - 1);
+		return -EINVAL;
+	}
+	if (index >= (uint64_t) field->count) {
+		loge("%s has only %d elements", field->name, field->count);
+		return -ERANGE;
+	}
+	return emit(parser, OP_FIELD,
+	            field->offset + index * sizeof(uint64_t));
+}
+
+static int parse_unary(struct query_parser *parser)
+{
+	int rc;
+
+	if (strcmp(parser->token, "~") == 0) {
+		rc = next_token(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		rc = parse_unary(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		return emit(parser, OP_BNOT, 0);
+	}
+	return parse_primary(parser);
+}
+
+/* One precedence level of binary operators */
+struct binary_level {
+	int (*operand)(struct query_parser*);
+	const char   *tokens[6];
+	enum query_op ops[6];
+	/* Non-associative: no "a < b < c" */
+	int           once;
+};
+
+static int parse_binary(struct query_parser *parser,
+                        const struct binary_level *level)
+{
+	unsigned int i;
+	int rc;
+
+	rc = level->operand(parser);
+	if (rc < 0) {
+		return rc;
+	}
+	while (1) {
+		for (i = 0; i < ARRAY_SIZE(level->tokens); i++) {
+			if (level->tokens[i] != NULL &&
+			    strcmp(parser->token, level->tokens[i]) == 0) {
+				break;
+			}
+		}
+		if (i == ARRAY_SIZE(level->tokens)) {
+			return 0;
+		}
+		rc = next_token(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		rc = level->operand(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		rc = emit(parser, level->ops[i], 0);
+		if (rc < 0 || level->once) {
+			return rc;
+		}
+	}
+}
+
+#define DEFINE_BINARY_LEVEL(name, operand, once, tokens, ops)                 \
+	static int name(struct query_parser *parser)                          \
+	{                                                                     \
+		static const struct binary_level level = {                    \
+			operand, tokens, ops, once                            \
+		};                                                            \
+		return parse_binary(parser, &level);                          \
+	}
+#define LIST(...) { __VA_ARGS__ }
+
+DEFINE_BINARY_LEVEL(parse_shift, parse_unary, 0,
+                    LIST("<<", ">>"), LIST(OP_SHL, OP_SHR))
+DEFINE_BINARY_LEVEL(parse_bitand, parse_shift, 0, LIST("&"), LIST(OP_BAND))
+DEFINE_BINARY_LEVEL(parse_bitxor, parse_bitand, 0, LIST("^"), LIST(OP_BXOR))
+DEFINE_BINARY_LEVEL(parse_bitor, parse_bitxor, 0, LIST("|"), LIST(OP_BOR))
+DEFINE_BINARY_LEVEL(parse_cmp, parse_bitor, 1,
+                    LIST("==", "!=", "<", "<=", ">", ">="),
+                    LIST(OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE))
+
+static int parse_not(struct query_parser *parser)
+{
+	int rc;
+
+	if (strcmp(parser->token, "!") == 0 ||
+	    strcmp(parser->token, "not") == 0) {
+		rc = next_token(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		rc = parse_not(parser);
+		if (rc < 0) {
+			return rc;
+		}
+		return emit(parser, OP_LNOT, 0);
+	}
+	return parse_cmp(parser);
+}
+
+DEFINE_BINARY_LEVEL(parse_and, parse_not, 0,
+                    LIST("&&", "and"), LIST(OP_LAND, OP_LAND))
+DEFINE_BINARY_LEVEL(parse_or, parse_and, 0,
+                    LIST("||", "or"), LIST(OP_LOR, OP_LOR))
+
+static int parse_expr(struct query_parser *parser)
+{
+	return parse_or(parser);
+}
+
+struct sja1105_query *
+sja1105_query_compile(const struct sja1105_table *table, const char *expr)
+{
+	struct sja1105_query *query;
+	struct query_parser parser;
+	int rc;
+
+	if (table->fields == NULL) {
+		loge("%s unimplemented", table->description);
+		return NULL;
+	}
+	query = calloc(1, sizeof(*query));
+	if (query == NULL) {
+		loge("malloc failed");
+		return NULL;
+	}
+	query->table = table;
+	parser.query = query;
+	parser.p = expr;
+	rc = next_token(&parser);
+	if (rc < 0) {
+		goto error;
+	}
+	rc = parse_expr(&parser);
+	if (rc < 0) {
+		goto error;
+	}
+	if (parser.token[0] != '\0') {
+		loge("Unexpected \"%s\" at end of expression", parser.token);
+		goto error;
+	}
+	logv("compiled \"%s\" into %d instructions, stack depth %d",
+	     expr, query->insn_count, query->max_depth);
+	return query;
+error:
+	free(query);
+	return NULL;
+}
+
+void sja1105_query_free(struct sja1105_query *query)
+{
+	free(query);
+}
+
+/* Run the program over entries [start, start + n) of the table,
+ * column by column */
+static void query_run_block(struct sja1105_query *query,
+                            struct sja1105_static_config *config,
+                            int start, int n, uint8_t *match)
+{
+	uint64_t stack[QUERY_MAX_DEPTH][QUERY_BLOCK_SIZE];
+	const struct sja1105_table *table = query->table;
+	const struct query_insn *insn;
+	const char *entries;
+	uint64_t *a, *b;
+	int sp = 0;
+	int i, k;
+
+	entries = sja1105_table_entry_get(table, config, start);
+	for (k = 0; k < query->insn_count; k++) {
+		insn = &query->insns[k];
+		/* Operands, as far as the compiler put any on the stack */
+		a = (sp > 1) ? stack[sp - 2] : NULL;
+		b = (sp > 0) ? stack[sp - 1] : NULL;
+		switch (insn->op) {
+		case OP_CONST:
+			for (i = 0; i < n; i++) {
+				stack[sp][i] = insn->arg;
+			}
+			sp++;
+			continue;
+		case OP_FIELD:
+			for (i = 0; i < n; i++) {
+				stack[sp][i] = *(const uint64_t*) (entries +
+				               i * table->entry_size + insn->arg);
+			}
+			sp++;
+			continue;
+		case OP_ENTRY:
+			for (i = 0; i < n; i++) {
+				stack[sp][i] = start + i;
+			}
+			sp++;
+			continue;
+		case OP_LNOT:
+			for (i = 0; i < n; i++) b[i] = !b[i];
+			continue;
+		case OP_BNOT:
+			for (i = 0; i < n; i++) b[i] = ~b[i];
+			continue;
+		case OP_LOR:
+			for (i = 0; i < n; i++) a[i] = a[i] || b[i];
+			break;
+		case OP_LAND:
+			for (i = 0; i < n; i++) a[i] = a[i] && b[i];
+			break;
+		case OP_EQ:
+			for (i = 0; i < n; i++) a[i] = a[i] == b[i];
+			break;
+		case OP_NE:
+			for (i = 0; i < n; i++) a[i] = a[i] != b[i];
+			break;
+		case OP_LT:
+			for (i = 0; i < n; i++) a[i] = a[i] < b[i];
+			break;
+		case OP_LE:
+			for (i = 0; i < n; i++) a[i] = a[i] <= b[i];
+			break;
+		case OP_GT:
+			for (i = 0; i < n; i++) a[i] = a[i] > b[i];
+			break;
+		case OP_GE:
+			for (i = 0; i < n; i++) a[i] = a[i] >= b[i];
+			break;
+		case OP_BOR:
+			for (i = 0; i < n; i++) a[i] |= b[i];
+			break;
+		case OP_BXOR:
+			for (i = 0; i < n; i++) a[i] ^= b[i];
+			break;
+		case OP_BAND:
+			for (i = 0; i < n; i++) a[i] &= b[i];
+			break;
+		case OP_SHL:
+			for (i = 0; i < n; i++)
+				a[i] = (b[i] < 64) ? a[i] << b[i] : 0;
+			break;
+		case OP_SHR:
+			for (i = 0; i < n; i++)
+				a[i] = (b[i] < 64) ? a[i] >> b[i] : 0;
+			break;
+		}
+		/* Binary operators consume two operands, push one */
+		sp--;
+	}
+	for (i = 0; i < n; i++) {
+		match[start + i] = (stack[0][i] != 0);
+	}
+}
+
+/* Sets match[i] for every entry i of the table satisfying the query.
+ * Returns the number of matching entries. */
+int sja1105_query_run(struct sja1105_query *query,
+                      struct sja1105_static_config *config,
+                      uint8_t *match)
+{
+	int count = *sja1105_table_count_get(query->table, config);
+	int matches = 0;
+	int start;
+	int n;
+	int i;
+
+	for (start = 0; start < count; start += QUERY_BLOCK_SIZE) {
+		n = count - start;
+		if (n > QUERY_BLOCK_SIZE) {
+			n = QUERY_BLOCK_SIZE;
+		}
+		query_run_block(query, config, start, n, match);
+	}
+	for (i = 0; i < count; i++) {
+		matches += match[i];
+	}
+	return matches;
+}
@@ -39,152 +39,181 @@
 #include <lib/include/static-config.h>
 #include <common.h>
 
-#define DECLARE_TABLE_SHOW_FN(TABLE_NAME, MAX_TABLE_SIZE,                     \
-                              STRING_NAME, FMT)                               \
-	static int                                                            \
-	TABLE_NAME##_table_show(struct sja1105_static_config *config,         \
-	                        int index)                                    \
-	{                                                                     \
-		const int entry_count = config->TABLE_NAME##_count;           \
-		char *print_bufs[MAX_TABLE_SIZE];                             \
-		int   start = (index == -1) ? 0 : index;                      \
-		int   end   = (index == -1) ? entry_count : index + 1;        \
-		int   i;                                                      \
-		                                                              \
-		if (entry_count == 0) {                                       \
-			loge(STRING_NAME " is empty");                        \
-			return -1;                                            \
-		}                                                             \
-		if (index < -1 || index >= entry_count) {                     \
-			loge("Index out of bounds!");                         \
-			loge("Please adjust the entry count of the table:");  \
-			loge("* config show <table>[%d to %d]", 0,            \
-			     entry_count - 1);                                \
-			return -1;                                            \
-		}                                                             \
-		printf(STRING_NAME ": %d entries\n", entry_count);            \
-		for (i = start; i < end; i++) {                               \
-			print_bufs[i] = calloc(sizeof(char), MAX_LINE_SIZE);  \
-			if (print_bufs[i] == NULL) {                          \
-				loge("malloc failed");                        \
-				while (i-- > start) {                         \
-					free(print_bufs[i]);                  \
-				}                                             \
-				return -1;                                    \
-			}                                                     \
-		}                                                             \
-		for (i = start; i < end; i++) {                               \
-			formatted_append(print_bufs[i], MAX_LINE_SIZE, FMT, "Entry %d:", i); \
-			sja1105_##TABLE_NAME##_entry_fmt_show(                \
-					print_bufs[i],              \
-					(MAX_LINE_SIZE - i),                         \
-					FMT,                                  \
-					&config-> TABLE_NAME [i]);            \
-			formatted_append(print_bufs[i], MAX_LINE_SIZE, FMT, "");             \
-		}                                                             \
-		show_print_bufs(print_bufs + start, end - start);             \
-		for (i = start; i < end; i++) {                               \
-			free(print_bufs[i]);                                  \
-		}                                                             \
-		return 0;                                                     \
-	}
-
-DECLARE_TABLE_SHOW_FN(schedule, MAX_SCHEDULE_COUNT, "Schedule Table", "%-30s\n")
-DECLARE_TABLE_SHOW_FN(schedule_entry_points, MAX_SCHEDULE_ENTRY_POINTS_COUNT, "Schedule Entry Points Table", "%-30s\n")
-DECLARE_TABLE_SHOW_FN(l2_lookup, MAX_L2_LOOKUP_COUNT, "L2 Address Lookup Table", "%-30s\n")
-DECLARE_TABLE_SHOW_FN(l2_policing, MAX_L2_POLICING_COUNT, "L2 Policing Table", "%-20s\n")
-DECLARE_TABLE_SHOW_FN(vlan_lookup, MAX_VLAN_LOOKUP_COUNT, "VLAN Lookup Table", "%-20s\n")
-DECLARE_TABLE_SHOW_FN(l2_forwarding, MAX_L2_FORWARDING_COUNT, "L2 Forwarding Table", "%-45s\n")
-DECLARE_TABLE_SHOW_FN(mac_config, MAX_MAC_CONFIG_COUNT, "MAC Configuration Table", "%-60s\n")
-DECLARE_TABLE_SHOW_FN(schedule_params, MAX_SCHEDULE_PARAMS_COUNT, "Schedule Parameters Table", "%-50s\n")
-DECLARE_TABLE_SHOW_FN(schedule_entry_points_params, MAX_SCHEDULE_ENTRY_POINTS_PARAMS_COUNT, "Schedule Entry Points Parameters Table", "%-30s\n")
-DECLARE_TABLE_SHOW_FN(l2_lookup_params, MAX_L2_LOOKUP_PARAMS_COUNT, "L2 Address Lookup Parameters Table", "%-30s\n")
-DECLARE_TABLE_SHOW_FN(l2_forwarding_params, MAX_L2_FORWARDING_PARAMS_COUNT, "L2 Forwarding Parameters Table", "%-50s\n")
-DECLARE_TABLE_SHOW_FN(general_params, MAX_GENERAL_PARAMS_COUNT, "General Parameters Table", "%-30s\n")
-DECLARE_TABLE_SHOW_FN(vl_lookup, MAX_VL_LOOKUP_COUNT, "Virtual Link Address Lookup Table:", "%-35s\n")
-DECLARE_TABLE_SHOW_FN(vl_policing, MAX_VL_POLICING_COUNT, "Virtual Link Policing Table:", "%-35s\n")
-DECLARE_TABLE_SHOW_FN(vl_forwarding, MAX_VL_FORWARDING_COUNT, "Virtual Link Forwarding Table", "%-35s\n")
-DECLARE_TABLE_SHOW_FN(avb_params, MAX_AVB_PARAMS_COUNT, "Audio/Video Bridging Parameters Table", "%-35s\n")
-DECLARE_TABLE_SHOW_FN(vl_forwarding_params, MAX_VL_FORWARDING_PARAMS_COUNT, "Virtual Link Forwarding Parameters Table", "%-50s\n")
-
-static int
-retagging_table_show(__attribute__((unused)) struct sja1105_static_config *config,
-                     __attribute__((unused)) int index)
+static void
+table_entry_output(struct sja1105_output *out,
+                   const struct sja1105_table *table,
+                   uint64_t device_id, int index, void *entry)
 {
-	logv("Retagging Table unimplemented");
-	return 0;
+	const struct sja1105_field *field;
+	uint64_t *value;
+	int i;
+
+	sja1105_output_record_begin(out);
+	sja1105_output_u64(out, "entry", index);
+	for (i = 0; i < table->field_count; i++) {
+		field = &table->fields[i];
+		if (field->flags & SJA1105_FIELD_INTERNAL ||
+		    sja1105_field_width(field, device_id) == 0) {
+			continue;
+		}
+		if (!sja1105_field_present(table, field, entry)) {
+			sja1105_output_none(out, field->name);
+			continue;
+		}
+		value = sja1105_field_get(field, entry);
+		if (field->count > 1) {
+			sja1105_output_array(out, field->name, value,
+			                     field->count);
+		} else if (field->flags & SJA1105_FIELD_MAC) {
+			sja1105_output_mac(out, field->name, *value);
+		} else {
+			sja1105_output_u64(out, field->name, *value);
+		}
+	}
+	sja1105_output_record_end(out);
 }
 
 static int
-clock_sync_params_table_show(__attribute__((unused)) struct sja1105_static_config *config,
-                             __attribute__((unused)) int index)
+table_show(const struct sja1105_table *table,
+           struct sja1105_static_config *config,
+           int index, struct sja1105_query *query,
+           struct sja1105_output *out)
 {
-	logv("Clock Synchronization Table unimplemented");
-	return 0;
+	const int entry_count = *sja1105_table_count_get(table, config);
+	uint8_t *match = NULL;
+	char   **print_bufs = NULL;
+	int      start = (index == -1) ? 0 : index;
+	int      end   = (index == -1) ? entry_count : index + 1;
+	int      shown = end - start;
+	int      rc = 0;
+	int      i, j;
+
+	if (table->fields == NULL) {
+		logv("%s unimplemented", table->description);
+		return 0;
+	}
+	if (entry_count == 0 && out != NULL) {
+		sja1105_output_section_begin(out, table->name, "table");
+		sja1105_output_section_end(out);
+		return 0;
+	}
+	if (entry_count == 0) {
+		loge("%s is empty", table->show_name);
+		return -1;
+	}
+	if (index < -1 || index >= entry_count) {
+		loge("Index out of bounds!");
+		loge("Please adjust the entry count of the table:");
+		loge("* config show <table>[%d to %d]", 0, entry_count - 1);
+		return -1;
+	}
+	if (query != NULL) {
+		match = calloc(entry_count, sizeof(*match));
+		if (match == NULL) {
+			loge("malloc failed");
+			return -1;
+		}
+		sja1105_query_run(query, config, match);
+		for (shown = 0, i = start; i < end; i++) {
+			shown += match[i];
+		}
+	}
+	if (out != NULL) {
+		/* Stream the entries straight out of the staging area */
+		sja1105_output_section_begin(out, table->name, "table");
+		for (i = start; i < end; i++) {
+			if (match == NULL || match[i]) {
+				table_entry_output(out, table, config->device_id, i,
+				                   sja1105_table_entry_get(table,
+				                   config, i));
+			}
+		}
+		sja1105_output_section_end(out);
+		goto out;
+	}
+	if (match != NULL) {
+		printf("%s: %d entries, %d matching\n", table->show_name,
+		       entry_count, shown);
+	} else {
+		printf("%s: %d entries\n", table->show_name, entry_count);
+	}
+	if (shown == 0) {
+		goto out;
+	}
+	print_bufs = calloc(shown, sizeof(char*));
+	if (print_bufs == NULL) {
+		loge("malloc failed");
+		rc = -1;
+		goto out;
+	}
+	for (i = start, j = 0; i < end; i++) {
+		if (match != NULL && !match[i]) {
+			continue;
+		}
+		print_bufs[j] = calloc(sizeof(char), MAX_LINE_SIZE);
+		if (print_bufs[j] == NULL) {
+			loge("malloc failed");
+			rc = -1;
+			goto out;
+		}
+		formatted_append(print_bufs[j], MAX_LINE_SIZE,
+		                 table->show_fmt, "Entry %d:", i);
+		table->fmt_show(print_bufs[j], MAX_LINE_SIZE,
+		                table->show_fmt,
+		                sja1105_table_entry_get(table, config, i));
+		formatted_append(print_bufs[j], MAX_LINE_SIZE,
+		                 table->show_fmt, "");
+		j++;
+	}
+	show_print_bufs(print_bufs, shown);
+out:
+	if (print_bufs != NULL) {
+		for (j = 0; j < shown; j++) {
+			free(print_bufs[j]);
+		}
+		free(print_bufs);
+	}
+	free(match);
+	return rc;
 }
 
 int
 sja1105_staging_area_show(struct sja1105_staging_area *staging_area,
-                          char *table_name)
+                          char *table_name, const char *where,
+                          enum sja1105_output_format format)
 {
-	const char *options[] = {
-		"schedule-table",
-		"schedule-entry-points-table",
-		"vl-lookup-table",
-		"vl-policing-table",
-		"vl-forwarding-table",
-		"l2-address-lookup-table",
-		"l2-policing-table",
-		"vlan-lookup-table",
-		"l2-forwarding-table",
-		"mac-configuration-table",
-		"schedule-parameters-table",
-		"schedule-entry-points-parameters-table",
-		"vl-forwarding-parameters-table",
-		"l2-address-lookup-parameters-table",
-		"l2-forwarding-parameters-table",
-		"clock-synchronization-parameters-table",
-		"avb-parameters-table",
-		"general-parameters-table",
-		"retagging-table",
-	};
-	int (*next_config_table_show[])(struct sja1105_static_config *, int) = {
-		schedule_table_show,
-		schedule_entry_points_table_show,
-		vl_lookup_table_show,
-		vl_policing_table_show,
-		vl_forwarding_table_show,
-		l2_lookup_table_show,
-		l2_policing_table_show,
-		vlan_lookup_table_show,
-		l2_forwarding_table_show,
-		mac_config_table_show,
-		schedule_params_table_show,
-		schedule_entry_points_params_table_show,
-		vl_forwarding_params_table_show,
-		l2_lookup_params_table_show,
-		l2_forwarding_params_table_show,
-		clock_sync_params_table_show,
-		avb_params_table_show,
-		general_params_table_show,
-		retagging_table_show,
-	};
+	static struct sja1105_output output;
+	struct sja1105_output *out = NULL;
+	const struct sja1105_table *table;
+	struct sja1105_query *query = NULL;
 	struct sja1105_static_config *static_config;
 	char *index_ptr;
 	uint64_t entry_index_u64;
 	int entry_index;
-	unsigned int i;
+	int i;
 	int rc = 0;
 
 	static_config = &staging_area->static_config;
 
+	if (format != SJA1105_OUTPUT_TEXT) {
+		out = &output;
+		sja1105_output_begin(out, format);
+	}
 	if (table_name == NULL || strlen(table_name) == 0) {
 		logv("Showing all config tables");
-		printf("Device ID is 0x%08" PRIx64 " (%s)\n",
-		       static_config->device_id, sja1105_device_id_string_get(
-		       static_config->device_id, SJA1105_PART_NR_DONT_CARE));
-		for (i = 0; i < ARRAY_SIZE(next_config_table_show); i++) {
-			rc = next_config_table_show[i](static_config, -1);
+		if (out != NULL) {
+			sja1105_output_u64(out, "device_id",
+			                   static_config->device_id);
+		} else {
+			printf("Device ID is 0x%08" PRIx64 " (%s)\n",
+			       static_config->device_id,
+			       sja1105_device_id_string_get(
+			       static_config->device_id,
+			       SJA1105_PART_NR_DONT_CARE));
+		}
+		for (i = 0; i < sja1105_table_count; i++) {
+			rc = table_show(&sja1105_tables[i], static_config, -1,
+			                NULL, out);
 		}
 	} else {
 		index_ptr = strchr(table_name, '[');
@@ -203,14 +232,25 @@ sja1105_staging_area_show(struct sja1105_staging_area *staging_area,
 			 * but not on the entry index */
 			*index_ptr = '\0';
 		}
-		rc = get_match(table_name, options,
-		               ARRAY_SIZE(options));
-		if (rc < 0) {
+		table = sja1105_table_lookup(table_name);
+		if (table == NULL) {
+			rc = -EINVAL;
 			goto out;
 		}
-		rc = next_config_table_show[rc](static_config, entry_index);
+		if (where != NULL) {
+			query = sja1105_query_compile(table, where);
+			if (query == NULL) {
+				rc = -EINVAL;
+				goto out;
+			}
+		}
+		rc = table_show(table, static_config, entry_index, query, out);
 	}
 out:
+	if (out != NULL && rc >= 0) {
+		sja1105_output_end(out);
+	}
+	sja1105_query_free(query);
 	return rc;
 }
 
@@ -28,238 +28,557 @@
  * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
  * POSSIBILITY OF SUCH DAMAGE.
  *****************************************************************************/
-#include "xml/read/external.h"
+#include "xml/read/internal.h"
 #include <common.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include "internal.h"
 
-#ifndef LIBXML_TREE_ENABLED
+#if !defined(LIBXML_READER_ENABLED) || !defined(LIBXML_TREE_ENABLED)
 
 int
-sja1105_staging_area_from_xml(__attribute__((unused)) const char *xml_file,
-                              __attribute__((unused)) struct
-                              sja1105_staging_area *staging_area)
+sja1105_xml_plugin_read(__attribute__((unused)) const char *xml_file,
+                        __attribute__((unused)) struct
+                        sja1105_staging_area *staging_area,
+                        __attribute__((unused)) int merge,
+                        __attribute__((unused)) int jobs)
 {
-	loge("Tree support is not compiled in libxml2!");
+	loge("Reader support is not compiled in libxml2!");
 	return -1;
 }
 
 #else
 
-int xml_read_field(void *where, char *field_name, xmlNode *node)
+/* Text of an element, copied into buf. The common case of a single text
+ * node is copied straight out of the tree, without allocating. */
+static int xml_element_text(xmlNode *element, char *buf, size_t len)
 {
-	uint64_t *field_val;
-	char     *value = NULL;
-	int       rc = 0;
-	xmlNode  *cur;
+	const char *text = NULL;
+	char *value = NULL;
+	size_t size;
+	int rc = 0;
 
-	field_val = (uint64_t*) where;
-	for (cur = node->children; cur != NULL; cur = cur->next) {
-		if (xmlStrcmp(cur->name, (const xmlChar*) field_name) == 0) {
-			value = (char*) xmlNodeListGetString(cur->doc, cur->xmlChildrenNode, 1);
-		}
+	if (element->children == NULL) {
+		text = "";
+	} else if (element->children->next == NULL &&
+	           (element->children->type == XML_TEXT_NODE ||
+	            element->children->type == XML_CDATA_SECTION_NODE)) {
+		text = (const char*) element->children->content;
+	} else {
+		/* Entities and such */
+		value = (char*) xmlNodeListGetString(element->doc,
+		                                     element->children, 1);
+		text = value ? value : "";
 	}
-	if (value == NULL) {
-		loge("no element named \"%s\"!", field_name);
-		rc = -EINVAL;
+	size = strlen(text);
+	if (size >= len) {
+		loge("line %ld: value of \"%s\" is too long",
+		     xmlGetLineNo(element), (const char*) element->name);
+		rc = -E2BIG;
 		goto out;
 	}
-	rc = reliable_uint64_from_string(field_val, value, NULL);
+	memcpy(buf, text, size + 1);
 out:
 	xmlFree(value);
 	return rc;
 }
 
-int xml_read_array(void *where, int max_count, char *field_name, xmlNode *node)
+/* Decode a scalar (count == 1) or an array field from an element.
+ * Returns the number of values read. */
+static int xml_element_read(xmlNode *element, uint64_t *where, int count)
 {
-	uint64_t *field_val;
-	char     *value = NULL;
-	int       rc = 0;
-	xmlNode  *cur;
-
-	/* Convert "where" to an array of uint64_t */
-	field_val = (uint64_t*) where;
-	/* Get the "field_name" property into our "value" string */
-	for (cur = node->children; cur != NULL; cur = cur->next) {
-		if (xmlStrcmp(cur->name, (const xmlChar*) field_name) == 0) {
-			value = (char*) xmlNodeListGetString(cur->doc, cur->xmlChildrenNode, 1);
-		}
+	char buf[MAX_LINE_SIZE];
+	int rc;
+
+	rc = xml_element_text(element, buf, sizeof(buf));
+	if (rc < 0) {
+		return rc;
 	}
-	if (value == NULL) {
-		loge("no element named \"%s\"!", field_name);
-		rc = -EINVAL;
-		goto out;
+	if (count > 1) {
+		return read_array(buf, where, count);
 	}
-	rc = read_array(value, field_val, max_count);
-out:
-	xmlFree(value);
-	return rc;
+	rc = reliable_uint64_from_string(where, buf, NULL);
+	return (rc < 0) ? rc : 1;
 }
 
-int device_id_parse(xmlNode *node, uint64_t *device_id)
+/* Numeric attribute of an element. Returns 1 if it is there, 0 if not. */
+static int xml_attr_read(xmlNode *element, const char *name, uint64_t *value)
 {
-	int rc = 0;
+	xmlChar *attr;
+	int rc;
 
-	rc = xml_read_field(device_id, "device-id", node);
+	if (element->properties == NULL) {
+		return 0;
+	}
+	attr = xmlGetProp(element, BAD_CAST name);
+	if (attr == NULL) {
+		return 0;
+	}
+	rc = reliable_uint64_from_string(value, (char*) attr, NULL);
 	if (rc < 0) {
-		loge("No device-id entry present in static config node!");
-		goto out;
+		loge("line %ld: invalid %s \"%s\"", xmlGetLineNo(element),
+		     name, (char*) attr);
 	}
-	logv("read device-id 0x%" PRIx64 " (%s)",
-	     *device_id, sja1105_device_id_string_get(
-	     *device_id, SJA1105_PART_NR_DONT_CARE));
-out:
-	return rc;
+	xmlFree(attr);
+	return (rc < 0) ? -EINVAL : 1;
 }
 
+/* The file is streamed through an xmlTextReader. Only one table entry at
+ * a time is expanded into a tree, which the reader frees again once it
+ * moves past it, so memory does not grow with the size of the config:
+ *
+ * <sja1105>                    depth 0
+ *   <device-id>                depth 1
+ *   <static>                   depth 1
+ *     <l2-policing-table>      depth 2
+ *       <entry>                depth 3, expanded and given to parse_entry
+ */
+struct xml_reader_state {
+	const char *file;
+	struct sja1105_static_config *config;
+	const struct sja1105_table *table;
+	/* Entries seen so far in the current table element */
+	int table_entries;
+	int compact;
+	int merge;
+	int static_config_parsed;
+	int device_id_parsed;
+	/* Tables being decoded on other threads, oldest first */
+	struct xml_table_job *jobs;
+	int job_max;
+	int job_first;
+	int job_count;
+	int jobs_rc;
+};
+
+/* When merging, an entry with an <index> (as written by "config save")
+ * replaces the entry at that position, or is appended right after the
+ * last one. A table whose first entry has no index is replaced. */
 static int
-parse_config_table(xmlNode *node, struct sja1105_static_config *config)
+entry_position_get(xmlNode *index_node, xmlNode *node,
+                   struct xml_reader_state *state, int *count)
 {
-	char *table_name;
-
-	const char *options[] = {
-		"schedule-table",
-		"schedule-entry-points-table",
-		"vl-lookup-table",
-		"vl-policing-table",
-		"vl-forwarding-table",
-		"l2-address-lookup-table",
-		"l2-policing-table",
-		"vlan-lookup-table",
-		"l2-forwarding-table",
-		"mac-configuration-table",
-		"schedule-parameters-table",
-		"schedule-entry-points-parameters-table",
-		"vl-forwarding-parameters-table",
-		"l2-address-lookup-parameters-table",
-		"l2-forwarding-parameters-table",
-		"clock-synchronization-parameters-table",
-		"avb-parameters-table",
-		"general-parameters-table",
-		"retagging-table",
-	};
-	int (*next_parse_config_table[])(xmlNode *, struct
-	                                 sja1105_static_config *) = {
-		schedule_table_parse,
-		schedule_entry_points_table_parse,
-		vl_lookup_table_parse,
-		vl_policing_table_parse,
-		vl_forwarding_table_parse,
-		l2_address_lookup_table_parse,
-		l2_policing_table_parse,
-		vlan_lookup_table_parse,
-		l2_forwarding_table_parse,
-		mac_configuration_table_parse,
-		schedule_parameters_table_parse,
-		schedule_entry_points_parameters_table_parse,
-		vl_fw_params_table_parse,
-		l2_address_lookup_parameters_table_parse,
-		l2_forwarding_parameters_table_parse,
-		clock_synchronization_parameters_table_parse,
-		avb_parameters_table_parse,
-		general_parameters_table_parse,
-		retagging_table_parse,
-	};
+	uint64_t index;
 	int rc;
-	table_name = (char*) node->name;
-	rc = get_match(table_name, options, ARRAY_SIZE(options));
+
+	if (!state->merge) {
+		return *count;
+	}
+	if (index_node == NULL) {
+		if (state->table_entries == 0) {
+			*count = 0;
+		}
+		return *count;
+	}
+	rc = xml_element_read(index_node, &index, 1);
 	if (rc < 0) {
-		/* FIXME: Remove after migration period is over */
-		loge("ignoring XML entry %s", table_name);
-		rc = 0;
-		goto out;
+		return rc;
 	}
-	rc = next_parse_config_table[rc](node, config);
-out:
-	return rc;
+	if (index > (uint64_t) *count) {
+		loge("line %ld: %s has %d entries, cannot merge index %"
+		     PRIu64, xmlGetLineNo(node), state->table->description,
+		     *count, index);
+		return -ERANGE;
+	}
+	return (int) index;
 }
 
+/* The children of the entry are walked once, each one dispatched to its
+ * field through the perfect hash of field names. The fields are then
+ * decoded in table order, since whether a field is present may depend
+ * on the value of another one.
+ *
+ * In a compact document, missing fields are zero, and <entry count="N">
+ * stands for N entries, with the fields that have a step="S" attribute
+ * going up by S from one entry to the next.
+ */
 static int
-parse_static_config(xmlNode *node, struct sja1105_static_config *config)
+parse_entry(xmlNode *node, struct xml_reader_state *state)
 {
-	xmlNode *child;
-	int rc = 0;
+	const struct sja1105_table *table = state->table;
+	xmlNode *elements[SJA1105_MAX_FIELD_COUNT];
+	uint64_t steps[SJA1105_MAX_FIELD_COUNT];
+	const struct sja1105_field *field;
+	xmlNode *index_node = NULL;
+	uint64_t run = 1;
+	xmlNode *cur;
+	int  *count;
+	void *entry, *next;
+	int   pos;
+	int   rc = 0;
+	int   i;
+	uint64_t k;
 
-	for (child = node->children; child != NULL; child = child->next) {
-		if (child->type != XML_ELEMENT_NODE) {
+	count = sja1105_table_count_get(table, state->config);
+	memset(elements, 0, sizeof(elements));
+	for (cur = node->children; cur != NULL; cur = cur->next) {
+		if (cur->type != XML_ELEMENT_NODE) {
+			continue;
+		}
+		i = sja1105_field_index(table, (const char*) cur->name);
+		if (i < 0 && strcmp((const char*) cur->name, "index") == 0) {
+			index_node = cur;
+			continue;
+		} else if (i < 0) {
+			logv("line %ld: ignoring element %s", xmlGetLineNo(cur),
+			     (const char*) cur->name);
+			continue;
+		}
+		/* The last one wins */
+		elements[i] = cur;
+	}
+	pos = entry_position_get(index_node, node, state, count);
+	if (pos < 0) {
+		rc = pos;
+		goto out;
+	}
+	state->table_entries++;
+	rc = xml_attr_read(node, "count", &run);
+	if (rc < 0) {
+		goto out;
+	}
+	/* A negative count wraps around to above INT64_MAX */
+	if (run == 0 || run > INT64_MAX) {
+		loge("line %ld: invalid count %" PRId64, xmlGetLineNo(node),
+		     (int64_t) run);
+		rc = -EINVAL;
+		goto out;
+	}
+	if (run > (uint64_t) (table->max_count - pos)) {
+		loge("line %ld: cannot have more than %d %s entries!",
+		     xmlGetLineNo(node), table->max_count, table->description);
+		rc = -ERANGE;
+		goto out;
+	}
+	entry = sja1105_table_entry_get(table, state->config, pos);
+	memset(entry, 0, table->entry_size);
+	memset(steps, 0, sizeof(steps));
+	for (i = 0; i < table->field_count; i++) {
+		field = &table->fields[i];
+		if (field->flags & (SJA1105_FIELD_NO_XML |
+		                    SJA1105_FIELD_INTERNAL)) {
 			continue;
 		}
-		rc = parse_config_table(child, config);
+		if (!sja1105_field_present(table, field, entry)) {
+			continue;
+		}
+		if (elements[i] == NULL && state->compact) {
+			continue;
+		} else if (elements[i] == NULL) {
+			loge("no element named \"%s\"!", field->name);
+			rc = -EINVAL;
+		} else {
+			rc = xml_element_read(elements[i],
+			                      sja1105_field_get(field, entry),
+			                      field->count);
+		}
+		if (rc >= 0 && rc != field->count) {
+			loge("%s must have %d elements!", field->name,
+			     field->count);
+			rc = -ERANGE;
+		}
+		if (rc >= 0 && elements[i] != NULL) {
+			rc = xml_attr_read(elements[i], "step", &steps[i]);
+			if (rc > 0 && field->count > 1) {
+				loge("%s is an array and cannot step",
+				     field->name);
+				rc = -EINVAL;
+			}
+		}
 		if (rc < 0) {
-			loge("parse_config_table failed");
+			loge("line %ld: %s entry is incomplete!",
+			     xmlGetLineNo(node), table->description);
+			rc = -EINVAL;
 			goto out;
 		}
 	}
+	for (k = 1; k < run; k++) {
+		next = sja1105_table_entry_get(table, state->config, pos + k);
+		memcpy(next, entry, table->entry_size);
+		for (i = 0; i < table->field_count; i++) {
+			if (steps[i]) {
+				*sja1105_field_get(&table->fields[i], next) +=
+					k * steps[i];
+			}
+		}
+	}
+	if (pos + (int) run > *count) {
+		*count = pos + run;
+	}
+	rc = 0;
 out:
 	return rc;
 }
 
 static int
-parse_root(xmlNode *root, struct sja1105_staging_area *staging_area)
+xml_reader_device_id(xmlTextReaderPtr reader, struct xml_reader_state *state)
 {
-	char *config_section;
 	xmlNode *node;
-	int static_config_parsed = 0;
-	int device_id_parsed = 0;
-	int rc = 0;
+	int rc;
 
-	if (root->type != XML_ELEMENT_NODE) {
-		loge("Root node must be of element type!");
-		rc = -EINVAL;
-		goto out;
+	node = xmlTextReaderExpand(reader);
+	if (node == NULL) {
+		loge("%s:%d: malformed XML", state->file,
+		     xmlTextReaderGetParserLineNumber(reader));
+		return -EINVAL;
 	}
-	if (strcasecmp((char*) root->name, SJA1105_NETCONF_ROOT)) {
-		loge("Root node must be named \"%s\"!", SJA1105_NETCONF_ROOT);
-		rc = -EINVAL;
-		goto out;
+	rc = xml_element_read(node, &state->config->device_id, 1);
+	if (rc < 0) {
+		loge("%s:%ld: Could not get device-id from XML!", state->file,
+		     xmlGetLineNo(node));
+		return rc;
+	}
+	logv("read device-id 0x%" PRIx64 " (%s)", state->config->device_id,
+	     sja1105_device_id_string_get(state->config->device_id,
+	     SJA1105_PART_NR_DONT_CARE));
+	state->device_id_parsed = 1;
+	return 0;
+}
+
+static void xml_reader_table_end(struct xml_reader_state *state)
+{
+	int *count = sja1105_table_count_get(state->table, state->config);
+
+	if (state->merge && state->table_entries == 0) {
+		/* Replaced by an empty table */
+		*count = 0;
+	}
+	logv("read %d %s entries", *count, state->table->description);
+	state->table = NULL;
+}
+
+/* With more than one job, each table element is expanded as a whole and
+ * decoded on a thread of its own, while the main thread goes on reading
+ * the document. Tables fill disjoint parts of the static config, and two
+ * elements of the same table are never decoded at the same time. The
+ * subtrees are preserved until the end, so memory is no longer bounded.
+ * Jobs are joined in document order, and the error returned is that of
+ * the first table in the document that failed.
+ */
+struct xml_table_job {
+	struct xml_reader_state state;
+	const struct sja1105_table *table;
+	xmlNode  *node;
+	pthread_t thread;
+	int       started;
+	int       rc;
+};
+
+static int xml_table_decode(xmlNode *node, struct xml_reader_state *state)
+{
+	xmlNode *cur;
+	int rc;
+
+	for (cur = node->children; cur != NULL; cur = cur->next) {
+		if (cur->type != XML_ELEMENT_NODE) {
+			continue;
+		}
+		rc = parse_entry(cur, state);
+		if (rc < 0) {
+			return rc;
+		}
+	}
+	xml_reader_table_end(state);
+	return 0;
+}
+
+static void *xml_table_thread(void *arg)
+{
+	struct xml_table_job *job = arg;
+
+	job->rc = xml_table_decode(job->node, &job->state);
+	return NULL;
+}
+
+/* Wait for the oldest job in flight */
+static void xml_job_join(struct xml_reader_state *state)
+{
+	struct xml_table_job *job = &state->jobs[state->job_first];
+
+	if (job->started) {
+		pthread_join(job->thread, NULL);
+	}
+	if (job->rc < 0 && state->jobs_rc == 0) {
+		state->jobs_rc = job->rc;
+	}
+	state->job_first = (state->job_first + 1) % state->job_max;
+	state->job_count--;
+}
+
+static void xml_jobs_finish(struct xml_reader_state *state)
+{
+	while (state->job_count) {
+		xml_job_join(state);
+	}
+}
+
+static int
+xml_job_start(xmlTextReaderPtr reader, struct xml_reader_state *state)
+{
+	struct xml_table_job *job;
+	xmlNode *node;
+	int i;
+
+	node = xmlTextReaderExpand(reader);
+	if (node == NULL || xmlTextReaderPreserve(reader) == NULL) {
+		loge("%s:%d: malformed XML", state->file,
+		     xmlTextReaderGetParserLineNumber(reader));
+		return -EINVAL;
+	}
+	/* Let an earlier element of the same table finish first */
+	for (i = state->job_count - 1; i >= 0; i--) {
+		job = &state->jobs[(state->job_first + i) % state->job_max];
+		if (job->table == state->table) {
+			break;
+		}
+	}
+	for (; i >= 0; i--) {
+		xml_job_join(state);
+	}
+	if (state->job_count == state->job_max) {
+		xml_job_join(state);
+	}
+	job = &state->jobs[(state->job_first + state->job_count) %
+	                   state->job_max];
+	memset(job, 0, sizeof(*job));
+	job->state = *state;
+	job->table = state->table;
+	job->node  = node;
+	state->job_count++;
+	state->table = NULL;
+	if (pthread_create(&job->thread, NULL, xml_table_thread, job) != 0) {
+		/* Do it from here instead */
+		xml_table_thread(job);
+		return 0;
+	}
+	job->started = 1;
+	return 0;
+}
+
+/* Returns 1 if the reader should descend into the element,
+ * 0 if it should skip over it, and negative on error. */
+static int
+xml_reader_element(xmlTextReaderPtr reader, struct xml_reader_state *state)
+{
+	const char *name = (const char*) xmlTextReaderConstLocalName(reader);
+	int line = xmlTextReaderGetParserLineNumber(reader);
+	xmlChar *attr;
+	xmlNode *node;
+	int rc;
+
+	switch (xmlTextReaderDepth(reader)) {
+	case 0:
+		if (strcasecmp(name, SJA1105_NETCONF_ROOT)) {
+			loge("Root node must be named \"%s\"!",
+			     SJA1105_NETCONF_ROOT);
+			return -EINVAL;
+		}
+		return 1;
+	case 1:
+		if (strcmp(name, "device-id") == 0) {
+			rc = xml_reader_device_id(reader, state);
+			return (rc < 0) ? rc : 0;
+		} else if (strcmp(name, "static") == 0) {
+			attr = xmlTextReaderGetAttribute(reader,
+			                                 BAD_CAST "compact");
+			state->compact = attr && !strcmp((char*) attr, "true");
+			xmlFree(attr);
+			state->static_config_parsed = 1;
+			return 1;
+		}
+		loge("%s:%d: unknown config section %s", state->file,
+		     line, name);
+		return -EINVAL;
+	case 2:
+		state->table = sja1105_table_lookup(name);
+		if (state->table == NULL) {
+			/* FIXME: Remove after migration period is over */
+			loge("ignoring XML entry %s", name);
+			return 0;
+		}
+		if (state->table->fields == NULL) {
+			logv("%s unimplemented", state->table->description);
+			state->table = NULL;
+			return 0;
+		}
+		state->table_entries = 0;
+		if (state->job_max > 1) {
+			rc = xml_job_start(reader, state);
+			return (rc < 0) ? rc : 0;
+		}
+		if (xmlTextReaderIsEmptyElement(reader)) {
+			/* No entries, and no end element to come */
+			xml_reader_table_end(state);
+			return 0;
+		}
+		return 1;
+	case 3:
+		node = xmlTextReaderExpand(reader);
+		if (node == NULL) {
+			loge("%s:%d: malformed XML", state->file, line);
+			return -EINVAL;
+		}
+		rc = parse_entry(node, state);
+		return (rc < 0) ? rc : 0;
+	default:
+		return 0;
 	}
-	for (node = root->children; node != NULL; node = node->next) {
-		if (node->type != XML_ELEMENT_NODE) {
+}
+
+static int
+xml_reader_parse(xmlTextReaderPtr reader, struct xml_reader_state *state)
+{
+	int type;
+	int rc;
+
+	rc = xmlTextReaderRead(reader);
+	while (rc == 1) {
+		type = xmlTextReaderNodeType(reader);
+		if (type == XML_READER_TYPE_END_ELEMENT && state->table &&
+		    xmlTextReaderDepth(reader) == 2) {
+			xml_reader_table_end(state);
+		}
+		if (type != XML_READER_TYPE_ELEMENT) {
+			rc = xmlTextReaderRead(reader);
 			continue;
 		}
-		config_section = (char*) node->name;
-		if (strcmp(config_section, "static") == 0) {
-			rc = parse_static_config(node,
-			                        &staging_area->static_config);
-			if (rc < 0) {
-				loge("Could not parse static config from XML!");
-				goto out;
-			}
-			static_config_parsed = 1;
-		} else if (strcmp(config_section, "device-id") == 0) {
-			rc = device_id_parse(root, &staging_area->
-			                     static_config.device_id);
-			if (rc < 0) {
-				loge("Could not get device-id from XML!");
-				goto out;
-			}
-			device_id_parsed = 1;
-		} else {
-			loge("unknown config section %s", config_section);
-			rc = -EINVAL;
+		rc = xml_reader_element(reader, state);
+		if (rc < 0) {
+			return rc;
 		}
+		rc = rc ? xmlTextReaderRead(reader) : xmlTextReaderNext(reader);
+	}
+	if (rc < 0) {
+		loge("%s:%d: malformed XML", state->file,
+		     xmlTextReaderGetParserLineNumber(reader));
+		return -EINVAL;
 	}
-	if (!static_config_parsed) {
+	if (state->merge) {
+		/* Anything may be left out */
+		return 0;
+	}
+	if (!state->static_config_parsed) {
 		loge("<static> node not present in XML!");
-		rc = -EINVAL;
-		goto out;
+		return -EINVAL;
 	}
-	if (!device_id_parsed) {
+	if (!state->device_id_parsed) {
 		loge("<device-id> not present in XML!");
-		rc = -EINVAL;
-		goto out;
+		return -EINVAL;
 	}
-out:
-	return rc;
+	return 0;
 }
 
+/* Entry point of the plugin, see xml-plugin.c */
 int
-sja1105_staging_area_from_xml(const char *xml_file,
-                              struct sja1105_staging_area *staging_area)
+sja1105_xml_plugin_read(const char *xml_file,
+                        struct sja1105_staging_area *staging_area,
+                        int merge, int jobs)
 {
-	xmlNode *root = NULL;
-	xmlDoc  *doc = NULL;
-	int      rc = 0;
+	struct xml_reader_state state;
+	xmlTextReaderPtr reader;
+	xmlDoc *doc = NULL;
+	int rc = 0;
+	int prof;
 
 	/*
 	 * this initializes the library and checks potential ABI mismatches
@@ -268,20 +587,51 @@ sja1105_staging_area_from_xml(const char *xml_file,
 	 */
 	LIBXML_TEST_VERSION;
 
-	doc = xmlReadFile(xml_file, NULL, 0);
-	if (doc == NULL) {
-		loge("could not parse file %s", xml_file);
+	prof = sja1105_profile_begin("xml-parse", NULL);
+	reader = xmlReaderForFile(xml_file, NULL, 0);
+	if (reader == NULL) {
+		loge("could not open file %s", xml_file);
+		rc = -EINVAL;
+		goto out;
+	}
+	if (!merge) {
+		memset(staging_area, 0, sizeof(*staging_area));
+	}
+	memset(&state, 0, sizeof(state));
+	state.file   = xml_file;
+	state.config = &staging_area->static_config;
+	state.merge  = merge;
+	if (jobs > 1) {
+		state.jobs = calloc(jobs, sizeof(*state.jobs));
+		if (state.jobs == NULL) {
+			loge("malloc failed");
+			rc = -ENOMEM;
+			goto out;
+		}
+		state.job_max = jobs;
+	}
+	rc = xml_reader_parse(reader, &state);
+	xml_jobs_finish(&state);
+	if (jobs > 1) {
+		/* Preserved subtrees belong to the document,
+		 * which is then ours to free */
+		doc = xmlTextReaderCurrentDoc(reader);
 	}
-	root = xmlDocGetRootElement(doc);
-	if (!root) {
-		loge("failed to get root element");
+	if (state.jobs_rc < 0) {
+		/* Comes earlier in the document */
+		rc = state.jobs_rc;
+	}
+	if (rc < 0) {
 		goto out;
 	}
-	memset(staging_area, 0, sizeof(*staging_area));
-	rc = parse_root(root, staging_area);
+	/* Catch values that packing would silently truncate */
+	rc = sja1105_static_config_check(&staging_area->static_config);
 out:
+	xmlFreeTextReader(reader);
 	xmlFreeDoc(doc);
+	free(state.jobs);
 	xmlCleanupParser();
+	sja1105_profile_end(prof);
 	return rc;
 }
 
@@ -29,185 +29,321 @@
  * POSSIBILITY OF SUCH DAMAGE.
  *****************************************************************************/
 #include <string.h>
+#include <errno.h>
 #include "xml/write/external.h"
 #include <common.h>
 #include "internal.h"
 
-#if !defined(LIBXML_WRITER_ENABLED) || !defined(LIBXML_OUTPUT_ENABLED)
+/* The XML is put together by hand in a large buffer, rather than through
+ * xmlTextWriter. The output is the same as libxml2's, tab-indented, and
+ * so are the values: "0x%" PRIX64 and "%" PRIu64 for the index. */
+#define XML_OUT_BUF_SIZE 65536
+/* Indentation plus "<" and ">" around the longest field name */
+#define XML_TAG_SIZE     64
 
-int
-sja1105_staging_area_to_xml(__attribute__((unused)) char *xml_file,
-                            __attribute__((unused)) struct sja1105_staging_area
-                            *staging_area)
+struct xml_out {
+	FILE  *file;
+	size_t len;
+	int    error;
+	char   buf[XML_OUT_BUF_SIZE];
+};
+
+/* Field tags with indentation, rendered once per table */
+struct xml_tag {
+	char open[XML_TAG_SIZE];
+	char close[XML_TAG_SIZE];
+	int  open_len;
+	int  close_len;
+};
+
+static void xml_out_flush(struct xml_out *out)
 {
-	loge("Writer or output support is not compiled in libxml!");
-	return -1;
+	if (out->len && fwrite(out->buf, 1, out->len, out->file) != out->len) {
+		out->error = 1;
+	}
+	out->len = 0;
 }
 
-#else
+static void xml_out_write(struct xml_out *out, const char *s, size_t len)
+{
+	if (out->len + len > sizeof(out->buf)) {
+		xml_out_flush(out);
+	}
+	memcpy(out->buf + out->len, s, len);
+	out->len += len;
+}
 
-int xml_write_field(xmlTextWriterPtr writer, char *field, uint64_t value)
+static void xml_out_str(struct xml_out *out, const char *s)
 {
-	char print_buf[MAX_LINE_SIZE];
+	xml_out_write(out, s, strlen(s));
+}
 
-	if (!strcmp(field, "index"))
-		snprintf(print_buf, MAX_LINE_SIZE, "%" PRIu64, value);
-	else
-		snprintf(print_buf, MAX_LINE_SIZE, "0x%" PRIX64, value);
+static void xml_out_hex(struct xml_out *out, uint64_t value)
+{
+	static const char digits[] = "0123456789ABCDEF";
+	char  buf[20];
+	char *p = buf + sizeof(buf);
 
-	/* Returns the bytes written (may be 0 because of buffering) or -1 in case of error.
-	 * Had to read the libxml2 code for that.
-	 */
-	return xmlTextWriterWriteElement(writer, BAD_CAST field, BAD_CAST print_buf);
+	do {
+		*--p = digits[value & 0xF];
+		value >>= 4;
+	} while (value);
+	*--p = 'x';
+	*--p = '0';
+	xml_out_write(out, p, buf + sizeof(buf) - p);
 }
 
-int xml_write_array(xmlTextWriterPtr writer, char *field, uint64_t *values, int count)
+static void xml_out_dec(struct xml_out *out, uint64_t value)
 {
-	char print_buf[MAX_LINE_SIZE];
+	char  buf[24];
+	char *p = buf + sizeof(buf);
 
-	print_array(print_buf, values, count);
-	return xmlTextWriterWriteElement(writer, BAD_CAST field, BAD_CAST print_buf);
+	do {
+		*--p = '0' + value % 10;
+		value /= 10;
+	} while (value);
+	xml_out_write(out, p, buf + sizeof(buf) - p);
 }
 
-static int device_id_write(xmlTextWriterPtr writer, uint64_t device_id)
+/* Same format as print_array() */
+static void xml_out_array(struct xml_out *out, uint64_t *values, int count)
 {
-	logv("writing device_id");
-	return xml_write_field(writer, "device-id", device_id);
+	int i;
+
+	xml_out_write(out, "[", 1);
+	for (i = 0; i < count; i++) {
+		xml_out_hex(out, values[i]);
+		xml_out_write(out, " ", 1);
+	}
+	xml_out_write(out, "]", 1);
+}
+
+static void
+xml_tag_render(struct xml_tag *tag, const char *indent, const char *name)
+{
+	tag->open_len = snprintf(tag->open, sizeof(tag->open), "%s<%s>",
+	                         indent, name);
+	tag->close_len = snprintf(tag->close, sizeof(tag->close), "</%s>\n",
+	                          name);
 }
 
+static int xml_array_is_zero(uint64_t *values, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (values[i]) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int xml_field_written(const struct sja1105_table *table,
+                             const struct sja1105_field *field, void *entry)
+{
+	if (field->flags & (SJA1105_FIELD_NO_XML | SJA1105_FIELD_INTERNAL)) {
+		return 0;
+	}
+	return sja1105_field_present(table, field, entry);
+}
+
+/* With --compact, a run of entries which only differ in scalar fields that
+ * go up by the same amount from one entry to the next (e.g. the VLAN ID)
+ * is written once, as <entry count="N"> with step="S" on those fields.
+ * Fields on which other fields depend are not allowed to step.
+ * Returns the length of the run starting at entry i. */
 static int
-static_config_write(xmlTextWriterPtr writer,
-                    struct sja1105_static_config *config)
+entry_run_get(const struct sja1105_table *table,
+              struct sja1105_static_config *config,
+              int i, int count, const int *is_cond, uint64_t *steps)
 {
-	const char *options[] = {
-		"schedule-table",
-		"schedule-entry-points-table",
-		"vl-lookup-table",
-		"vl-policing-table",
-		"vl-forwarding-table",
-		"l2-address-lookup-table",
-		"l2-policing-table",
-		"vlan-lookup-table",
-		"l2-forwarding-table",
-		"mac-configuration-table",
-		"schedule-parameters-table",
-		"schedule-entry-points-parameters-table",
-		"vl-forwarding-parameters-table",
-		"l2-address-lookup-parameters-table",
-		"l2-forwarding-parameters-table",
-		"clock-synchronization-parameters-table",
-		"avb-parameters-table",
-		"general-parameters-table",
-		"retagging-table",
-	};
-	int (*next_write_config_table[])(xmlTextWriterPtr,
-	                                 struct sja1105_static_config *) = {
-		schedule_table_write,
-		schedule_entry_points_table_write,
-		vl_lookup_table_write,
-		vl_policing_table_write,
-		vl_forwarding_table_write,
-		l2_address_lookup_table_write,
-		l2_policing_table_write,
-		vlan_lookup_table_write,
-		l2_forwarding_table_write,
-		mac_configuration_table_write,
-		schedule_parameters_table_write,
-		schedule_entry_points_parameters_table_write,
-		vl_forwarding_parameters_table_write,
-		l2_address_lookup_parameters_table_write,
-		l2_forwarding_parameters_table_write,
-		clock_synchronization_parameters_table_write,
-		avb_parameters_table_write,
-		general_parameters_table_write,
-		retagging_table_write,
-	};
-	int rc = 0;
-	unsigned int i;
+	const struct sja1105_field *field;
+	uint64_t *base, *value;
+	void *base_entry, *entry;
+	int n, j;
 
-	rc = xmlTextWriterStartElement(writer, BAD_CAST "static");
-	if (rc < 0) {
-		loge("could not create root element for static config");
-		goto out;
+	memset(steps, 0, SJA1105_MAX_FIELD_COUNT * sizeof(*steps));
+	if (i + 1 >= count) {
+		return 1;
 	}
-	for (i = 0; i < ARRAY_SIZE(options); i++) {
-		rc |= xmlTextWriterStartElement(writer, BAD_CAST options[i]);
-		rc |= next_write_config_table[i](writer, config);
-		rc |= xmlTextWriterEndElement(writer);
-		if (rc < 0) {
-			return -EINVAL;
+	base_entry = sja1105_table_entry_get(table, config, i);
+	entry = sja1105_table_entry_get(table, config, i + 1);
+	for (j = 0; j < table->field_count; j++) {
+		field = &table->fields[j];
+		if (!xml_field_written(table, field, base_entry)) {
+			continue;
+		}
+		base  = sja1105_field_get(field, base_entry);
+		value = sja1105_field_get(field, entry);
+		if (field->count > 1) {
+			if (memcmp(base, value, field->count * sizeof(*base))) {
+				return 1;
+			}
+		} else if (*value != *base) {
+			if (is_cond[j] || *value < *base) {
+				return 1;
+			}
+			steps[j] = *value - *base;
 		}
 	}
-	rc = xmlTextWriterEndElement(writer);
-	if (rc < 0) {
-		loge("could not end root element for static config");
-		goto out;
+	for (n = 2; i + n < count; n++) {
+		entry = sja1105_table_entry_get(table, config, i + n);
+		for (j = 0; j < table->field_count; j++) {
+			field = &table->fields[j];
+			if (!xml_field_written(table, field, base_entry)) {
+				continue;
+			}
+			base  = sja1105_field_get(field, base_entry);
+			value = sja1105_field_get(field, entry);
+			if (field->count > 1) {
+				if (memcmp(base, value,
+				           field->count * sizeof(*base))) {
+					break;
+				}
+			} else if (*value != *base + n * steps[j]) {
+				break;
+			}
+		}
+		if (j != table->field_count) {
+			break;
+		}
 	}
-out:
-	return rc;
+	return n;
 }
 
-int
-sja1105_staging_area_to_xml(char *xml_file,
-                            struct sja1105_staging_area *staging_area)
+static void
+table_write(struct xml_out *out, const struct sja1105_table *table,
+            struct sja1105_static_config *config, int compact)
 {
-	int rc = 0;
-	xmlTextWriterPtr writer;
-
-	/*
-	 * this initializes the library and checks potential ABI mismatches
-	 * between the version it was compiled for and the actual shared
-	 * library used.
-	 */
-	LIBXML_TEST_VERSION
-
-	writer = xmlNewTextWriterFilename(xml_file, 0);
-	if (writer == NULL) {
-		loge("cannot create xml writer");
-		rc = -errno;
-		goto out;
-	}
-	rc |= xmlTextWriterSetIndent(writer, 1);
-	rc |= xmlTextWriterSetIndentString(writer, (const xmlChar*) "\t");
-	if (rc < 0) {
-		loge("could not set xml indentation");
-		goto out;
+	struct xml_tag tags[SJA1105_MAX_FIELD_COUNT];
+	struct xml_tag table_tag;
+	const struct sja1105_field *field;
+	uint64_t steps[SJA1105_MAX_FIELD_COUNT];
+	int   is_cond[SJA1105_MAX_FIELD_COUNT];
+	int   count = *sja1105_table_count_get(table, config);
+	int   write_index = 1;
+	uint64_t *value;
+	void *entry;
+	int   i, j, n;
+
+	if (table->fields == NULL || count == 0) {
+		xml_out_str(out, "\t\t<");
+		xml_out_str(out, table->name);
+		xml_out_str(out, "/>\n");
+		return;
 	}
-	rc = xmlTextWriterStartDocument(writer, NULL, "UTF-8", NULL);
-	if (rc < 0) {
-		goto out;
+	xml_tag_render(&table_tag, "\t\t", table->name);
+	memset(is_cond, 0, sizeof(is_cond));
+	for (j = 0; j < table->field_count; j++) {
+		field = &table->fields[j];
+		xml_tag_render(&tags[j], "\t\t\t\t", field->name);
+		/* Entries are numbered by an "index" element, unless the
+		 * table has a field of its own by that name (L2 Address
+		 * Lookup) */
+		if (strcmp(field->name, "index") == 0) {
+			write_index = 0;
+		}
+		if (field->cond_field >= 0) {
+			is_cond[field->cond_field] = 1;
+		}
 	}
-	/* Root element */
-	rc = xmlTextWriterStartElement(writer, BAD_CAST SJA1105_NETCONF_ROOT);
-	if (rc < 0) {
-		goto out;
+	logv("writing %d %s entries", count, table->description);
+	xml_out_write(out, table_tag.open, table_tag.open_len);
+	xml_out_write(out, "\n", 1);
+	for (i = 0; i < count; i += n) {
+		entry = sja1105_table_entry_get(table, config, i);
+		n = 1;
+		if (compact) {
+			n = entry_run_get(table, config, i, count, is_cond,
+			                  steps);
+		}
+		if (n > 1) {
+			xml_out_str(out, "\t\t\t<entry count=\"");
+			xml_out_dec(out, n);
+			xml_out_str(out, "\">\n");
+		} else {
+			xml_out_str(out, "\t\t\t<entry>\n");
+		}
+		if (write_index) {
+			xml_out_str(out, "\t\t\t\t<index>");
+			xml_out_dec(out, i);
+			xml_out_str(out, "</index>\n");
+		}
+		for (j = 0; j < table->field_count; j++) {
+			field = &table->fields[j];
+			if (!xml_field_written(table, field, entry)) {
+				continue;
+			}
+			value = sja1105_field_get(field, entry);
+			if (n > 1 && steps[j]) {
+				/* Same as the open tag, plus the step */
+				xml_out_write(out, tags[j].open,
+				              tags[j].open_len - 1);
+				xml_out_str(out, " step=\"");
+				xml_out_hex(out, steps[j]);
+				xml_out_str(out, "\">");
+			} else if (compact &&
+			           xml_array_is_zero(value, field->count)) {
+				continue;
+			} else {
+				xml_out_write(out, tags[j].open,
+				              tags[j].open_len);
+			}
+			if (field->count > 1) {
+				xml_out_array(out, value, field->count);
+			} else {
+				xml_out_hex(out, *value);
+			}
+			xml_out_write(out, tags[j].close, tags[j].close_len);
+		}
+		xml_out_str(out, "\t\t\t</entry>\n");
 	}
-	rc = xmlTextWriterWriteAttribute(writer, BAD_CAST "xmlns",
-	                                 BAD_CAST SJA1105_NETCONF_NS);
-	/* Device ID */
-	device_id_write(writer, staging_area->static_config.device_id);
-	/* Static config */
-	rc = static_config_write(writer, &staging_area->static_config);
-	if (rc < 0) {
-		loge("could not write config tables");
+	xml_out_write(out, "\t\t", 2);
+	xml_out_write(out, table_tag.close, table_tag.close_len);
+}
+
+int
+sja1105_staging_area_to_xml(const char *xml_file,
+                            struct sja1105_staging_area *staging_area,
+                            int compact)
+{
+	static struct xml_out out;
+	struct sja1105_static_config *config = &staging_area->static_config;
+	int rc = 0;
+	int prof;
+	int i;
+
+	prof = sja1105_profile_begin("xml-write", NULL);
+	memset(&out, 0, sizeof(out));
+	out.file = fopen(xml_file, "w");
+	if (out.file == NULL) {
+		loge("cannot open %s: %s", xml_file, strerror(errno));
+		rc = -errno;
 		goto out;
 	}
-	/* End root element */
-	rc = xmlTextWriterEndElement(writer);
-	if (rc < 0) {
-		goto out;
+	xml_out_str(&out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	xml_out_str(&out, "<" SJA1105_NETCONF_ROOT " xmlns=\""
+	            SJA1105_NETCONF_NS "\">\n");
+	logv("writing device_id");
+	xml_out_str(&out, "\t<device-id>");
+	xml_out_hex(&out, config->device_id);
+	xml_out_str(&out, "</device-id>\n");
+	/* Elided fields are only allowed back in by the reader
+	 * when the document says so */
+	xml_out_str(&out, compact ? "\t<static compact=\"true\">\n" :
+	                            "\t<static>\n");
+	for (i = 0; i < sja1105_table_count; i++) {
+		table_write(&out, &sja1105_tables[i], config, compact);
 	}
-	rc = xmlTextWriterEndDocument(writer);
-	if (rc < 0) {
-		loge("could not write xml document");
-		goto out;
+	xml_out_str(&out, "\t</static>\n");
+	xml_out_str(&out, "</" SJA1105_NETCONF_ROOT ">\n");
+	xml_out_flush(&out);
+	if (fclose(out.file) != 0 || out.error) {
+		loge("could not write xml document %s", xml_file);
+		rc = -EIO;
 	}
-	/*
-	 * Cleanup function for the XML library.
-	 */
-	xmlCleanupParser();
 out:
-	return 0;
+	sja1105_profile_end(prof);
+	return rc;
 }
-
-#endif
@@ -0,0 +1,592 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include "internal.h"
+
+/* Request protocol between "sja1105-tool -s <socket>" and sja1105d.
+ *
+ * The client sends a struct sja1105d_request header, immediately
+ * followed by the argv of the command as consecutive NUL-terminated
+ * strings (hdr.len bytes in total). Its stdin, stdout and stderr
+ * are passed along with the header as SCM_RIGHTS ancillary data,
+ * so the command runs in the daemon but reads and prints through
+ * the client's own file descriptors. When the command finishes,
+ * the daemon replies with a struct sja1105d_response carrying the
+ * (negative) sja1105-tool return code. A connection may be reused
+ * for any number of requests.
+ */
+#define SJA1105D_MAGIC           0x51050d01
+#define SJA1105D_MAX_REQUEST     4096
+#define SJA1105D_MAX_ARGS        64
+#define SJA1105D_MAX_CLIENTS     16
+#define SJA1105D_NUM_FDS         3
+#define SJA1105D_DEFAULT_DELAY   1000
+/* How long a client may take to send the rest of a request
+ * once it has started, before it is dropped */
+#define SJA1105D_RECV_TIMEOUT_MS 1000
+
+struct sja1105d_request {
+	uint32_t magic;
+	uint32_t argc;
+	uint32_t len;
+};
+
+struct sja1105d_response {
+	uint32_t magic;
+	int32_t  rc;
+};
+
+static volatile sig_atomic_t daemon_quit;
+
+static void print_usage()
+{
+	printf("Usage: sja1105-tool daemon [-s|--socket <path>] [-d|--delay <ms>]\n");
+	printf("Serve sja1105-tool commands from memory over a UNIX socket.\n");
+	printf("Default socket is %s. Changes to the staging area are\n",
+	       SJA1105D_DEFAULT_SOCKET);
+	printf("written back <ms> milliseconds (default %d) after the last\n",
+	       SJA1105D_DEFAULT_DELAY);
+	printf("modification, before any upload, and on exit.\n");
+}
+
+static int reliable_send(int fd, const void *buf, size_t len)
+{
+	const char *p = buf;
+	ssize_t rc;
+
+	while (len) {
+		rc = write(fd, p, len);
+		if (rc < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -errno;
+		}
+		p   += rc;
+		len -= rc;
+	}
+	return 0;
+}
+
+static int reliable_recv(int fd, void *buf, size_t len)
+{
+	char *p = buf;
+	ssize_t rc;
+
+	while (len) {
+		rc = read(fd, p, len);
+		if (rc < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			/* Including EAGAIN when SO_RCVTIMEO expires */
+			return -errno;
+		}
+		if (rc == 0) {
+			return -EPIPE;
+		}
+		p   += rc;
+		len -= rc;
+	}
+	return 0;
+}
+
+static int64_t monotonic_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int daemon_client_run(const char *socket_path, int argc, char **argv)
+{
+	int fds[SJA1105D_NUM_FDS] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+	char cmsg_buf[CMSG_SPACE(sizeof(fds))];
+	struct sja1105d_response response;
+	struct sja1105d_request request;
+	char payload[SJA1105D_MAX_REQUEST];
+	struct sockaddr_un addr;
+	struct cmsghdr *cmsg;
+	struct msghdr msg;
+	struct iovec iov;
+	size_t len = 0;
+	size_t arg_len;
+	int sock;
+	int rc;
+	int i;
+
+	for (i = 0; i < argc; i++) {
+		arg_len = strlen(argv[i]) + 1;
+		if (len + arg_len > sizeof(payload)) {
+			loge("command line too long");
+			rc = -1;
+			sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+			goto out;
+		}
+		memcpy(payload + len, argv[i], arg_len);
+		len += arg_len;
+	}
+	request.magic = SJA1105D_MAGIC;
+	request.argc  = argc;
+	request.len   = len;
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) {
+		loge("could not create socket");
+		rc = -1;
+		goto filesystem_error;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+	rc = connect(sock, (struct sockaddr*) &addr, sizeof(addr));
+	if (rc < 0) {
+		loge("could not connect to sja1105d at %s", socket_path);
+		goto filesystem_error_close;
+	}
+
+	memset(&msg, 0, sizeof(msg));
+	memset(cmsg_buf, 0, sizeof(cmsg_buf));
+	iov.iov_base = &request;
+	iov.iov_len  = sizeof(request);
+	msg.msg_iov        = &iov;
+	msg.msg_iovlen     = 1;
+	msg.msg_control    = cmsg_buf;
+	msg.msg_controllen = sizeof(cmsg_buf);
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type  = SCM_RIGHTS;
+	cmsg->cmsg_len   = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	rc = sendmsg(sock, &msg, 0);
+	if (rc != sizeof(request)) {
+		loge("could not send request to sja1105d");
+		rc = -1;
+		goto filesystem_error_close;
+	}
+	rc = reliable_send(sock, payload, len);
+	if (rc < 0) {
+		loge("could not send request to sja1105d");
+		goto filesystem_error_close;
+	}
+	rc = reliable_recv(sock, &response, sizeof(response));
+	if (rc < 0 || response.magic != SJA1105D_MAGIC) {
+		loge("no valid response from sja1105d");
+		rc = -1;
+		goto filesystem_error_close;
+	}
+	rc = response.rc;
+	close(sock);
+out:
+	return rc;
+filesystem_error_close:
+	close(sock);
+filesystem_error:
+	sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
+	return rc;
+}
+
+static void daemon_signal_handler(int signum)
+{
+	(void) signum;
+	daemon_quit = 1;
+}
+
+/* Only ever remove a socket, in case the path given
+ * with --socket names some other file by mistake */
+static int daemon_socket_remove(const char *socket_path)
+{
+	struct stat st;
+
+	if (lstat(socket_path, &st) < 0) {
+		return (errno == ENOENT) ? 0 : -errno;
+	}
+	if (!S_ISSOCK(st.st_mode)) {
+		loge("%s exists and is not a socket", socket_path);
+		return -EEXIST;
+	}
+	return unlink(socket_path) < 0 ? -errno : 0;
+}
+
+static int daemon_listen(const char *socket_path)
+{
+	struct sockaddr_un addr;
+	int sock;
+	int rc;
+
+	if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+		loge("socket path %s too long", socket_path);
+		return -EINVAL;
+	}
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) {
+		loge("could not create socket");
+		return -errno;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+	/* Remove stale socket left behind by a previous instance */
+	rc = daemon_socket_remove(socket_path);
+	if (rc < 0) {
+		goto out_close;
+	}
+	rc = bind(sock, (struct sockaddr*) &addr, sizeof(addr));
+	if (rc < 0) {
+		loge("could not bind to %s", socket_path);
+		goto out_close;
+	}
+	chmod(socket_path, 0660);
+	rc = listen(sock, SJA1105D_MAX_CLIENTS);
+	if (rc < 0) {
+		loge("could not listen on %s", socket_path);
+		goto out_close;
+	}
+	return sock;
+out_close:
+	close(sock);
+	return -1;
+}
+
+/* Returns 1 if a request was received, 0 on orderly
+ * client disconnect and negative on protocol error. */
+static int daemon_recv_request(int sock, struct sja1105d_request *request,
+                               char *payload, int *fds)
+{
+	char cmsg_buf[CMSG_SPACE(SJA1105D_NUM_FDS * sizeof(int))];
+	struct cmsghdr *cmsg;
+	struct msghdr msg;
+	struct iovec iov;
+	int fd_count = 0;
+	ssize_t len;
+	int rc;
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = request;
+	iov.iov_len  = sizeof(*request);
+	msg.msg_iov        = &iov;
+	msg.msg_iovlen     = 1;
+	msg.msg_control    = cmsg_buf;
+	msg.msg_controllen = sizeof(cmsg_buf);
+
+	len = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+	if (len == 0) {
+		return 0;
+	}
+	if (len < 0) {
+		return -errno;
+	}
+	for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+	     cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		if (cmsg->cmsg_level == SOL_SOCKET &&
+		    cmsg->cmsg_type == SCM_RIGHTS) {
+			fd_count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+			memcpy(fds, CMSG_DATA(cmsg),
+			       min(fd_count, SJA1105D_NUM_FDS) * sizeof(int));
+		}
+	}
+	if (len != sizeof(*request) || fd_count != SJA1105D_NUM_FDS ||
+	    (msg.msg_flags & MSG_CTRUNC) ||
+	    request->magic != SJA1105D_MAGIC ||
+	    request->argc > SJA1105D_MAX_ARGS ||
+	    request->len > SJA1105D_MAX_REQUEST) {
+		loge("malformed request");
+		rc = -EINVAL;
+		goto out_close_fds;
+	}
+	rc = reliable_recv(sock, payload, request->len);
+	if (rc < 0) {
+		logv("dropping client: incomplete request");
+		goto out_close_fds;
+	}
+	return 1;
+out_close_fds:
+	for (fd_count = min(fd_count, SJA1105D_NUM_FDS); fd_count > 0; ) {
+		close(fds[--fd_count]);
+	}
+	return rc;
+}
+
+/* Requests run one at a time inside the poll loop, so commands that
+ * only return once they are interrupted would hold up every other
+ * client for good. Returns why the request is refused, or NULL.
+ * Also applies to the lines of a batch run by the daemon. */
+const char *daemon_request_refused(int argc, char **argv)
+{
+	int i;
+
+	if (argc == 0 || argv[0][0] == '\0') {
+		return NULL;
+	}
+	if (matches(argv[0], "daemon") == 0) {
+		return "sja1105d is already running";
+	}
+	if (matches(argv[0], "exporter") == 0) {
+		return "the exporter cannot be run through sja1105d";
+	}
+	if (matches(argv[0], "status") == 0) {
+		for (i = 1; i < argc; i++) {
+			if (strcmp(argv[i], "--watch") == 0) {
+				return "status --watch cannot be run "
+				       "through sja1105d";
+			}
+		}
+	}
+	return NULL;
+}
+
+static int daemon_run_request(struct sja1105_spi_setup *spi_setup,
+                              struct sja1105d_request *request,
+                              char *payload, int *fds, int *saved_fds)
+{
+	struct sja1105_spi_setup request_setup;
+	char *argv[SJA1105D_MAX_ARGS];
+	const char *refused;
+	uint32_t argc = 0;
+	uint32_t i = 0;
+	int rc;
+
+	/* Split payload back into argv */
+	while (argc < request->argc && i < request->len) {
+		argv[argc++] = payload + i;
+		i += strnlen(payload + i, request->len - i) + 1;
+	}
+	if (argc != request->argc || i != request->len ||
+	    (request->len && payload[request->len - 1] != '\0')) {
+		loge("malformed request");
+		rc = -1;
+		sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+		return rc;
+	}
+	for (i = 0; i < SJA1105D_NUM_FDS; i++) {
+		dup2(fds[i], i);
+	}
+	refused = daemon_request_refused(argc, argv);
+	if (refused) {
+		loge("%s", refused);
+		rc = -1;
+		sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+	} else {
+		/* Options such as --flush are per-request */
+		request_setup = *spi_setup;
+		rc = parse_args(&request_setup, argc, argv);
+	}
+	fflush(stdout);
+	fflush(stderr);
+	for (i = 0; i < SJA1105D_NUM_FDS; i++) {
+		dup2(saved_fds[i], i);
+	}
+	return rc;
+}
+
+static int daemon_serve(struct sja1105_spi_setup *spi_setup, int sock,
+                        int *saved_fds)
+{
+	struct sja1105d_response response;
+	struct sja1105d_request request;
+	char payload[SJA1105D_MAX_REQUEST];
+	int fds[SJA1105D_NUM_FDS];
+	int rc;
+	int i;
+
+	rc = daemon_recv_request(sock, &request, payload, fds);
+	if (rc <= 0) {
+		return rc;
+	}
+	response.magic = SJA1105D_MAGIC;
+	response.rc = daemon_run_request(spi_setup, &request, payload,
+	                                 fds, saved_fds);
+	for (i = 0; i < SJA1105D_NUM_FDS; i++) {
+		close(fds[i]);
+	}
+	rc = reliable_send(sock, &response, sizeof(response));
+	return (rc < 0) ? rc : 1;
+}
+
+int daemon_parse_args(struct sja1105_spi_setup *spi_setup,
+                      int argc, char **argv)
+{
+	struct timeval recv_timeout = {
+		.tv_sec  = SJA1105D_RECV_TIMEOUT_MS / 1000,
+		.tv_usec = (SJA1105D_RECV_TIMEOUT_MS % 1000) * 1000,
+	};
+	struct pollfd pfds[SJA1105D_MAX_CLIENTS + 1];
+	const char *socket_path = SJA1105D_DEFAULT_SOCKET;
+	int saved_fds[SJA1105D_NUM_FDS];
+	int64_t deadline = -1;
+	uint64_t delay = SJA1105D_DEFAULT_DELAY;
+	struct sigaction sa;
+	int nfds = 1;
+	int timeout;
+	int listen_sock;
+	int rc = 0;
+	int i;
+
+	while (argc) {
+		if (argc >= 2 && (matches(argv[0], "-s") == 0 ||
+		                  matches(argv[0], "--socket") == 0)) {
+			socket_path = argv[1];
+		} else if (argc >= 2 && (matches(argv[0], "-d") == 0 ||
+		                         matches(argv[0], "--delay") == 0)) {
+			rc = reliable_uint64_from_string(&delay, argv[1], NULL);
+			if (rc < 0 || delay > INT32_MAX) {
+				loge("invalid delay %s", argv[1]);
+				goto parse_error;
+			}
+		} else {
+			goto parse_error;
+		}
+		argc -= 2; argv += 2;
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = daemon_signal_handler;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	for (i = 0; i < SJA1105D_NUM_FDS; i++) {
+		saved_fds[i] = dup(i);
+	}
+	rc = staging_area_resident_init(spi_setup->staging_area);
+	if (rc < 0) {
+		goto filesystem_error;
+	}
+	sysfs_fd_cache_enable();
+
+	listen_sock = daemon_listen(socket_path);
+	if (listen_sock < 0) {
+		rc = listen_sock;
+		goto filesystem_error_free;
+	}
+	pfds[0].fd     = listen_sock;
+	pfds[0].events = POLLIN;
+	logi("sja1105d listening on %s", socket_path);
+
+	while (!daemon_quit) {
+		if (staging_area_resident_dirty()) {
+			if (deadline < 0) {
+				deadline = monotonic_ms() + delay;
+			}
+			timeout = (int) (deadline - monotonic_ms());
+			if (timeout < 0) {
+				timeout = 0;
+			}
+		} else {
+			deadline = -1;
+			timeout  = -1;
+		}
+		rc = poll(pfds, nfds, timeout);
+		if (rc < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			loge("poll failed");
+			break;
+		}
+		if (rc == 0) {
+			/* Idle for long enough: write back staging area */
+			if (staging_area_resident_sync() < 0) {
+				loge("failed to write back staging area %s",
+				     spi_setup->staging_area);
+			}
+			deadline = -1;
+			continue;
+		}
+		for (i = nfds - 1; i > 0; i--) {
+			if (!pfds[i].revents) {
+				continue;
+			}
+			if (daemon_serve(spi_setup, pfds[i].fd, saved_fds) <= 0) {
+				close(pfds[i].fd);
+				pfds[i] = pfds[--nfds];
+			}
+		}
+		if (pfds[0].revents & POLLIN) {
+			rc = accept(listen_sock, NULL, NULL);
+			if (rc < 0) {
+				continue;
+			}
+			if (nfds == ARRAY_SIZE(pfds)) {
+				logv("too many clients");
+				close(rc);
+				continue;
+			}
+			/* Requests are served one at a time, so a client
+			 * that stalls halfway through one must not block
+			 * the daemon for good */
+			if (setsockopt(rc, SOL_SOCKET, SO_RCVTIMEO, &recv_timeout,
+			               sizeof(recv_timeout)) < 0) {
+				loge("could not set receive timeout");
+				close(rc);
+				continue;
+			}
+			pfds[nfds].fd     = rc;
+			pfds[nfds].events = POLLIN;
+			nfds++;
+		}
+	}
+	logi("sja1105d exiting");
+	rc = staging_area_resident_sync();
+	for (i = 1; i < nfds; i++) {
+		close(pfds[i].fd);
+	}
+	close(listen_sock);
+	daemon_socket_remove(socket_path);
+	sysfs_fd_cache_release();
+	staging_area_resident_free();
+	return rc;
+filesystem_error_free:
+	staging_area_resident_free();
+filesystem_error:
+	sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
+	return rc;
+parse_error:
+	rc = -1;
+	sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+	print_usage();
+	return rc;
+}
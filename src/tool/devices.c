@@ -0,0 +1,221 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "internal.h"
+
+struct sja1105_spi_setup *
+sja1105_device_lookup(struct sja1105_device_list *devices, const char *name)
+{
+	int i;
+
+	for (i = 0; i < devices->count; i++) {
+		if (strcmp(devices->devices[i].name, name) == 0) {
+			return &devices->devices[i];
+		}
+	}
+	loge("Device %s not found in config file", name);
+	return NULL;
+}
+
+struct flush_job {
+	struct sja1105_spi_setup *spi_setup;
+	pthread_t thread;
+	int       started;
+	int       rc;
+	double    seconds;
+};
+
+static void *flush_thread(void *arg)
+{
+	struct flush_job *job = arg;
+	struct timespec start, end;
+	char *value = "1";
+
+	staging_area_upload_forget(job->spi_setup->staging_area);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	/* Blocks for as long as the kernel driver takes to reset the
+	 * switch and upload the staging area to it */
+	job->rc = sysfs_write(job->spi_setup, "config_upload",
+	                      value, strlen(value));
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	if (job->rc >= 0) {
+		staging_area_upload_record(job->spi_setup->staging_area);
+	}
+	job->seconds = (end.tv_sec - start.tv_sec) +
+	               (end.tv_nsec - start.tv_nsec) / 1e9;
+	return NULL;
+}
+
+/* Upload the staging areas of several switches at once, each from its
+ * own thread, so that the network is down for about as long as the
+ * slowest upload instead of for the sum of them. The staging areas
+ * must already be on disk. Returns 0 if all uploads succeeded.
+ */
+int staging_area_flush_parallel(struct sja1105_spi_setup **setups, int count)
+{
+	struct flush_job *jobs;
+	int rc = 0;
+	int i;
+
+	jobs = calloc(count, sizeof(*jobs));
+	if (jobs == NULL) {
+		loge("malloc failed");
+		return -ENOMEM;
+	}
+	for (i = 0; i < count; i++) {
+		jobs[i].spi_setup = setups[i];
+		if (pthread_create(&jobs[i].thread, NULL, flush_thread,
+		                   &jobs[i]) != 0) {
+			/* Do it from here instead */
+			flush_thread(&jobs[i]);
+			continue;
+		}
+		jobs[i].started = 1;
+	}
+	for (i = 0; i < count; i++) {
+		if (jobs[i].started) {
+			pthread_join(jobs[i].thread, NULL);
+		}
+		if (jobs[i].rc < 0) {
+			printf("%s: upload failed after %.3f s\n",
+			       setups[i]->name, jobs[i].seconds);
+			if (rc == 0) {
+				rc = jobs[i].rc;
+			}
+		} else {
+			printf("%s: uploaded in %.3f s\n",
+			       setups[i]->name, jobs[i].seconds);
+		}
+	}
+	free(jobs);
+	return rc;
+}
+
+static int device_run(struct sja1105_spi_setup *spi_setup,
+                      int argc, char **argv)
+{
+	char **device_argv;
+	int rc;
+	int i;
+
+	/* Commands are free to modify their arguments (e.g. the
+	 * "[index]" of a table name), so each device gets a copy */
+	device_argv = calloc(argc + 1, sizeof(char*));
+	if (device_argv == NULL) {
+		loge("malloc failed");
+		return -ENOMEM;
+	}
+	for (i = 0; i < argc; i++) {
+		device_argv[i] = strdup(argv[i]);
+		if (device_argv[i] == NULL) {
+			loge("malloc failed");
+			rc = -ENOMEM;
+			goto out;
+		}
+	}
+	rc = parse_args(spi_setup, argc, device_argv);
+out:
+	for (i = 0; i < argc; i++) {
+		free(device_argv[i]);
+	}
+	free(device_argv);
+	return rc;
+}
+
+/* sja1105-tool --device all <command>: run the command for each of the
+ * named devices in turn, then perform all their uploads in parallel.
+ * A device whose command fails is not uploaded, but the others are.
+ */
+int devices_parse_args(struct sja1105_device_list *devices,
+                       int argc, char **argv)
+{
+	const char *not_allowed[] = {
+		"batch",
+		"daemon",
+		"exporter",
+	};
+	struct sja1105_spi_setup *pending[SJA1105_MAX_DEVICES];
+	struct sja1105_spi_setup *spi_setup;
+	int pending_count = 0;
+	int rc = 0;
+	int tmp;
+	int i;
+
+	if (devices->count == 0) {
+		loge("No [setup <name>] sections in config file");
+		rc = -EINVAL;
+		sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+		return rc;
+	}
+	for (i = 0; argc && i < (int) ARRAY_SIZE(not_allowed); i++) {
+		if (matches(argv[0], not_allowed[i]) == 0) {
+			loge("%s does not support --device all",
+			     not_allowed[i]);
+			rc = -EINVAL;
+			sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+			return rc;
+		}
+	}
+	for (i = 0; i < devices->count; i++) {
+		spi_setup = &devices->devices[i];
+		spi_setup->defer_flush = 1;
+		/* On stderr, so that --format json|csv|tsv output
+		 * stays machine-readable */
+		fflush(stdout);
+		fprintf(stderr, "[%s]\n", spi_setup->name);
+		tmp = device_run(spi_setup, argc, argv);
+		if (tmp < 0) {
+			loge("%s: %s", spi_setup->name,
+			     sja1105_err_code_to_string(-tmp));
+			if (rc == 0) {
+				rc = tmp;
+			}
+			continue;
+		}
+		if (spi_setup->flush_pending) {
+			pending[pending_count++] = spi_setup;
+		}
+	}
+	if (pending_count) {
+		tmp = staging_area_flush_parallel(pending, pending_count);
+		if (tmp < 0 && rc == 0) {
+			rc = tmp;
+			/* As for a single device */
+			sja1105_err_remap(rc, SJA1105_ERR_UPLOAD_FAILED_HW_LEFT_FLOATING_STAGING_AREA_DIRTY);
+		}
+	}
+	return rc;
+}
@@ -0,0 +1,548 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <string.h>
+#include <ctype.h>
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include "internal.h"
+
+/* Serves the switch status counters in the OpenMetrics text format
+ * over HTTP. The status is read by a separate thread once per
+ * period and rendered into a snapshot, so that a scrape only ever
+ * copies the latest snapshot and never waits for SPI.
+ */
+#define EXPORTER_DEFAULT_LISTEN "127.0.0.1:9105"
+#define EXPORTER_DEFAULT_PERIOD 1.0
+#define EXPORTER_PORT_COUNT     5
+#define EXPORTER_MAX_REQUEST    4096
+#define EXPORTER_TIMEOUT_MS     1000
+#define EXPORTER_CONTENT_TYPE \
+	"application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+struct exporter_buf {
+	char  *data;
+	size_t len;
+	size_t size;
+};
+
+static struct {
+	pthread_mutex_t    lock;
+	/* Latest complete snapshot, swapped with the one being built */
+	struct exporter_buf front;
+	struct exporter_buf back;
+	struct sja1105_spi_setup *spi_setup;
+	double period;
+} exporter = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static volatile sig_atomic_t exporter_quit;
+
+static void print_usage()
+{
+	printf("Usage: sja1105-tool exporter [-l|--listen <address>] [-p|--period <seconds>]\n");
+	printf("Serve the switch status counters in OpenMetrics format over HTTP.\n");
+	printf("<address> is [<ip>:]<port> or unix:<path>, default %s.\n",
+	       EXPORTER_DEFAULT_LISTEN);
+	printf("The counters are read every <seconds> (default %g) and\n",
+	       EXPORTER_DEFAULT_PERIOD);
+	printf("scrapes are served from the latest readout.\n");
+}
+
+static void exporter_signal_handler(int signum)
+{
+	(void) signum;
+	exporter_quit = 1;
+}
+
+static int buf_printf(struct exporter_buf *buf, const char *fmt, ...)
+{
+	va_list args;
+	size_t size;
+	char *data;
+	int rc;
+
+	while (1) {
+		va_start(args, fmt);
+		rc = vsnprintf(buf->data + buf->len, buf->size - buf->len,
+		               fmt, args);
+		va_end(args);
+		if (rc < 0) {
+			return -EINVAL;
+		}
+		if ((size_t) rc < buf->size - buf->len) {
+			buf->len += rc;
+			return 0;
+		}
+		/* Grown once, then reused for every refresh */
+		size = buf->size ? 2 * buf->size : 4 * MAX_LINE_SIZE;
+		data = realloc(buf->data, size);
+		if (data == NULL) {
+			loge("realloc failed");
+			return -ENOMEM;
+		}
+		buf->data = data;
+		buf->size = size;
+	}
+}
+
+/* Status field names ending in "_<queue>" are the
+ * per-queue instances of a single metric family */
+static int metric_queue_split(const char *name, char *family, size_t len)
+{
+	const char *p = strrchr(name, '_');
+	int queue;
+
+	if (strncmp(name, "qlevel", strlen("qlevel")) != 0 || p == NULL ||
+	    sscanf(p + 1, "%d", &queue) != 1) {
+		snprintf(family, len, "%s", name);
+		return -1;
+	}
+	snprintf(family, len, "%.*s", (int) (p - name), name);
+	return queue;
+}
+
+/* Diagnostic counters start with "n_", everything
+ * else is a flag or a level */
+static int metric_is_counter(const char *name)
+{
+	return strncmp(name, "n_", 2) == 0;
+}
+
+/* The metric names come from the field names of the kernel module,
+ * which are lowercased by status_fields_parse(). Anything that is
+ * not a plain identifier is not a status field and is left out,
+ * rather than being exported under a made-up name. */
+static int metric_name_valid(const char *name)
+{
+	const char *p;
+
+	if (!islower((unsigned char) name[0])) {
+		return 0;
+	}
+	for (p = name; *p; p++) {
+		if (!islower((unsigned char) *p) &&
+		    !isdigit((unsigned char) *p) && *p != '_') {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void
+metric_family(struct exporter_buf *buf, const char *prefix,
+              const char *family, int counter)
+{
+	buf_printf(buf, "# TYPE sja1105_%s_%s %s\n", prefix, family,
+	           counter ? "counter" : "gauge");
+}
+
+static void
+metric_sample(struct exporter_buf *buf, const char *prefix,
+              const char *family, int counter, int port, int queue,
+              uint64_t value)
+{
+	buf_printf(buf, "sja1105_%s_%s%s", prefix, family,
+	           counter ? "_total" : "");
+	if (port >= 0 && queue >= 0) {
+		buf_printf(buf, "{port=\"%d\",queue=\"%d\"}", port, queue);
+	} else if (port >= 0) {
+		buf_printf(buf, "{port=\"%d\"}", port);
+	}
+	buf_printf(buf, " %" PRIu64 "\n", value);
+}
+
+static int exporter_render(struct exporter_buf *buf)
+{
+	static struct sja1105_status_fields ports[EXPORTER_PORT_COUNT];
+	struct sja1105_status_fields general;
+	char family[SJA1105_STATUS_NAME_SIZE];
+	char other[SJA1105_STATUS_NAME_SIZE];
+	uint8_t done[SJA1105_STATUS_MAX_FIELDS];
+	struct timespec now;
+	int queue;
+	int counter;
+	int rc;
+	int i, j, k;
+
+	buf->len = 0;
+	rc = sja1105_general_status_read(exporter.spi_setup, &general);
+	for (i = 0; rc == 0 && i < EXPORTER_PORT_COUNT; i++) {
+		rc = sja1105_port_status_read(exporter.spi_setup, i, &ports[i]);
+	}
+	buf_printf(buf, "# TYPE sja1105_up gauge\n");
+	buf_printf(buf, "sja1105_up %d\n", (rc == 0));
+	clock_gettime(CLOCK_REALTIME, &now);
+	buf_printf(buf, "# TYPE sja1105_last_refresh_timestamp_seconds gauge\n");
+	buf_printf(buf, "sja1105_last_refresh_timestamp_seconds %ld.%03ld\n",
+	           (long) now.tv_sec, now.tv_nsec / 1000000);
+	if (rc < 0) {
+		goto out;
+	}
+	for (i = 0; i < general.count; i++) {
+		if (!metric_name_valid(general.names[i])) {
+			logv("not exporting status field %s", general.names[i]);
+			continue;
+		}
+		metric_family(buf, "general", general.names[i], 0);
+		metric_sample(buf, "general", general.names[i], 0, -1, -1,
+		              general.values[i]);
+	}
+	/* OpenMetrics wants all samples of a family together. The kernel
+	 * module reports the same fields, in the same order, for all
+	 * ports, but the queues of a family need not be adjacent.
+	 * Port 0 names the fields, and a sample of another port is
+	 * only exported if its field has the same name. */
+	memset(done, 0, sizeof(done));
+	for (j = 0; j < ports[0].count; j++) {
+		if (done[j]) {
+			continue;
+		}
+		if (!metric_name_valid(ports[0].names[j])) {
+			logv("not exporting status field %s", ports[0].names[j]);
+			continue;
+		}
+		metric_queue_split(ports[0].names[j], family, sizeof(family));
+		counter = metric_is_counter(family);
+		metric_family(buf, "port", family, counter);
+		for (k = j; k < ports[0].count; k++) {
+			queue = metric_queue_split(ports[0].names[k], other,
+			                           sizeof(other));
+			if (strcmp(family, other) != 0) {
+				continue;
+			}
+			done[k] = 1;
+			for (i = 0; i < EXPORTER_PORT_COUNT; i++) {
+				if (k < ports[i].count &&
+				    strcmp(ports[i].names[k],
+				           ports[0].names[k]) == 0) {
+					metric_sample(buf, "port", family,
+					              counter, i, queue,
+					              ports[i].values[k]);
+				}
+			}
+		}
+	}
+out:
+	buf_printf(buf, "# EOF\n");
+	return rc;
+}
+
+static void exporter_refresh(void)
+{
+	struct exporter_buf tmp;
+
+	if (exporter_render(&exporter.back) < 0) {
+		logv("failed to read switch status");
+	}
+	pthread_mutex_lock(&exporter.lock);
+	tmp = exporter.front;
+	exporter.front = exporter.back;
+	exporter.back = tmp;
+	pthread_mutex_unlock(&exporter.lock);
+}
+
+static void *exporter_refresh_thread(void *arg)
+{
+	struct timespec next;
+	long long nsec;
+
+	(void) arg;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	while (!exporter_quit) {
+		nsec = next.tv_nsec + (long long) (exporter.period * 1e9);
+		next.tv_sec  += nsec / 1000000000;
+		next.tv_nsec  = nsec % 1000000000;
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+		                       &next, NULL) == EINTR) {
+			if (exporter_quit) {
+				return NULL;
+			}
+		}
+		exporter_refresh();
+	}
+	return NULL;
+}
+
+static int exporter_listen(const char *address)
+{
+	struct sockaddr_un un;
+	struct sockaddr_in in;
+	struct sockaddr *addr;
+	socklen_t addr_len;
+	const char *port_str;
+	char host[64] = "127.0.0.1";
+	char *end;
+	long port;
+	int one = 1;
+	int sock;
+
+	if (strncmp(address, "unix:", strlen("unix:")) == 0) {
+		address += strlen("unix:");
+		if (strlen(address) >= sizeof(un.sun_path)) {
+			loge("socket path %s too long", address);
+			return -EINVAL;
+		}
+		memset(&un, 0, sizeof(un));
+		un.sun_family = AF_UNIX;
+		snprintf(un.sun_path, sizeof(un.sun_path), "%s", address);
+		/* Remove stale socket left behind by a previous instance */
+		unlink(address);
+		addr = (struct sockaddr*) &un;
+		addr_len = sizeof(un);
+	} else {
+		port_str = strrchr(address, ':');
+		if (port_str != NULL) {
+			snprintf(host, sizeof(host), "%.*s",
+			         (int) (port_str - address), address);
+			port_str++;
+		} else {
+			port_str = address;
+		}
+		port = strtol(port_str, &end, 10);
+		memset(&in, 0, sizeof(in));
+		in.sin_family = AF_INET;
+		in.sin_port   = htons(port);
+		if (*end != '\0' || port <= 0 || port > 65535 ||
+		    inet_pton(AF_INET, host, &in.sin_addr) != 1) {
+			loge("invalid listen address %s", address);
+			return -EINVAL;
+		}
+		addr = (struct sockaddr*) &in;
+		addr_len = sizeof(in);
+	}
+	sock = socket(addr->sa_family, SOCK_STREAM, 0);
+	if (sock < 0) {
+		loge("could not create socket");
+		return -errno;
+	}
+	setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	if (bind(sock, addr, addr_len) < 0 || listen(sock, 16) < 0) {
+		loge("could not listen on %s", address);
+		close(sock);
+		return -1;
+	}
+	return sock;
+}
+
+static int send_all(int fd, const char *p, size_t len)
+{
+	ssize_t rc;
+
+	while (len) {
+		rc = send(fd, p, len, MSG_NOSIGNAL);
+		if (rc < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -errno;
+		}
+		p   += rc;
+		len -= rc;
+	}
+	return 0;
+}
+
+/* Reads the request headers, without letting a stalled
+ * client hold up the next scrape for too long */
+static int exporter_recv_request(int fd, char *buf, size_t size)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	size_t len = 0;
+	ssize_t rc;
+
+	while (len < size - 1) {
+		if (poll(&pfd, 1, EXPORTER_TIMEOUT_MS) <= 0) {
+			return -ETIMEDOUT;
+		}
+		rc = recv(fd, buf + len, size - 1 - len, 0);
+		if (rc <= 0) {
+			return -EPIPE;
+		}
+		len += rc;
+		buf[len] = '\0';
+		if (strstr(buf, "\r\n\r\n") || strstr(buf, "\n\n")) {
+			return 0;
+		}
+	}
+	return -E2BIG;
+}
+
+static void exporter_serve(int fd, struct exporter_buf *copy)
+{
+	char request[EXPORTER_MAX_REQUEST];
+	char header[256];
+	const char *status = "200 OK";
+	size_t size;
+	char *data;
+	int len;
+
+	if (exporter_recv_request(fd, request, sizeof(request)) < 0) {
+		return;
+	}
+	if (strncmp(request, "GET /metrics ", strlen("GET /metrics ")) != 0 &&
+	    strncmp(request, "GET / ", strlen("GET / ")) != 0) {
+		status = "404 Not Found";
+		copy->len = 0;
+	} else {
+		/* Only hold the lock for as long as the copy takes */
+		pthread_mutex_lock(&exporter.lock);
+		if (copy->size < exporter.front.len) {
+			size = exporter.front.size;
+			data = realloc(copy->data, size);
+			if (data == NULL) {
+				pthread_mutex_unlock(&exporter.lock);
+				loge("realloc failed");
+				return;
+			}
+			copy->data = data;
+			copy->size = size;
+		}
+		memcpy(copy->data, exporter.front.data, exporter.front.len);
+		copy->len = exporter.front.len;
+		pthread_mutex_unlock(&exporter.lock);
+	}
+	len = snprintf(header, sizeof(header),
+	               "HTTP/1.0 %s\r\n"
+	               "Content-Type: " EXPORTER_CONTENT_TYPE "\r\n"
+	               "Content-Length: %zu\r\n"
+	               "Connection: close\r\n\r\n", status, copy->len);
+	if (send_all(fd, header, len) == 0 && copy->len) {
+		send_all(fd, copy->data, copy->len);
+	}
+}
+
+int exporter_parse_args(struct sja1105_spi_setup *spi_setup,
+                        int argc, char **argv)
+{
+	const char *address = EXPORTER_DEFAULT_LISTEN;
+	struct exporter_buf copy = { NULL, 0, 0 };
+	struct pollfd pfd;
+	struct sigaction sa;
+	pthread_t thread;
+	char *endptr;
+	int listen_sock;
+	int fd;
+	int rc = 0;
+
+	exporter.period = EXPORTER_DEFAULT_PERIOD;
+	while (argc) {
+		if (argc >= 2 && (matches(argv[0], "-l") == 0 ||
+		                  matches(argv[0], "--listen") == 0)) {
+			address = argv[1];
+		} else if (argc >= 2 && (matches(argv[0], "-p") == 0 ||
+		                         matches(argv[0], "--period") == 0)) {
+			rc = reliable_double_from_string(&exporter.period,
+			                                 argv[1], &endptr);
+			if (rc < 0 || *endptr != '\0' || exporter.period < 0.01) {
+				loge("invalid period %s", argv[1]);
+				goto parse_error;
+			}
+		} else {
+			goto parse_error;
+		}
+		argc -= 2; argv += 2;
+	}
+	exporter.spi_setup = spi_setup;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = exporter_signal_handler;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	listen_sock = exporter_listen(address);
+	if (listen_sock < 0) {
+		rc = listen_sock;
+		goto filesystem_error;
+	}
+	/* Keep the sysfs files open in between refreshes */
+	sysfs_fd_cache_enable();
+	/* Have a snapshot ready before the first scrape */
+	exporter_refresh();
+	rc = pthread_create(&thread, NULL, exporter_refresh_thread, NULL);
+	if (rc) {
+		loge("could not create refresh thread");
+		rc = -rc;
+		sysfs_fd_cache_release();
+		close(listen_sock);
+		goto filesystem_error;
+	}
+	logi("sja1105-tool exporter listening on %s", address);
+
+	pfd.fd     = listen_sock;
+	pfd.events = POLLIN;
+	while (!exporter_quit) {
+		if (poll(&pfd, 1, EXPORTER_TIMEOUT_MS) <= 0) {
+			continue;
+		}
+		fd = accept(listen_sock, NULL, NULL);
+		if (fd < 0) {
+			continue;
+		}
+		exporter_serve(fd, &copy);
+		close(fd);
+	}
+	exporter_quit = 1;
+	pthread_kill(thread, SIGTERM);
+	pthread_join(thread, NULL);
+	close(listen_sock);
+	if (strncmp(address, "unix:", strlen("unix:")) == 0) {
+		unlink(address + strlen("unix:"));
+	}
+	sysfs_fd_cache_release();
+	free(copy.data);
+	free(exporter.front.data);
+	free(exporter.back.data);
+	return 0;
+filesystem_error:
+	sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
+	return rc;
+parse_error:
+	rc = -1;
+	sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+	print_usage();
+	return rc;
+}
@@ -59,12 +59,20 @@ enum sja1105_default_staging_area {
 int sja1105_default_staging_area(struct sja1105_staging_area*,
                                  enum sja1105_default_staging_area);
 
+enum sja1105_output_format {
+	SJA1105_OUTPUT_TEXT = 0,
+	SJA1105_OUTPUT_JSON,
+	SJA1105_OUTPUT_CSV,
+	SJA1105_OUTPUT_TSV,
+};
+
 struct general_config {
 	char *staging_area;
 	int   screen_width;
 	int   entries_per_line;
 	int   verbose;
 	int   debug;
+	int   fsync;
 };
 
 struct sja1105_spi_setup {
@@ -73,6 +81,17 @@ struct sja1105_spi_setup {
 	const char *device;
 	const char *staging_area;
 	int         flush;
+	const char *name;          /* NULL for the [setup] section */
+	int         defer_flush;   /* Leave the upload to the caller... */
+	int         flush_pending; /* ...which then finds this set */
+};
+
+/* The [setup <name>] sections of sja1105.conf, one per switch */
+#define SJA1105_MAX_DEVICES 8
+
+struct sja1105_device_list {
+	int count;
+	struct sja1105_spi_setup devices[SJA1105_MAX_DEVICES];
 };
 
 /* defined in src/tool/sja1105-config.c */
@@ -80,25 +99,274 @@ extern struct general_config general_config;
 extern int SJA1105_VERBOSE_CONDITION;
 extern int SJA1105_DEBUG_CONDITION;
 
-int read_config_file(char*, struct sja1105_spi_setup*, struct general_config*);
+int read_config_file(char*, struct sja1105_spi_setup*,
+                     struct sja1105_device_list*, struct general_config*);
+int parse_args(struct sja1105_spi_setup*, int argc, char **argv);
 int config_parse_args(struct sja1105_spi_setup*, int argc, char **argv);
 int status_parse_args(struct sja1105_spi_setup*, int argc, char **argv);
 int reg_parse_args(struct sja1105_spi_setup*, int argc, char **argv);
+int batch_parse_args(struct sja1105_spi_setup*, int argc, char **argv);
+int daemon_parse_args(struct sja1105_spi_setup*, int argc, char **argv);
+int daemon_client_run(const char *socket_path, int argc, char **argv);
+const char *daemon_request_refused(int argc, char **argv);
+int exporter_parse_args(struct sja1105_spi_setup*, int argc, char **argv);
+int schedule_parse_args(struct sja1105_spi_setup*, int argc, char **argv);
+int devices_parse_args(struct sja1105_device_list*, int argc, char **argv);
+struct sja1105_spi_setup *
+sja1105_device_lookup(struct sja1105_device_list*, const char *name);
 int staging_area_modify(struct sja1105_staging_area*, char*, char*, char*);
 int staging_area_modify_parse(struct sja1105_staging_area*,
                               int *argc, char ***argv);
-int sja1105_staging_area_show(struct sja1105_staging_area*, char *table_name);
+int staging_area_policer_set(struct sja1105_staging_area*,
+                             int argc, char **argv);
+/* L2 policer RATE is in units of 1/64 Mbps (15.625 Kbps) */
+#define SJA1105_POLICER_RATE_PER_MBPS 64
+int sja1105_l2_policing_check(struct sja1105_static_config*);
+int sja1105_staging_area_generate(const char *spec_file,
+                                  struct sja1105_staging_area*);
+int sja1105_staging_area_from_json(const char *json_file,
+                                   struct sja1105_staging_area*);
+int sja1105_staging_area_to_json(const char *json_file,
+                                 struct sja1105_staging_area*);
+void get_flush_mode(struct sja1105_spi_setup*, int *force,
+                    int *argc, char ***argv);
+int staging_area_save_needed(struct sja1105_spi_setup*,
+                             struct sja1105_staging_area*, int force);
+int sja1105_staging_area_show(struct sja1105_staging_area*, char *table_name,
+                              const char *where,
+                              enum sja1105_output_format);
+
+int sja1105_staging_area_diff(const char *file_a, const char *file_b,
+                              enum sja1105_output_format);
 
 int staging_area_load(const char*, struct sja1105_staging_area*);
 int staging_area_save(const char*, struct sja1105_staging_area*);
 int staging_area_flush(struct sja1105_spi_setup*);
+int staging_area_flush_parallel(struct sja1105_spi_setup**, int count);
 int staging_area_hexdump(const char*);
+int staging_area_fingerprint(struct sja1105_staging_area*, uint64_t*);
+int staging_area_unchanged(const char*, struct sja1105_staging_area*);
+int staging_area_uploaded(const char*, struct sja1105_staging_area*);
+void staging_area_upload_forget(const char*);
+void staging_area_upload_record(const char*);
+void staging_area_packed_drop(void);
+int staging_area_resident_init(const char*);
+int staging_area_resident_active(void);
+int staging_area_resident_dirty(void);
+int staging_area_resident_sync(void);
+void staging_area_resident_free(void);
 
 /* From src/tool/tool-sysfs-file.c */
 int sysfs_read(struct sja1105_spi_setup *spi_setup, char* name,
                char* buf, size_t len);
 int sysfs_write(struct sja1105_spi_setup *spi_setup, char* name,
                 char* buf, size_t len);
+ssize_t sysfs_read_at(struct sja1105_spi_setup *spi_setup, char *name,
+                      char *buf, size_t len, off_t offset);
+ssize_t sysfs_write_at(struct sja1105_spi_setup *spi_setup, char *name,
+                       char *buf, size_t len, off_t offset);
+void sysfs_fd_cache_enable(void);
+void sysfs_fd_cache_release(void);
+
+#define SJA1105D_DEFAULT_SOCKET "/var/run/sja1105d.sock"
+
+/* From src/tool/parse-status.c */
+#define SJA1105_STATUS_MAX_FIELDS 64
+#define SJA1105_STATUS_NAME_SIZE  24
+
+struct sja1105_status_fields {
+	int      count;
+	char     names[SJA1105_STATUS_MAX_FIELDS][SJA1105_STATUS_NAME_SIZE];
+	uint64_t values[SJA1105_STATUS_MAX_FIELDS];
+};
+
+int sja1105_general_status_read(struct sja1105_spi_setup*,
+                                struct sja1105_status_fields*);
+int sja1105_port_status_read(struct sja1105_spi_setup*, int port,
+                             struct sja1105_status_fields*);
+int sja1105_status_field_index(struct sja1105_status_fields*,
+                               const char *name);
+
+/* From src/tool/status-watch.c */
+int status_ports_watch(struct sja1105_spi_setup*, int port_no,
+                       double interval, enum sja1105_output_format);
+
+/* From src/tool/config-fields.c */
+
+/* Shown as a MAC address */
+#define SJA1105_FIELD_MAC      (1 << 0)
+/* Not part of the XML schema */
+#define SJA1105_FIELD_NO_XML   (1 << 1)
+/* Neither shown, modifiable nor exported */
+#define SJA1105_FIELD_INTERNAL (1 << 2)
+
+#define SJA1105_MAX_FIELD_COUNT 32
+#define SJA1105_MAX_FIELD_ARRAY 8
+
+struct sja1105_field {
+	const char *name;
+	size_t      offset;     /* Inside the table entry structure */
+	int         count;      /* Array elements, 1 for scalars */
+	int         width_et;   /* Bits in hardware, 0 if absent on E/T */
+	int         width_pqrs; /* Bits in hardware, 0 if absent on P/Q/R/S */
+	int         flags;
+	/* The field only exists when the field with index cond_field
+	 * in the same table equals cond_value. -1 if unconditional. */
+	int         cond_field;
+	uint64_t    cond_value;
+};
+
+struct sja1105_table {
+	const char *name;
+	const char *description;
+	char       *show_fmt;
+	/* "config show" title and entry printer (from libsja1105),
+	 * which keep the text layout of each table as it always was */
+	const char *show_name;
+	void      (*fmt_show)(char*, size_t, char*, void*);
+	size_t      entries_offset;
+	size_t      count_offset;
+	size_t      entry_size;
+	int         max_count;
+	/* NULL for tables the tool does not implement */
+	const struct sja1105_field *fields;
+	int         field_count;
+};
+
+extern const struct sja1105_table sja1105_tables[];
+extern const int sja1105_table_count;
+
+const struct sja1105_table *sja1105_table_lookup(const char *name);
+const struct sja1105_field *
+sja1105_field_lookup(const struct sja1105_table*, const char *name);
+int sja1105_field_index(const struct sja1105_table*, const char *name);
+int  *sja1105_table_count_get(const struct sja1105_table*,
+                              struct sja1105_static_config*);
+void *sja1105_table_entry_get(const struct sja1105_table*,
+                              struct sja1105_static_config*, int index);
+uint64_t *sja1105_field_get(const struct sja1105_field*, void *entry);
+int sja1105_field_width(const struct sja1105_field*, uint64_t device_id);
+int sja1105_field_present(const struct sja1105_table*,
+                          const struct sja1105_field*, void *entry);
+int sja1105_field_check(const struct sja1105_field*, uint64_t device_id,
+                        uint64_t *values);
+int sja1105_static_config_check(struct sja1105_static_config*);
+
+/* From src/tool/config-query.c */
+struct sja1105_query;
+struct sja1105_query *
+sja1105_query_compile(const struct sja1105_table*, const char *expr);
+int  sja1105_query_run(struct sja1105_query*, struct sja1105_static_config*,
+                       uint8_t *match);
+void sja1105_query_free(struct sja1105_query*);
+
+/* From src/tool/output-format.c */
+/* Worst case record: every field of a table being a full array */
+#define SJA1105_OUTPUT_BUF_SIZE \
+	(SJA1105_MAX_FIELD_COUNT * (SJA1105_MAX_FIELD_ARRAY + 1) * 24)
+
+struct sja1105_output {
+	enum sja1105_output_format format;
+	const char *section;
+	const char *section_column;
+	int    depth;
+	int    items[4];     /* JSON members emitted at each depth */
+	int    row_open;
+	int    fields;       /* CSV cells emitted in the current row */
+	int    rows;
+	int    header_done;
+	int    compact;      /* JSON on a single line */
+	size_t header_len;
+	size_t len;
+	/* Reused for every record */
+	char   buf[SJA1105_OUTPUT_BUF_SIZE];
+	char   header[MAX_LINE_SIZE];
+};
+
+int  sja1105_output_format_get(int *argc, char ***argv,
+                               enum sja1105_output_format*);
+void sja1105_output_begin(struct sja1105_output*, enum sja1105_output_format);
+void sja1105_output_end(struct sja1105_output*);
+void sja1105_output_section_begin(struct sja1105_output*, const char *name,
+                                  const char *column);
+void sja1105_output_section_end(struct sja1105_output*);
+void sja1105_output_record_begin(struct sja1105_output*);
+void sja1105_output_record_end(struct sja1105_output*);
+void sja1105_output_u64(struct sja1105_output*, const char *name, uint64_t);
+void sja1105_output_str(struct sja1105_output*, const char *name,
+                        const char *value);
+void sja1105_output_mac(struct sja1105_output*, const char *name, uint64_t);
+void sja1105_output_array(struct sja1105_output*, const char *name,
+                          uint64_t *values, int count);
+void sja1105_output_none(struct sja1105_output*, const char *name);
+
+/* From src/tool/profile.c */
+extern int sja1105_profile_enabled;
+void sja1105_profile_enable(enum sja1105_output_format);
+void sja1105_profile_report(void);
+int  __sja1105_profile_begin(const char *phase, const char *detail);
+void __sja1105_profile_end(int id);
+
+/* Time a phase of the run. Only a load and a branch when --profile
+ * is not given. The id returned by begin is passed back to end.
+ */
+static inline int sja1105_profile_begin(const char *phase, const char *detail)
+{
+	if (!sja1105_profile_enabled) {
+		return -1;
+	}
+	return __sja1105_profile_begin(phase, detail);
+}
+
+static inline void sja1105_profile_end(int id)
+{
+	if (id >= 0) {
+		__sja1105_profile_end(id);
+	}
+}
+
+/* From src/tool/json.c */
+enum sja1105_json_type {
+	SJA1105_JSON_OBJECT,
+	SJA1105_JSON_ARRAY,
+	SJA1105_JSON_STRING,
+	SJA1105_JSON_PRIMITIVE,
+};
+
+struct sja1105_json_token {
+	enum sja1105_json_type type;
+	/* Offsets of the text in the buffer, without quotes for strings */
+	int start;
+	int end;
+	/* Members of an object, elements of an array */
+	int size;
+	/* Index of the first token after this one's subtree */
+	int next;
+	int parent;
+	int line;
+};
+
+struct sja1105_json {
+	const char *name;
+	const char *buf;
+	char *data;
+	struct sja1105_json_token *tokens;
+	int count;
+	int capacity;
+};
+
+int  sja1105_json_parse(struct sja1105_json*, const char *buf, size_t len);
+int  sja1105_json_load(struct sja1105_json*, const char *file_name);
+void sja1105_json_free(struct sja1105_json*);
+int  sja1105_json_child(struct sja1105_json*, int token);
+int  sja1105_json_sibling(struct sja1105_json*, int token);
+int  sja1105_json_member(struct sja1105_json*, int object, const char *name);
+int  sja1105_json_eq(struct sja1105_json*, int token, const char *str);
+int  sja1105_json_string(struct sja1105_json*, int token,
+                         char *buf, size_t len);
+int  sja1105_json_u64(struct sja1105_json*, int token, uint64_t*);
+int  sja1105_json_fixed(struct sja1105_json*, int token, uint64_t scale,
+                        uint64_t *value, int *rounded);
 
 /* From strings.c, mainly */
 
@@ -114,6 +382,9 @@ int sysfs_write(struct sja1105_spi_setup *spi_setup, char* name,
 #define SJA1105_ERR_STAGING_AREA_INVALID                              7
 #define SJA1105_ERR_INVALID_XML                                       8
 #define SJA1105_ERR_FILESYSTEM                                        9
+/* "config diff" found changes. Same value as SJA1105_ERR_USAGE, so that
+ * the exit code is that of diff(1). */
+#define SJA1105_ERR_CONFIG_DIFFERS                                    1
 
 const char *sja1105_err_code_to_string(int rc);
 
@@ -125,8 +396,11 @@ int   get_entry_count_to_fit_screen(char **print_bufs, int count);
 void  show_print_bufs(char **print_bufs, int count);
 void  linewise_concat(char **buffers, int count);
 int   read_array(char *array_str, uint64_t *array_val, int max_count);
+int   read_index_list(const char *list, uint8_t *selected, int max);
 int   reliable_uint64_from_string(uint64_t *to, char *from, char**);
 int   reliable_double_from_string(double *to, char *from, char**);
+int   reliable_fixed_from_string(uint64_t *to, const char *from,
+                                 uint64_t scale, int *rounded);
 
 
 #define TOOL_DEFINE_HEADERS_FOR_CONFIG_TABLE(table)                           \
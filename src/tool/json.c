@@ -0,0 +1,498 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include "internal.h"
+
+/* A small JSON tokenizer in the spirit of jsmn: the document is parsed
+ * once into a flat array of tokens that point back into the text, and
+ * values are only converted when they are looked up. Every token also
+ * records the index of the token following its subtree, so that the
+ * members of an object or the elements of an array can be walked
+ * without recursion.
+ */
+#define JSON_MAX_DEPTH 64
+
+struct json_parser {
+	struct sja1105_json *json;
+	const char *p;
+	const char *end;
+	int line;
+	int depth;
+};
+
+static int json_error(struct json_parser *parser, const char *what)
+{
+	loge("%s:%d: %s", parser->json->name, parser->line, what);
+	return -EINVAL;
+}
+
+static void json_skip_space(struct json_parser *parser)
+{
+	for (; parser->p < parser->end && isspace(*parser->p); parser->p++) {
+		if (*parser->p == '\n') {
+			parser->line++;
+		}
+	}
+}
+
+static int json_token_new(struct json_parser *parser,
+                          enum sja1105_json_type type, int parent)
+{
+	struct sja1105_json *json = parser->json;
+	struct sja1105_json_token *tokens;
+	struct sja1105_json_token *token;
+	int capacity;
+
+	if (json->count == json->capacity) {
+		capacity = json->capacity ? 2 * json->capacity : 64;
+		tokens = realloc(json->tokens, capacity * sizeof(*tokens));
+		if (tokens == NULL) {
+			loge("malloc failed");
+			return -ENOMEM;
+		}
+		json->tokens = tokens;
+		json->capacity = capacity;
+	}
+	token = &json->tokens[json->count];
+	memset(token, 0, sizeof(*token));
+	token->type   = type;
+	token->parent = parent;
+	token->line   = parser->line;
+	token->start  = parser->p - json->buf;
+	return json->count++;
+}
+
+static int json_parse_string(struct json_parser *parser, int parent)
+{
+	struct sja1105_json_token *token;
+	int index;
+	int i;
+
+	/* Opening quote */
+	parser->p++;
+	index = json_token_new(parser, SJA1105_JSON_STRING, parent);
+	if (index < 0) {
+		return index;
+	}
+	for (; parser->p < parser->end && *parser->p != '"'; parser->p++) {
+		if ((unsigned char) *parser->p < 0x20) {
+			return json_error(parser, "control character in string");
+		}
+		if (*parser->p != '\\') {
+			continue;
+		}
+		parser->p++;
+		if (parser->p == parser->end) {
+			break;
+		}
+		if (*parser->p == 'u') {
+			for (i = 0; i < 4; i++) {
+				parser->p++;
+				if (parser->p == parser->end ||
+				    !isxdigit(*parser->p)) {
+					return json_error(parser,
+					                  "invalid \\u escape");
+				}
+			}
+		} else if (!strchr("\"\\/bfnrt", *parser->p)) {
+			return json_error(parser, "invalid escape in string");
+		}
+	}
+	if (parser->p == parser->end) {
+		return json_error(parser, "unterminated string");
+	}
+	token = &parser->json->tokens[index];
+	token->end  = parser->p - parser->json->buf;
+	token->next = index + 1;
+	/* Closing quote */
+	parser->p++;
+	return index;
+}
+
+static int json_parse_primitive(struct json_parser *parser, int parent)
+{
+	struct sja1105_json_token *token;
+	const char *start = parser->p;
+	int len;
+	int index;
+
+	if (!strchr("-0123456789tfn", *parser->p)) {
+		return json_error(parser, "unexpected character");
+	}
+	while (parser->p < parser->end &&
+	       (isalnum(*parser->p) || strchr("+-.", *parser->p))) {
+		parser->p++;
+	}
+	len = parser->p - start;
+	if ((*start == 't' && (len != 4 || strncmp(start, "true", 4))) ||
+	    (*start == 'f' && (len != 5 || strncmp(start, "false", 5))) ||
+	    (*start == 'n' && (len != 4 || strncmp(start, "null", 4)))) {
+		return json_error(parser, "invalid literal");
+	}
+	parser->p = start;
+	index = json_token_new(parser, SJA1105_JSON_PRIMITIVE, parent);
+	if (index < 0) {
+		return index;
+	}
+	parser->p += len;
+	token = &parser->json->tokens[index];
+	token->end  = parser->p - parser->json->buf;
+	token->next = index + 1;
+	return index;
+}
+
+static int json_parse_value(struct json_parser *parser, int parent);
+
+/* Objects and arrays */
+static int json_parse_container(struct json_parser *parser, int parent)
+{
+	enum sja1105_json_type type;
+	int object = (*parser->p == '{');
+	char close = object ? '}' : ']';
+	int index;
+	int size = 0;
+	int rc;
+
+	if (++parser->depth > JSON_MAX_DEPTH) {
+		return json_error(parser, "nested too deeply");
+	}
+	type = object ? SJA1105_JSON_OBJECT : SJA1105_JSON_ARRAY;
+	index = json_token_new(parser, type, parent);
+	if (index < 0) {
+		return index;
+	}
+	parser->p++;
+	json_skip_space(parser);
+	if (parser->p < parser->end && *parser->p == close) {
+		goto out;
+	}
+	while (1) {
+		json_skip_space(parser);
+		if (object) {
+			if (parser->p == parser->end || *parser->p != '"') {
+				return json_error(parser, "expected member name");
+			}
+			rc = json_parse_string(parser, index);
+			if (rc < 0) {
+				return rc;
+			}
+			json_skip_space(parser);
+			if (parser->p == parser->end || *parser->p != ':') {
+				return json_error(parser, "expected ':'");
+			}
+			parser->p++;
+		}
+		rc = json_parse_value(parser, index);
+		if (rc < 0) {
+			return rc;
+		}
+		size++;
+		json_skip_space(parser);
+		if (parser->p < parser->end && *parser->p == ',') {
+			parser->p++;
+			continue;
+		}
+		if (parser->p < parser->end && *parser->p == close) {
+			break;
+		}
+		return json_error(parser, object ? "expected ',' or '}'" :
+		                                   "expected ',' or ']'");
+	}
+out:
+	/* Closing bracket */
+	parser->p++;
+	parser->depth--;
+	parser->json->tokens[index].size = size;
+	parser->json->tokens[index].end  = parser->p - parser->json->buf;
+	parser->json->tokens[index].next = parser->json->count;
+	return index;
+}
+
+static int json_parse_value(struct json_parser *parser, int parent)
+{
+	json_skip_space(parser);
+	if (parser->p == parser->end) {
+		return json_error(parser, "unexpected end of input");
+	}
+	if (*parser->p == '{' || *parser->p == '[') {
+		return json_parse_container(parser, parent);
+	} else if (*parser->p == '"') {
+		return json_parse_string(parser, parent);
+	}
+	return json_parse_primitive(parser, parent);
+}
+
+int sja1105_json_parse(struct sja1105_json *json, const char *buf,
+                       size_t len)
+{
+	struct json_parser parser = {
+		.json  = json,
+		.p     = buf,
+		.end   = buf + len,
+		.line  = 1,
+		.depth = 0,
+	};
+	int rc;
+
+	json->buf   = buf;
+	json->count = 0;
+	if (json->name == NULL) {
+		json->name = "<json>";
+	}
+	rc = json_parse_value(&parser, -1);
+	if (rc < 0) {
+		return rc;
+	}
+	json_skip_space(&parser);
+	if (parser.p != parser.end) {
+		return json_error(&parser, "trailing characters");
+	}
+	return 0;
+}
+
+/* Read a whole file ("-" is stdin) and parse it. The text is kept by
+ * the json object until sja1105_json_free. */
+int sja1105_json_load(struct sja1105_json *json, const char *file_name)
+{
+	size_t len = 0, size = 0;
+	char *tmp;
+	FILE *f;
+	int rc = 0;
+
+	memset(json, 0, sizeof(*json));
+	json->name = (strcmp(file_name, "-") == 0) ? "<stdin>" : file_name;
+	f = (strcmp(file_name, "-") == 0) ? stdin : fopen(file_name, "r");
+	if (f == NULL) {
+		loge("could not open %s", file_name);
+		return -errno;
+	}
+	do {
+		if (len == size) {
+			size = size ? 2 * size : 4096;
+			tmp = realloc(json->data, size);
+			if (tmp == NULL) {
+				loge("malloc failed");
+				rc = -ENOMEM;
+				goto out;
+			}
+			json->data = tmp;
+		}
+		len += fread(json->data + len, 1, size - len, f);
+	} while (!feof(f) && !ferror(f));
+	if (ferror(f)) {
+		loge("could not read %s", file_name);
+		rc = -EIO;
+		goto out;
+	}
+	rc = sja1105_json_parse(json, json->data, len);
+out:
+	if (f != stdin) {
+		fclose(f);
+	}
+	return rc;
+}
+
+void sja1105_json_free(struct sja1105_json *json)
+{
+	free(json->tokens);
+	free(json->data);
+	json->tokens = NULL;
+	json->data   = NULL;
+	json->count  = json->capacity = 0;
+}
+
+int sja1105_json_child(struct sja1105_json *json, int token)
+{
+	if (token < 0 || json->tokens[token].size == 0) {
+		return -1;
+	}
+	return token + 1;
+}
+
+int sja1105_json_sibling(struct sja1105_json *json, int token)
+{
+	int parent = json->tokens[token].parent;
+	int next = json->tokens[token].next;
+
+	if (parent >= 0 && json->tokens[parent].type == SJA1105_JSON_OBJECT) {
+		/* Skip over the value, to the next member name */
+		next = json->tokens[next].next;
+	}
+	if (parent < 0 || next >= json->tokens[parent].next) {
+		return -1;
+	}
+	return next;
+}
+
+/* Compare a string token with str */
+int sja1105_json_eq(struct sja1105_json *json, int token, const char *str)
+{
+	struct sja1105_json_token *t = &json->tokens[token];
+	size_t len = t->end - t->start;
+
+	return t->type == SJA1105_JSON_STRING && strlen(str) == len &&
+	       strncmp(json->buf + t->start, str, len) == 0;
+}
+
+int sja1105_json_member(struct sja1105_json *json, int object,
+                        const char *name)
+{
+	int key;
+
+	if (object < 0 || json->tokens[object].type != SJA1105_JSON_OBJECT) {
+		return -1;
+	}
+	for (key = sja1105_json_child(json, object); key >= 0;
+	     key = sja1105_json_sibling(json, key)) {
+		if (sja1105_json_eq(json, key, name)) {
+			return key + 1;
+		}
+	}
+	return -1;
+}
+
+static char json_unescape(char c)
+{
+	switch (c) {
+	case 'b': return '\b';
+	case 'f': return '\f';
+	case 'n': return '\n';
+	case 'r': return '\r';
+	case 't': return '\t';
+	default:  return c;
+	}
+}
+
+/* UTF-8 encoding of a \uXXXX escape */
+static int json_unescape_u(const char *hex, char *buf)
+{
+	unsigned int c = 0;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		c = c * 16 + (isdigit(hex[i]) ? hex[i] - '0' :
+		              tolower(hex[i]) - 'a' + 10);
+	}
+	if (c < 0x80) {
+		buf[0] = c;
+		return 1;
+	} else if (c < 0x800) {
+		buf[0] = 0xC0 | (c >> 6);
+		buf[1] = 0x80 | (c & 0x3F);
+		return 2;
+	}
+	buf[0] = 0xE0 | (c >> 12);
+	buf[1] = 0x80 | ((c >> 6) & 0x3F);
+	buf[2] = 0x80 | (c & 0x3F);
+	return 3;
+}
+
+/* Copy the text of a string or primitive token, with string escapes
+ * resolved, into buf. */
+int sja1105_json_string(struct sja1105_json *json, int token,
+                        char *buf, size_t len)
+{
+	struct sja1105_json_token *t = &json->tokens[token];
+	const char *p = json->buf + t->start;
+	const char *end = json->buf + t->end;
+	char utf8[3];
+	size_t i = 0;
+	int n, k;
+
+	if (t->type == SJA1105_JSON_OBJECT || t->type == SJA1105_JSON_ARRAY) {
+		loge("%s:%d: expected a string or number", json->name,
+		     t->line);
+		return -EINVAL;
+	}
+	for (; p < end; p++) {
+		n = 1;
+		if (*p != '\\') {
+			utf8[0] = *p;
+		} else if (*++p == 'u') {
+			/* Validated by the tokenizer */
+			n = json_unescape_u(p + 1, utf8);
+			p += 4;
+		} else {
+			utf8[0] = json_unescape(*p);
+		}
+		if (i + n >= len) {
+			loge("%s:%d: string too long", json->name, t->line);
+			return -E2BIG;
+		}
+		for (k = 0; k < n; k++) {
+			buf[i++] = utf8[k];
+		}
+	}
+	buf[i] = '\0';
+	return 0;
+}
+
+/* Numbers may be given either as JSON numbers or as strings */
+int sja1105_json_u64(struct sja1105_json *json, int token, uint64_t *value)
+{
+	char buf[MAX_LINE_SIZE];
+	char *end;
+	int rc;
+
+	rc = sja1105_json_string(json, token, buf, sizeof(buf));
+	if (rc < 0) {
+		return rc;
+	}
+	rc = reliable_uint64_from_string(value, buf, &end);
+	if (rc < 0 || *end) {
+		loge("%s:%d: expected an integer", json->name,
+		     json->tokens[token].line);
+		return -EINVAL;
+	}
+	return 0;
+}
+
+int sja1105_json_fixed(struct sja1105_json *json, int token, uint64_t scale,
+                       uint64_t *value, int *rounded)
+{
+	char buf[MAX_LINE_SIZE];
+	int rc;
+
+	rc = sja1105_json_string(json, token, buf, sizeof(buf));
+	if (rc < 0) {
+		return rc;
+	}
+	rc = reliable_fixed_from_string(value, buf, scale, rounded);
+	if (rc < 0) {
+		loge("%s:%d: expected a decimal number", json->name,
+		     json->tokens[token].line);
+	}
+	return rc;
+}
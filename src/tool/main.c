@@ -31,6 +31,7 @@
  *****************************************************************************/
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <lib/include/static-config.h>
 #include <lib/include/gtable.h>
@@ -41,12 +42,17 @@ const char *default_sja1105_conf_file = "/etc/sja1105/sja1105.conf";
 
 void print_usage()
 {
-	printf("Usage: sja1105-tool [-c|--config-file] [command] [options] \n"
+	printf("Usage: sja1105-tool [-c|--config-file] [-s|--socket <path>] "
+	       "[--device <name>|all] [--profile[=json]] [command] [options] \n"
 	       "command can be one of:\n"
 	       "   * config\n"
 	       "   * status\n"
 	       "   * reset\n"
 	       "   * reg\n"
+	       "   * schedule\n"
+	       "   * batch\n"
+	       "   * daemon\n"
+	       "   * exporter\n"
 	       "   * help | -h | --help\n"
 	       "   * version | -V | --version\n");
 	printf("\n");
@@ -66,7 +72,9 @@ void print_version()
 }
 
 static int parse_special_args(int *argc, char ***argv,
-                              char **sja1105_conf_file)
+                              char **sja1105_conf_file,
+                              char **socket_path,
+                              char **device_name)
 {
 	int more_special_args;
 	char *arg;
@@ -103,23 +111,62 @@ static int parse_special_args(int *argc, char ***argv,
 			(*argc)--; (*argv)++;
 			/* Continue to run */
 			sja1105_err_remap(rc, SJA1105_ERR_OK);
+		} else if (socket_path != NULL &&
+		           (matches(arg, "-s") == 0 ||
+		            matches(arg, "--socket") == 0)) {
+			/* Forward the command to sja1105d */
+			*socket_path = (*argv)[1];
+			more_special_args = 1;
+			/* Consume 2 arguments */
+			(*argc)--; (*argv)++;
+			(*argc)--; (*argv)++;
+			/* Continue to run */
+			sja1105_err_remap(rc, SJA1105_ERR_OK);
+		} else if (strcmp(arg, "--device") == 0 && (*argc) > 1) {
+			/* Name of a [setup <name>] section, or "all" */
+			*device_name = (*argv)[1];
+			more_special_args = 1;
+			/* Consume 2 arguments */
+			(*argc)--; (*argv)++;
+			(*argc)--; (*argv)++;
+			/* Continue to run */
+			sja1105_err_remap(rc, SJA1105_ERR_OK);
+		} else if (strcmp(arg, "--profile") == 0 ||
+		           strcmp(arg, "--profile=text") == 0 ||
+		           strcmp(arg, "--profile=json") == 0) {
+			/* Time the phases of this run, report on exit */
+			sja1105_profile_enable(strcmp(arg, "--profile=json") ?
+			                       SJA1105_OUTPUT_TEXT :
+			                       SJA1105_OUTPUT_JSON);
+			more_special_args = 1;
+			(*argc)--; (*argv)++;
+			/* Continue to run */
+			sja1105_err_remap(rc, SJA1105_ERR_OK);
 		}
 	} while (more_special_args && (*argc));
 
 	return rc;
 }
 
-static int parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv)
+int parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv)
 {
 	const char *options[] = {
 		"configure",
 		"status",
 		"reg",
+		"batch",
+		"daemon",
+		"exporter",
+		"schedule",
 	};
 	int (*next_parse_args[])(struct sja1105_spi_setup*, int, char**) = {
 		config_parse_args,
 		status_parse_args,
 		reg_parse_args,
+		batch_parse_args,
+		daemon_parse_args,
+		exporter_parse_args,
+		schedule_parse_args,
 	};
 	int  rc;
 
@@ -138,10 +185,12 @@ error:
 	return rc;
 }
 
-void cleanup(struct sja1105_spi_setup *spi_setup)
+void cleanup(struct sja1105_spi_setup *spi_setup,
+             struct sja1105_device_list *devices)
 {
 	extern const char *default_device;
 	extern const char *default_staging_area;
+	int i;
 
 	if (spi_setup->device && spi_setup->device != default_device) {
 		free((char*) spi_setup->device);
@@ -150,6 +199,11 @@ void cleanup(struct sja1105_spi_setup *spi_setup)
 	    spi_setup->staging_area != default_staging_area) {
 		free((char*) spi_setup->staging_area);
 	}
+	for (i = 0; i < devices->count; i++) {
+		free((char*) devices->devices[i].name);
+		free((char*) devices->devices[i].device);
+		free((char*) devices->devices[i].staging_area);
+	}
 }
 
 static int reinterpreted_return_code(int rc)
@@ -161,26 +215,83 @@ int main(int argc, char *argv[])
 {
 	char *sja1105_conf_file = (char*) default_sja1105_conf_file;
 	struct sja1105_spi_setup spi_setup;
+	struct sja1105_spi_setup *selected;
+	struct sja1105_device_list devices;
+	char *socket_path = NULL;
+	char *device_name = NULL;
+	char *prog_name;
+	int daemon_mode;
+	int prof;
 	int rc = SJA1105_ERR_OK;
 
+	/* When invoked as sja1105d, behave as "sja1105-tool daemon" */
+	prog_name = strrchr(argv[0], '/');
+	prog_name = (prog_name == NULL) ? argv[0] : prog_name + 1;
+	daemon_mode = (strcmp(prog_name, "sja1105d") == 0);
 	/* discard program name */
 	argc--; argv++;
-	if (argc == 0) {
+	if (argc == 0 && !daemon_mode) {
 		print_usage();
 		goto out;
 	}
-	rc = parse_special_args(&argc, &argv, &sja1105_conf_file);
-	if (rc < 0) {
+	if (argc) {
+		/* sja1105d takes -s|--socket for itself */
+		rc = parse_special_args(&argc, &argv, &sja1105_conf_file,
+		                        daemon_mode ? NULL : &socket_path,
+		                        &device_name);
+		if (rc < 0) {
+			goto out;
+		}
+	}
+	if (socket_path) {
+		if (device_name != NULL || sja1105_profile_enabled) {
+			/* Both are about the process that runs the
+			 * command, which is sja1105d */
+			loge("--device and --profile cannot be used with --socket");
+			sja1105_profile_enabled = 0;
+			rc = -EINVAL;
+			sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+			goto out;
+		}
+		/* Thin client: the daemon has already parsed its
+		 * config file and loaded the staging area */
+		rc = daemon_client_run(socket_path, argc, argv);
 		goto out;
 	}
-	read_config_file(sja1105_conf_file, &spi_setup, &general_config);
+	prof = sja1105_profile_begin("config-file", NULL);
+	read_config_file(sja1105_conf_file, &spi_setup, &devices,
+	                 &general_config);
+	sja1105_profile_end(prof);
 	/* Adjust gtable for SJA1105 SPI memory layout */
 	gtable_configure(QUIRK_LSW32_IS_FIRST);
-	rc = parse_args(&spi_setup, argc, argv);
+	selected = &spi_setup;
+	if (device_name != NULL && strcmp(device_name, "all") != 0) {
+		selected = sja1105_device_lookup(&devices, device_name);
+		if (selected == NULL) {
+			rc = -EINVAL;
+			sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+			goto out_cleanup;
+		}
+	}
+	if (device_name != NULL && strcmp(device_name, "all") == 0) {
+		if (daemon_mode) {
+			loge("sja1105d does not support --device all");
+			rc = -EINVAL;
+			sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+			goto out_cleanup;
+		}
+		rc = devices_parse_args(&devices, argc, argv);
+	} else if (daemon_mode) {
+		rc = daemon_parse_args(selected, argc, argv);
+	} else {
+		rc = parse_args(selected, argc, argv);
+	}
 	if (rc == SJA1105_ERR_OK) {
 		logv("ok");
 	}
-	cleanup(&spi_setup);
+out_cleanup:
+	cleanup(&spi_setup, &devices);
 out:
+	sja1105_profile_report();
 	return reinterpreted_return_code(rc);
 }
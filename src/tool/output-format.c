@@ -0,0 +1,340 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "internal.h"
+/* From libsja1105 */
+#include <lib/helpers.h>
+#include <common.h>
+
+/* Machine-readable output is produced field by field into a
+ * single buffer that is written out at the end of every record.
+ *
+ * JSON: a top-level object. Scalars emitted outside a section are
+ *       members of that object, sections are arrays of objects.
+ * CSV/TSV: one block per section (and one for the top-level
+ *       scalars), made of a header row followed by one row per
+ *       record. Blocks are separated by an empty line, empty
+ *       sections produce no block at all.
+ *       Arrays are written as space-separated values.
+ */
+
+static const char *output_format_names[] = {
+	[SJA1105_OUTPUT_TEXT] = "text",
+	[SJA1105_OUTPUT_JSON] = "json",
+	[SJA1105_OUTPUT_CSV]  = "csv",
+	[SJA1105_OUTPUT_TSV]  = "tsv",
+};
+
+int sja1105_output_format_get(int *argc, char ***argv,
+                              enum sja1105_output_format *format)
+{
+	int match;
+
+	*format = SJA1105_OUTPUT_TEXT;
+	if (*argc == 0 || strcmp((*argv)[0], "--format") != 0) {
+		return 0;
+	}
+	if (*argc < 2) {
+		loge("--format requires an argument");
+		return -EINVAL;
+	}
+	match = get_match((*argv)[1], output_format_names,
+	                  ARRAY_SIZE(output_format_names));
+	if (match < 0) {
+		return -EINVAL;
+	}
+	*format = match;
+	/* Consume 2 arguments */
+	(*argc) -= 2; (*argv) += 2;
+	return 0;
+}
+
+static void output_flush(struct sja1105_output *out)
+{
+	fwrite(out->buf, 1, out->len, stdout);
+	out->len = 0;
+}
+
+static void
+output_append(char *buf, size_t *len, size_t size, const char *fmt, va_list args)
+{
+	int rc;
+
+	rc = vsnprintf(buf + *len, size - *len, fmt, args);
+	if (rc < 0) {
+		return;
+	}
+	if ((size_t) rc >= size - *len) {
+		loge("Output record truncated");
+		*len = size - 1;
+	} else {
+		*len += rc;
+	}
+}
+
+static void output_printf(struct sja1105_output *out, const char *fmt, ...)
+{
+	va_list args;
+
+	/* Only the first row of a block has to stay in the buffer
+	 * until its header is complete. Anything else can go out. */
+	if (out->len > sizeof(out->buf) / 2 && out->header_done) {
+		output_flush(out);
+	}
+	va_start(args, fmt);
+	output_append(out->buf, &out->len, sizeof(out->buf), fmt, args);
+	va_end(args);
+}
+
+static void output_header_printf(struct sja1105_output *out, const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	output_append(out->header, &out->header_len, sizeof(out->header),
+	              fmt, args);
+	va_end(args);
+}
+
+static char output_separator(struct sja1105_output *out)
+{
+	return (out->format == SJA1105_OUTPUT_TSV) ? '\t' : ',';
+}
+
+static void output_row_end(struct sja1105_output *out)
+{
+	if (!out->row_open) {
+		return;
+	}
+	if (!out->header_done) {
+		if (out->rows) {
+			/* Empty line between blocks */
+			fputc('\n', stdout);
+		}
+		fwrite(out->header, 1, out->header_len, stdout);
+		fputc('\n', stdout);
+		out->header_done = 1;
+	}
+	output_printf(out, "\n");
+	output_flush(out);
+	out->row_open = 0;
+	out->rows++;
+}
+
+static void output_block_begin(struct sja1105_output *out)
+{
+	output_row_end(out);
+	out->header_len  = 0;
+	out->header_done = 0;
+}
+
+static void output_row_begin(struct sja1105_output *out)
+{
+	out->row_open = 1;
+	out->fields   = 0;
+	if (out->section_column != NULL) {
+		output_header_printf(out, "%s", out->section_column);
+		output_printf(out, "%s", out->section);
+		out->fields++;
+	}
+}
+
+/* Emits the separator and name of the next member or cell */
+static void output_key(struct sja1105_output *out, const char *name)
+{
+	if (out->format == SJA1105_OUTPUT_JSON) {
+		if (out->items[out->depth]++) {
+			output_printf(out, ",");
+		}
+		if (out->depth < 2 && !out->compact) {
+			/* One line per top-level member and per record */
+			output_printf(out, "\n");
+		}
+		if (name != NULL) {
+			output_printf(out, "\"%s\":", name);
+		}
+		return;
+	}
+	if (!out->row_open) {
+		/* Top-level scalars form a block of their own */
+		output_row_begin(out);
+	}
+	if (out->fields++) {
+		output_printf(out, "%c", output_separator(out));
+		if (!out->header_done) {
+			output_header_printf(out, "%c", output_separator(out));
+		}
+	}
+	if (!out->header_done) {
+		output_header_printf(out, "%s", name);
+	}
+}
+
+static void output_open(struct sja1105_output *out, const char *name, char c)
+{
+	output_key(out, name);
+	output_printf(out, "%c", c);
+	out->items[++out->depth] = 0;
+}
+
+static void output_close(struct sja1105_output *out, char c)
+{
+	out->depth--;
+	output_printf(out, "%c", c);
+}
+
+void sja1105_output_begin(struct sja1105_output *out,
+                          enum sja1105_output_format format)
+{
+	int compact = out->compact;
+
+	memset(out, 0, offsetof(struct sja1105_output, buf));
+	out->compact = compact;
+	out->format = format;
+	out->len    = 0;
+	/* JSON has no header row holding back the first record */
+	out->header_done = (format == SJA1105_OUTPUT_JSON);
+	if (format == SJA1105_OUTPUT_JSON) {
+		output_printf(out, "{");
+	}
+}
+
+void sja1105_output_end(struct sja1105_output *out)
+{
+	if (out->format == SJA1105_OUTPUT_JSON) {
+		output_printf(out, out->compact ? "}\n" : "\n}\n");
+		output_flush(out);
+	} else {
+		output_row_end(out);
+	}
+	fflush(stdout);
+}
+
+void sja1105_output_section_begin(struct sja1105_output *out,
+                                  const char *name, const char *column)
+{
+	if (out->format == SJA1105_OUTPUT_JSON) {
+		output_open(out, name, '[');
+	} else {
+		output_block_begin(out);
+		out->section        = name;
+		out->section_column = column;
+	}
+}
+
+void sja1105_output_section_end(struct sja1105_output *out)
+{
+	if (out->format == SJA1105_OUTPUT_JSON) {
+		output_close(out, ']');
+	} else {
+		out->section        = NULL;
+		out->section_column = NULL;
+	}
+}
+
+void sja1105_output_record_begin(struct sja1105_output *out)
+{
+	if (out->format == SJA1105_OUTPUT_JSON) {
+		output_open(out, NULL, '{');
+	} else {
+		output_row_begin(out);
+	}
+}
+
+void sja1105_output_record_end(struct sja1105_output *out)
+{
+	if (out->format == SJA1105_OUTPUT_JSON) {
+		output_close(out, '}');
+		output_flush(out);
+	} else {
+		output_row_end(out);
+	}
+}
+
+void sja1105_output_u64(struct sja1105_output *out, const char *name,
+                        uint64_t value)
+{
+	output_key(out, name);
+	output_printf(out, "%" PRIu64, value);
+}
+
+void sja1105_output_str(struct sja1105_output *out, const char *name,
+                        const char *value)
+{
+	output_key(out, name);
+	if (out->format == SJA1105_OUTPUT_JSON) {
+		output_printf(out, "\"%s\"", value);
+	} else {
+		output_printf(out, "%s", value);
+	}
+}
+
+void sja1105_output_mac(struct sja1105_output *out, const char *name,
+                        uint64_t value)
+{
+	char mac_buf[MAC_ADDR_SIZE];
+
+	mac_addr_sprintf(mac_buf, value);
+	sja1105_output_str(out, name, mac_buf);
+}
+
+void sja1105_output_array(struct sja1105_output *out, const char *name,
+                          uint64_t *values, int count)
+{
+	int i;
+
+	output_key(out, name);
+	if (out->format == SJA1105_OUTPUT_JSON) {
+		output_printf(out, "[");
+	}
+	for (i = 0; i < count; i++) {
+		if (i) {
+			output_printf(out, (out->format == SJA1105_OUTPUT_JSON) ?
+			              "," : " ");
+		}
+		output_printf(out, "%" PRIu64, values[i]);
+	}
+	if (out->format == SJA1105_OUTPUT_JSON) {
+		output_printf(out, "]");
+	}
+}
+
+void sja1105_output_none(struct sja1105_output *out, const char *name)
+{
+	/* Keep the CSV columns aligned, omit the member in JSON */
+	if (out->format != SJA1105_OUTPUT_JSON) {
+		output_key(out, name);
+	}
+}
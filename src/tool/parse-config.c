@@ -32,32 +32,102 @@
 #include "xml/write/external.h"
 #include "internal.h"
 #include <string.h>
+#include <inttypes.h>
 
 static void print_usage()
 {
 	printf("Usage: sja1105-tool config <command> [<options>] \n");
 	printf("<command> can be:\n");
 	printf("* new [-d|--device-id <value>], default 0x9e00030e (SJA1105T)\n");
-	printf("* load [-f|--flush] <filename.xml>\n");
-	printf("* save <filename.xml>\n");
-	printf("* default [-f|--flush] <config>, which can be:\n");
+	printf("* load [-f|--flush] [--force] [--json|--merge] [--jobs <n>]\n"
+	       "       <filename.xml|json>\n");
+	printf("* save [--compact|--json] <filename.xml|json>\n");
+	printf("* default [-f|--flush] [--force] <config>, which can be:\n");
 	printf("    * ls1021atsn - load a built-in config compatible with the NXP LS1021ATSN board\n");
-	printf("* modify [-f|--flush] <table>[<entry_index>] <field> <value>\n");
+	printf("* generate [-f|--flush] [--force] <spec.json> - build a whole config from\n"
+	       "    a description of the ports, VLANs, policers and memory partitions\n");
+	printf("* modify [-f|--flush] [--force] <table>[<entry_index>] <field> <value>\n");
+	printf("* policer set [-f|--flush] [--force] --port <ports> --prio <prios>|bcast\n"
+	       "      [--rate-mbps <Mbps>] [--burst <bytes>] [--mtu <bytes>]\n"
+	       "      [--sharindx <index>] [--partition <0-7>]\n");
+	printf("  load, default, generate, modify and policer skip the save and flush if the staging\n"
+	       "  area would not change, unless --force is given.\n");
 	printf("* upload\n");
-	printf("* show [<table>]. If no table is specified, shows entire config.\n");
+	printf("* show [--format json|csv|tsv] [<table> [where <expression>]]. If no table is specified, shows entire config.\n");
 	printf("* hexdump [<table>]. If no table is specified, dumps entire config.\n");
+	printf("* fingerprint - print a hash of the packed staging area\n");
+	printf("* diff [--format json|csv|tsv] [<a>] <b>. Compare two staging areas, XML or JSON files.\n"
+	       "    If only one is given, it is compared against the staging area.\n");
 }
 
-static void
-get_flush_mode(struct sja1105_spi_setup *spi_setup, int *argc, char ***argv)
+void
+get_flush_mode(struct sja1105_spi_setup *spi_setup, int *force,
+               int *argc, char ***argv)
 {
-	if ((*argc) && ((strcmp(*argv[0], "-f") == 0 ||
-	                (strcmp(*argv[0], "--flush") == 0)))) {
-		spi_setup->flush = 1;
+	while (*argc) {
+		if (strcmp(*argv[0], "-f") == 0 ||
+		    strcmp(*argv[0], "--flush") == 0) {
+			spi_setup->flush = 1;
+		} else if (strcmp(*argv[0], "--force") == 0) {
+			*force = 1;
+		} else {
+			break;
+		}
 		(*argc)--; (*argv)++;
 	}
 }
 
+/* Re-applying the same configuration should neither rewrite the staging
+ * area nor reset the switch with an identical one. Returns 0 if the
+ * save (and flush) can be skipped, 1 if not, and a negative error code
+ * if the staging area cannot be packed.
+ */
+int
+staging_area_save_needed(struct sja1105_spi_setup *spi_setup,
+                         struct sja1105_staging_area *staging_area, int force)
+{
+	int rc;
+
+	if (force) {
+		return 1;
+	}
+	rc = staging_area_unchanged(spi_setup->staging_area, staging_area);
+	if (rc <= 0) {
+		/* Changed, or could not pack it */
+		return (rc < 0) ? rc : 1;
+	}
+	if (spi_setup->flush &&
+	    !staging_area_uploaded(spi_setup->staging_area, staging_area)) {
+		/* Not (known to be) running on the switch yet.
+		 * staging_area_save() will not rewrite the file. */
+		logi("Staging area unchanged, skipping save");
+		return 1;
+	}
+	staging_area_packed_drop();
+	logi("Staging area unchanged, skipping save%s",
+	     spi_setup->flush ? " and flush" : "");
+	return 0;
+}
+
+static int join_args(char *buf, size_t len, int argc, char **argv)
+{
+	size_t written = 0;
+	int rc;
+	int i;
+
+	buf[0] = '\0';
+	for (i = 0; i < argc; i++) {
+		rc = snprintf(buf + written, len - written, "%s%s",
+		              (i == 0) ? "" : " ", argv[i]);
+		if (rc < 0 || (size_t) rc >= len - written) {
+			loge("Expression too long");
+			return -E2BIG;
+		}
+		written += rc;
+	}
+	return 0;
+}
+
 int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv)
 {
 	const char *options[] = {
@@ -65,13 +135,22 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 		"load",
 		"save",
 		"default",
+		"generate",
 		"modify",
+		"policer",
 		"new",
 		"upload",
 		"show",
 		"hexdump",
+		"fingerprint",
+		"diff",
 	};
 	struct sja1105_staging_area staging_area;
+	uint64_t fingerprint;
+	char where_buf[MAX_LINE_SIZE];
+	char *where = NULL;
+	enum sja1105_output_format format;
+	int force = 0;
 	int match;
 	int rc = SJA1105_ERR_OK;
 
@@ -85,14 +164,65 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 	} else if (strcmp(options[match], "help") == 0) {
 		print_usage();
 	} else if (strcmp(options[match], "load") == 0) {
-		get_flush_mode(spi_setup, &argc, &argv);
-		if (argc != 1) {
+		uint64_t jobs = 1;
+		long cpus;
+		int merge = 0;
+		int json = 0;
+
+		get_flush_mode(spi_setup, &force, &argc, &argv);
+		while (argc > 1) {
+			if (strcmp(argv[0], "--json") == 0) {
+				json = 1;
+			} else if (strcmp(argv[0], "--merge") == 0) {
+				merge = 1;
+			} else if (strcmp(argv[0], "--jobs") == 0 && argc > 2) {
+				rc = reliable_uint64_from_string(&jobs, argv[1],
+				                                 NULL);
+				if (rc < 0 || jobs > 64) {
+					loge("invalid number of jobs %s",
+					     argv[1]);
+					rc = -EINVAL;
+					goto parse_error;
+				}
+				argc--; argv++;
+			} else {
+				break;
+			}
+			argc--; argv++;
+		}
+		if (argc != 1 || (json && (merge || jobs != 1))) {
 			goto parse_error;
 		}
-		rc = sja1105_staging_area_from_xml(argv[0], &staging_area);
+		if (jobs == 0) {
+			/* One per CPU */
+			cpus = sysconf(_SC_NPROCESSORS_ONLN);
+			jobs = (cpus > 0) ? cpus : 1;
+		}
+		if (merge) {
+			rc = staging_area_load(spi_setup->staging_area,
+			                       &staging_area);
+			if (rc < 0) {
+				goto propagated_error;
+			}
+		}
+		if (json) {
+			rc = sja1105_staging_area_from_json(argv[0],
+			                                    &staging_area);
+		} else {
+			rc = sja1105_staging_area_read_xml(argv[0],
+			                                   &staging_area,
+			                                   merge, jobs);
+		}
 		if (rc < 0) {
 			goto invalid_xml_error;
 		}
+		rc = staging_area_save_needed(spi_setup, &staging_area, force);
+		if (rc < 0) {
+			goto filesystem_error;
+		}
+		if (rc == 0) {
+			goto out;
+		}
 		rc = staging_area_save(spi_setup->staging_area, &staging_area);
 		if (rc < 0) {
 			goto filesystem_error;
@@ -109,6 +239,16 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 			}
 		}
 	} else if (strcmp(options[match], "save") == 0) {
+		int compact = 0;
+		int json = 0;
+
+		if (argc == 2 && strcmp(argv[0], "--compact") == 0) {
+			compact = 1;
+			argc--; argv++;
+		} else if (argc == 2 && strcmp(argv[0], "--json") == 0) {
+			json = 1;
+			argc--; argv++;
+		}
 		if (argc != 1) {
 			goto parse_error;
 		}
@@ -116,7 +256,13 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 		if (rc < 0) {
 			goto propagated_error;
 		}
-		rc = sja1105_staging_area_to_xml(argv[0], &staging_area);
+		if (json) {
+			rc = sja1105_staging_area_to_json(argv[0],
+			                                  &staging_area);
+		} else {
+			rc = sja1105_staging_area_to_xml(argv[0], &staging_area,
+			                                 compact);
+		}
 		if (rc < 0) {
 			goto invalid_xml_error;
 		}
@@ -127,7 +273,7 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 		enum sja1105_default_staging_area default_configs[] = {
 			LS1021ATSN,
 		};
-		get_flush_mode(spi_setup, &argc, &argv);
+		get_flush_mode(spi_setup, &force, &argc, &argv);
 		if (argc != 1) {
 			goto parse_error;
 		}
@@ -142,6 +288,13 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 		if (rc < 0) {
 			goto invalid_staging_area_error;
 		}
+		rc = staging_area_save_needed(spi_setup, &staging_area, force);
+		if (rc < 0) {
+			goto filesystem_error;
+		}
+		if (rc == 0) {
+			goto out;
+		}
 		rc = staging_area_save(spi_setup->staging_area, &staging_area);
 		if (rc < 0) {
 			goto filesystem_error;
@@ -156,6 +309,32 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 				goto hardware_left_floating_staging_area_dirty_error;
 			}
 		}
+	} else if (strcmp(options[match], "generate") == 0) {
+		get_flush_mode(spi_setup, &force, &argc, &argv);
+		if (argc != 1) {
+			goto parse_error;
+		}
+		rc = sja1105_staging_area_generate(argv[0], &staging_area);
+		if (rc < 0) {
+			goto invalid_staging_area_error;
+		}
+		rc = staging_area_save_needed(spi_setup, &staging_area, force);
+		if (rc < 0) {
+			goto filesystem_error;
+		}
+		if (rc == 0) {
+			goto out;
+		}
+		rc = staging_area_save(spi_setup->staging_area, &staging_area);
+		if (rc < 0) {
+			goto filesystem_error;
+		}
+		if (spi_setup->flush) {
+			rc = staging_area_flush(spi_setup);
+			if (rc < 0) {
+				goto hardware_left_floating_staging_area_dirty_error;
+			}
+		}
 	} else if (strcmp(options[match], "upload") == 0) {
 		if (argc != 0) {
 			goto parse_error;
@@ -174,7 +353,7 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 			goto propagated_error;
 		}
 	} else if (strcmp(options[match], "modify") == 0) {
-		get_flush_mode(spi_setup, &argc, &argv);
+		get_flush_mode(spi_setup, &force, &argc, &argv);
 		rc = staging_area_load(spi_setup->staging_area, &staging_area);
 		if (rc < 0) {
 			goto propagated_error;
@@ -183,6 +362,13 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 		if (rc < 0) {
 			goto propagated_error;
 		}
+		rc = staging_area_save_needed(spi_setup, &staging_area, force);
+		if (rc < 0) {
+			goto filesystem_error;
+		}
+		if (rc == 0) {
+			goto out;
+		}
 		rc = staging_area_save(spi_setup->staging_area, &staging_area);
 		if (rc < 0) {
 			goto filesystem_error;
@@ -197,6 +383,38 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 				goto hardware_left_floating_staging_area_dirty_error;
 			}
 		}
+	} else if (strcmp(options[match], "policer") == 0) {
+		if (argc < 1 || strcmp(argv[0], "set") != 0) {
+			goto parse_error;
+		}
+		/* Consume "set" */
+		argc--; argv++;
+		get_flush_mode(spi_setup, &force, &argc, &argv);
+		rc = staging_area_load(spi_setup->staging_area, &staging_area);
+		if (rc < 0) {
+			goto propagated_error;
+		}
+		rc = staging_area_policer_set(&staging_area, argc, argv);
+		if (rc < 0) {
+			goto propagated_error;
+		}
+		rc = staging_area_save_needed(spi_setup, &staging_area, force);
+		if (rc < 0) {
+			goto filesystem_error;
+		}
+		if (rc == 0) {
+			goto out;
+		}
+		rc = staging_area_save(spi_setup->staging_area, &staging_area);
+		if (rc < 0) {
+			goto filesystem_error;
+		}
+		if (spi_setup->flush) {
+			rc = staging_area_flush(spi_setup);
+			if (rc < 0) {
+				goto hardware_left_floating_staging_area_dirty_error;
+			}
+		}
 	} else if (strcmp(options[match], "new") == 0) {
 		if (argc != 2 && argc != 0) {
 			/* The 2 forms that are allowed are:
@@ -226,14 +444,28 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 			goto filesystem_error;
 		}
 	} else if (strcmp(options[match], "show") == 0) {
-		if (argc != 0 && argc != 1) {
+		rc = sja1105_output_format_get(&argc, &argv, &format);
+		if (rc < 0) {
 			goto parse_error;
 		}
+		if (argc == 2 || (argc > 2 && strcmp(argv[1], "where") != 0)) {
+			goto parse_error;
+		}
+		if (argc > 2) {
+			/* The expression may come as one or several words */
+			rc = join_args(where_buf, sizeof(where_buf),
+			               argc - 2, argv + 2);
+			if (rc < 0) {
+				goto parse_error;
+			}
+			where = where_buf;
+		}
 		rc = staging_area_load(spi_setup->staging_area, &staging_area);
 		if (rc < 0) {
 			goto propagated_error;
 		}
-		rc = sja1105_staging_area_show(&staging_area, argv[0]);
+		rc = sja1105_staging_area_show(&staging_area, argv[0], where,
+		                               format);
 		if (rc < 0) {
 			goto invalid_staging_area_error;
 		}
@@ -245,9 +477,46 @@ int config_parse_args(struct sja1105_spi_setup *spi_setup, int argc, char **argv
 		if (rc < 0) {
 			goto propagated_error;
 		}
+	} else if (strcmp(options[match], "fingerprint") == 0) {
+		if (argc != 0) {
+			goto parse_error;
+		}
+		rc = staging_area_load(spi_setup->staging_area, &staging_area);
+		if (rc < 0) {
+			goto propagated_error;
+		}
+		rc = staging_area_fingerprint(&staging_area, &fingerprint);
+		if (rc < 0) {
+			goto invalid_staging_area_error;
+		}
+		printf("%016" PRIx64 "\n", fingerprint);
+	} else if (strcmp(options[match], "diff") == 0) {
+		rc = sja1105_output_format_get(&argc, &argv, &format);
+		if (rc < 0) {
+			goto parse_error;
+		}
+		if (argc == 1) {
+			/* Compare the staging area against the given file */
+			rc = sja1105_staging_area_diff(spi_setup->staging_area,
+			                               argv[0], format);
+		} else if (argc == 2) {
+			rc = sja1105_staging_area_diff(argv[0], argv[1], format);
+		} else {
+			goto parse_error;
+		}
+		if (rc < 0) {
+			goto propagated_error;
+		}
+		if (rc > 0) {
+			/* Let scripts tell the outcome apart without
+			 * parsing the output */
+			sja1105_err_remap(rc, SJA1105_ERR_CONFIG_DIFFERS);
+			return rc;
+		}
 	} else {
 		goto parse_error;
 	}
+out:
 	sja1105_err_remap(rc, SJA1105_ERR_OK);
 	return rc;
 invalid_staging_area_error:
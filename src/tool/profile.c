@@ -0,0 +1,258 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "internal.h"
+
+/* Timeline of the phases of a sja1105-tool run (--profile). Only the
+ * first SJA1105_PROFILE_MAX_RECORDS are kept individually; every phase
+ * is also accumulated per name, so long runs (batch mode) still get a
+ * complete summary. Phases past the limit are timed in one of the
+ * SJA1105_PROFILE_MAX_OPEN overflow slots, which is given back as soon
+ * as the phase has been added to the summary, so that phases timed
+ * by concurrent threads never share a slot.
+ */
+#define SJA1105_PROFILE_MAX_RECORDS 256
+#define SJA1105_PROFILE_MAX_PHASES  32
+#define SJA1105_PROFILE_MAX_OPEN    64
+
+struct profile_record {
+	const char *phase;
+	char        detail[32];
+	uint64_t    start;
+	uint64_t    duration;
+};
+
+struct profile_phase {
+	const char *name;
+	uint64_t    count;
+	uint64_t    total;
+	uint64_t    max;
+};
+
+int sja1105_profile_enabled;
+/* Parallel uploads are timed from several threads */
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct {
+	enum sja1105_output_format format;
+	uint64_t                   start;
+	int                        record_count;
+	int                        dropped;
+	int                        phase_count;
+	struct profile_record      records[SJA1105_PROFILE_MAX_RECORDS];
+	/* A NULL phase marks a free slot */
+	struct profile_record      overflow[SJA1105_PROFILE_MAX_OPEN];
+	struct profile_phase       phases[SJA1105_PROFILE_MAX_PHASES];
+} profile;
+
+static uint64_t profile_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void sja1105_profile_enable(enum sja1105_output_format format)
+{
+	memset(&profile, 0, sizeof(profile));
+	profile.format = format;
+	profile.start  = profile_now();
+	sja1105_profile_enabled = 1;
+}
+
+int __sja1105_profile_begin(const char *phase, const char *detail)
+{
+	struct profile_record *record;
+	uint64_t now = profile_now();
+	int id;
+	int i;
+
+	pthread_mutex_lock(&profile_lock);
+	if (profile.record_count < SJA1105_PROFILE_MAX_RECORDS) {
+		id = profile.record_count++;
+		record = &profile.records[id];
+	} else {
+		/* Still timed, but only for the summary */
+		profile.dropped++;
+		for (i = 0; i < SJA1105_PROFILE_MAX_OPEN; i++) {
+			if (profile.overflow[i].phase == NULL) {
+				break;
+			}
+		}
+		if (i == SJA1105_PROFILE_MAX_OPEN) {
+			/* Not timed at all */
+			pthread_mutex_unlock(&profile_lock);
+			return -1;
+		}
+		id = SJA1105_PROFILE_MAX_RECORDS + i;
+		record = &profile.overflow[i];
+	}
+	record->phase = phase;
+	snprintf(record->detail, sizeof(record->detail), "%s",
+	         detail ? detail : "");
+	record->start = now;
+	pthread_mutex_unlock(&profile_lock);
+	return id;
+}
+
+void __sja1105_profile_end(int id)
+{
+	struct profile_record *record;
+	struct profile_phase *phase;
+	uint64_t now = profile_now();
+	int i;
+
+	pthread_mutex_lock(&profile_lock);
+	if (id < SJA1105_PROFILE_MAX_RECORDS) {
+		record = &profile.records[id];
+	} else {
+		record = &profile.overflow[id - SJA1105_PROFILE_MAX_RECORDS];
+	}
+	record->duration = now - record->start;
+	record->start   -= profile.start;
+
+	for (i = 0; i < profile.phase_count; i++) {
+		if (strcmp(profile.phases[i].name, record->phase) == 0) {
+			break;
+		}
+	}
+	if (i == profile.phase_count) {
+		if (i == SJA1105_PROFILE_MAX_PHASES) {
+			goto out;
+		}
+		profile.phase_count++;
+		profile.phases[i].name = record->phase;
+	}
+	phase = &profile.phases[i];
+	phase->count++;
+	phase->total += record->duration;
+	if (phase->max < record->duration) {
+		phase->max = record->duration;
+	}
+out:
+	if (id >= SJA1105_PROFILE_MAX_RECORDS) {
+		record->phase = NULL;
+	}
+	pthread_mutex_unlock(&profile_lock);
+}
+
+static void profile_report_text(uint64_t elapsed)
+{
+	struct profile_record *record;
+	struct profile_phase *phase;
+	uint64_t accounted = 0;
+	uint64_t other;
+	int i;
+
+	fprintf(stderr, "Profile (times in microseconds):\n");
+	fprintf(stderr, "%12s %12s  %s\n", "start", "duration", "phase");
+	for (i = 0; i < profile.record_count; i++) {
+		record = &profile.records[i];
+		fprintf(stderr, "%12.1f %12.1f  %s%s%s\n",
+		        record->start / 1000.0, record->duration / 1000.0,
+		        record->phase, record->detail[0] ? " " : "",
+		        record->detail);
+	}
+	if (profile.dropped) {
+		fprintf(stderr, "(%d more not shown)\n", profile.dropped);
+	}
+	fprintf(stderr, "\n%-16s %8s %12s %12s %6s\n",
+	        "phase", "count", "total", "max", "%");
+	for (i = 0; i < profile.phase_count; i++) {
+		phase = &profile.phases[i];
+		accounted += phase->total;
+		fprintf(stderr, "%-16s %8" PRIu64 " %12.1f %12.1f %6.1f\n",
+		        phase->name, phase->count, phase->total / 1000.0,
+		        phase->max / 1000.0, 100.0 * phase->total / elapsed);
+	}
+	/* Phases timed in parallel (such as the sysfs-write of each
+	 * device with --device all) can add up to more than the run */
+	other = (accounted < elapsed) ? elapsed - accounted : 0;
+	fprintf(stderr, "%-16s %8s %12.1f %12s %6.1f\n", "other", "",
+	        other / 1000.0, "", 100.0 * other / elapsed);
+	fprintf(stderr, "%-16s %8s %12.1f\n", "total", "", elapsed / 1000.0);
+	if (accounted > elapsed) {
+		fprintf(stderr, "(phases overlap: they add up to %.1f)\n",
+		        accounted / 1000.0);
+	}
+}
+
+/* Same information, as a single JSON object on one line */
+static void profile_report_json(uint64_t elapsed)
+{
+	struct profile_record *record;
+	struct profile_phase *phase;
+	int i;
+
+	fprintf(stderr, "{\"total_ns\": %" PRIu64 ", \"records\": [", elapsed);
+	for (i = 0; i < profile.record_count; i++) {
+		record = &profile.records[i];
+		fprintf(stderr, "%s{\"phase\": \"%s\", \"detail\": \"%s\", "
+		        "\"start_ns\": %" PRIu64 ", \"duration_ns\": %" PRIu64 "}",
+		        i ? ", " : "", record->phase, record->detail,
+		        record->start, record->duration);
+	}
+	fprintf(stderr, "], \"dropped\": %d, \"phases\": [",
+	        profile.dropped);
+	for (i = 0; i < profile.phase_count; i++) {
+		phase = &profile.phases[i];
+		fprintf(stderr, "%s{\"phase\": \"%s\", \"count\": %" PRIu64 ", "
+		        "\"total_ns\": %" PRIu64 ", \"max_ns\": %" PRIu64 "}",
+		        i ? ", " : "", phase->name, phase->count,
+		        phase->total, phase->max);
+	}
+	fprintf(stderr, "]}\n");
+}
+
+/* Printed on stderr, so as not to mix with the output of the command */
+void sja1105_profile_report(void)
+{
+	uint64_t elapsed;
+
+	if (!sja1105_profile_enabled) {
+		return;
+	}
+	elapsed = profile_now() - profile.start;
+	if (elapsed == 0) {
+		elapsed = 1;
+	}
+	if (profile.format == SJA1105_OUTPUT_JSON) {
+		profile_report_json(elapsed);
+	} else {
+		profile_report_text(elapsed);
+	}
+}
@@ -5,7 +5,10 @@
  *      Author: tescott
  */
 #include "internal.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <inttypes.h>
 
 static void print_usage()
@@ -15,6 +18,10 @@ static void print_usage()
 	       "Read or write register\n");
 	printf(" * sja1105-tool reg dump <address> <count>    :"
 	       "Incrementally dump registers starting at the given address\n");
+	printf(" * sja1105-tool reg read [--binary] <address> [<count>] :"
+	       "Read <count> registers at once\n");
+	printf(" * sja1105-tool reg write <address> <file>|<values...> :"
+	       "Write consecutive registers at once\n");
 }
 
 
@@ -29,7 +36,7 @@ static int write_register(struct sja1105_spi_setup *spi_setup,
 	               address, value) + 1;
 	rc = sysfs_write(spi_setup, "reg_access", buf, len);
 
-	return (rc == len) ? 0 : -1;
+	return (rc == 0) ? 0 : -1;
 }
 
 static int read_register(struct sja1105_spi_setup *spi_setup,
@@ -43,7 +50,7 @@ static int read_register(struct sja1105_spi_setup *spi_setup,
 
 	len = snprintf(buf, sizeof(buf), "0x%" PRIx64, address) + 1;
 	rc = sysfs_write(spi_setup, "reg_access", buf, len);
-	if (rc != len) {
+	if (rc != 0) {
 		rc = -1;
 		goto out;
 	}
@@ -71,50 +78,319 @@ out:
 }
 
 
+/* The kernel module presents the register space as the binary file
+ * "regs", at offset 4 * address. A range of registers is then a single
+ * pread/pwrite, which the kernel turns into as few SPI bursts as
+ * possible. Registers are kept in SPI (big endian) byte order, which
+ * is also the format of binary register dumps.
+ */
+#define REG_SIZE 4
+/* 21-bit register address, as in the kernel module */
+#define REG_COUNT_MAX (1ull << 21)
+
+/* Also keeps count * REG_SIZE from overflowing */
+static int reg_range_check(uint64_t address, uint64_t count)
+{
+	if (address >= REG_COUNT_MAX || count > REG_COUNT_MAX - address) {
+		loge("register range 0x%" PRIx64 "+%" PRIu64 " exceeds the "
+		     "register space", address, count);
+		return -ERANGE;
+	}
+	return 0;
+}
+
+static uint64_t reg_from_be(const uint8_t *p)
+{
+	return ((uint64_t) p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static void reg_to_be(uint8_t *p, uint64_t value)
+{
+	p[0] = value >> 24;
+	p[1] = value >> 16;
+	p[2] = value >> 8;
+	p[3] = value;
+}
+
+static int read_registers(struct sja1105_spi_setup *spi_setup,
+                          uint64_t address, uint64_t count, uint8_t *buf)
+{
+	uint64_t value;
+	uint64_t i;
+	ssize_t rc;
+
+	rc = sysfs_read_at(spi_setup, "regs", (char*) buf,
+	                   count * REG_SIZE, address * REG_SIZE);
+	if (rc == -ENOENT) {
+		/* Older kernel module, one register at a time */
+		logv("no burst access to registers, using reg_access");
+		for (i = 0; i < count; i++) {
+			rc = read_register(spi_setup, address + i, &value);
+			if (rc < 0) {
+				return rc;
+			}
+			reg_to_be(buf + i * REG_SIZE, value);
+		}
+		return 0;
+	}
+	if (rc >= 0 && (uint64_t) rc != count * REG_SIZE) {
+		loge("register range exceeds the register space");
+		rc = -ERANGE;
+	}
+	return (rc < 0) ? rc : 0;
+}
+
+static int write_registers(struct sja1105_spi_setup *spi_setup,
+                           uint64_t address, uint64_t count, uint8_t *buf)
+{
+	uint64_t i;
+	ssize_t rc;
+
+	rc = sysfs_write_at(spi_setup, "regs", (char*) buf,
+	                    count * REG_SIZE, address * REG_SIZE);
+	if (rc == -ENOENT) {
+		logv("no burst access to registers, using reg_access");
+		for (i = 0; i < count; i++) {
+			rc = write_register(spi_setup, address + i,
+			                    reg_from_be(buf + i * REG_SIZE));
+			if (rc < 0) {
+				return rc;
+			}
+		}
+		return 0;
+	}
+	if (rc >= 0 && (uint64_t) rc != count * REG_SIZE) {
+		loge("register range exceeds the register space");
+		rc = -ERANGE;
+	}
+	return (rc < 0) ? rc : 0;
+}
+
+/* per_line registers per line, in the same format as single register
+ * reads ("reg dump" keeps printing one per line) */
+static void registers_hexdump(uint64_t address, uint64_t count, uint8_t *buf,
+                              int per_line)
+{
+	uint64_t i;
+
+	for (i = 0; i < count; i++) {
+		if (i % per_line == 0) {
+			printf("%s0x%08" PRIx64 ":", i ? "\n" : "", address + i);
+		}
+		printf(" %08" PRIx64, reg_from_be(buf + i * REG_SIZE));
+	}
+	printf("\n");
+}
+
+static int reg_read_parse_args(struct sja1105_spi_setup *spi_setup,
+                               int argc, char **argv, int per_line)
+{
+	uint64_t address;
+	uint64_t count = 1;
+	uint8_t *buf;
+	int binary = 0;
+	int rc;
+
+	if (argc && strcmp(argv[0], "--binary") == 0) {
+		binary = 1;
+		argc--; argv++;
+	}
+	if (argc != 1 && argc != 2) {
+		return -EINVAL;
+	}
+	rc = reliable_uint64_from_string(&address, argv[0], NULL);
+	if (rc < 0) {
+		loge("could not read address param %s", argv[0]);
+		return rc;
+	}
+	if (argc == 2) {
+		rc = reliable_uint64_from_string(&count, argv[1], NULL);
+		if (rc < 0 || count == 0) {
+			loge("could not read count param %s", argv[1]);
+			return -EINVAL;
+		}
+	}
+	rc = reg_range_check(address, count);
+	if (rc < 0) {
+		return rc;
+	}
+	buf = malloc(count * REG_SIZE);
+	if (buf == NULL) {
+		loge("malloc failed");
+		return -ENOMEM;
+	}
+	rc = read_registers(spi_setup, address, count, buf);
+	if (rc < 0) {
+		loge("Failed to read %" PRIu64 " registers from address %"
+		     PRIx64, count, address);
+		goto out;
+	}
+	if (binary) {
+		if (fwrite(buf, REG_SIZE, count, stdout) != count) {
+			loge("could not write registers to stdout");
+			rc = -EIO;
+		}
+	} else {
+		registers_hexdump(address, count, buf, per_line);
+	}
+out:
+	free(buf);
+	return rc;
+}
+
+/* Binary register dump as produced by "reg read --binary" */
+static int reg_file_read(const char *file_name, uint8_t **buf,
+                         uint64_t *count)
+{
+	size_t len = 0, size = 0;
+	uint8_t *tmp;
+	FILE *f;
+	int rc = 0;
+
+	f = (strcmp(file_name, "-") == 0) ? stdin : fopen(file_name, "rb");
+	if (f == NULL) {
+		loge("could not open %s", file_name);
+		return -errno;
+	}
+	*buf = NULL;
+	do {
+		if (len > REG_COUNT_MAX * REG_SIZE) {
+			loge("%s is larger than the register space",
+			     file_name);
+			rc = -ERANGE;
+			goto out;
+		}
+		if (len == size) {
+			size = size ? 2 * size : 4096;
+			tmp = realloc(*buf, size);
+			if (tmp == NULL) {
+				loge("malloc failed");
+				rc = -ENOMEM;
+				goto out;
+			}
+			*buf = tmp;
+		}
+		len += fread(*buf + len, 1, size - len, f);
+	} while (!feof(f) && !ferror(f));
+	if (ferror(f)) {
+		loge("could not read %s", file_name);
+		rc = -EIO;
+	} else if (len == 0 || len % REG_SIZE) {
+		loge("%s does not hold whole 32-bit registers", file_name);
+		rc = -EINVAL;
+	}
+	*count = len / REG_SIZE;
+out:
+	if (rc < 0) {
+		free(*buf);
+		*buf = NULL;
+	}
+	if (f != stdin) {
+		fclose(f);
+	}
+	return rc;
+}
+
+static int reg_write_parse_args(struct sja1105_spi_setup *spi_setup,
+                                int argc, char **argv)
+{
+	uint64_t address;
+	uint64_t value;
+	uint64_t count = 0;
+	uint8_t *buf = NULL;
+	uint64_t i;
+	int rc;
+
+	if (argc < 2) {
+		return -EINVAL;
+	}
+	rc = reliable_uint64_from_string(&address, argv[0], NULL);
+	if (rc < 0) {
+		loge("could not read address param %s", argv[0]);
+		return rc;
+	}
+	argc--; argv++;
+	if (argc == 1 && (strcmp(argv[0], "-") == 0 ||
+	                  access(argv[0], F_OK) == 0)) {
+		rc = reg_file_read(argv[0], &buf, &count);
+		if (rc < 0) {
+			return rc;
+		}
+	} else {
+		count = argc;
+		rc = reg_range_check(address, count);
+		if (rc < 0) {
+			return rc;
+		}
+		buf = malloc(count * REG_SIZE);
+		if (buf == NULL) {
+			loge("malloc failed");
+			return -ENOMEM;
+		}
+		for (i = 0; i < count; i++) {
+			rc = reliable_uint64_from_string(&value, argv[i], NULL);
+			if (rc < 0 || value > 0xFFFFFFFF) {
+				loge("invalid register value %s", argv[i]);
+				rc = -EINVAL;
+				goto out;
+			}
+			reg_to_be(buf + i * REG_SIZE, value);
+		}
+	}
+	rc = reg_range_check(address, count);
+	if (rc < 0) {
+		goto out;
+	}
+	rc = write_registers(spi_setup, address, count, buf);
+	if (rc < 0) {
+		loge("Could not write %" PRIu64 " registers at address %"
+		     PRIx64, count, address);
+	}
+out:
+	free(buf);
+	return rc;
+}
+
 int reg_parse_args(struct sja1105_spi_setup *spi_setup,
                       int argc, char **argv)
 {
 	struct reg_cmd {
 		uint64_t address;
 		uint64_t data;
-		uint64_t count;
 	} reg_cmd;
 	int rc = 0;
-	uint64_t i;
 
 	if (argc < 1) {
 		rc = -EINVAL;
 		goto out_parse_error;
 	}
 
-	if (matches(argv[0], "dump") == 0) {
+	if (strcmp(argv[0], "read") == 0) {
+		rc = reg_read_parse_args(spi_setup, argc - 1, argv + 1, 4);
+		if (rc == -EINVAL) {
+			goto out_parse_error;
+		}
+		return rc;
+	} else if (strcmp(argv[0], "write") == 0) {
+		rc = reg_write_parse_args(spi_setup, argc - 1, argv + 1);
+		if (rc == -EINVAL) {
+			goto out_parse_error;
+		}
+		return rc;
+	} else if (matches(argv[0], "dump") == 0) {
 		/* consume the 'dump' parameter */
 		argc--; argv++;
 		if (argc != 2) {
 			loge("Please supply 2 parameters.");
 			goto out_parse_error;
 		}
-		rc = reliable_uint64_from_string(&reg_cmd.address,
-		                                 argv[0], NULL);
-		if (rc < 0) {
-			loge("could not read address param %s", argv[0]);
+		/* Same as "reg read <address> <count>", in the original
+		 * format of one register per line */
+		rc = reg_read_parse_args(spi_setup, argc, argv, 1);
+		if (rc == -EINVAL) {
 			goto out_parse_error;
-		}
-		rc = reliable_uint64_from_string(&reg_cmd.count,
-		                                 argv[1], NULL);
-		if (rc < 0) {
-			loge("could not read count param %s", argv[1]);
-			goto out_parse_error;
-		}
-		for (i = 0; i < reg_cmd.count; i++) {
-			rc = read_register(spi_setup, reg_cmd.address,
-			                   &reg_cmd.data);
-			if (rc < 0) {
-				loge("register address not read");
-				goto out_read_failed;
-			}
-			printf("0x%08" PRIx64 ": %08" PRIx64 "\n",
-			       reg_cmd.address + i, reg_cmd.data);
+		} else if (rc < 0) {
+			goto out_read_failed;
 		}
 	} else if (argc == 1) {
 		// perform a read...
@@ -0,0 +1,382 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include "internal.h"
+/* From libsja1105 */
+#include <common.h>
+
+/* Time intervals of the schedule are in units of 200 ns */
+#define SCHEDULE_DELTA_PER_MS   5000
+/* Subschedules are bounded by schedule-parameters-table SUBSCHEIND */
+#define SCHEDULE_MAX_CYCLES     8
+#define SCHEDULE_PORTS          5
+#define SCHEDULE_PRIOS          8
+
+static void print_usage()
+{
+	printf("Usage: sja1105-tool schedule compile [-f|--flush] [--force] <file.json>|-\n");
+	printf("The schedule is given as:\n"
+	       "{\n"
+	       "  \"clksrc\": \"disabled\"|\"standalone\"|\"as6802\"|\"ptp\",\n"
+	       "  \"cycles\": [ {\n"
+	       "    \"start-time-ms\": <ms>,\n"
+	       "    \"timeslots\": [ {\n"
+	       "      \"duration-ms\": <ms>,\n"
+	       "      \"ports\": [<port>, ...],\n"
+	       "      \"gates-open\": [<prio>, ...],\n"
+	       "      \"vl-window\": <index> (optional)\n"
+	       "    }, ... ]\n"
+	       "  }, ... ]\n"
+	       "}\n");
+}
+
+static int schedule_error(struct sja1105_json *json, int token,
+                          const char *what)
+{
+	loge("%s:%d: %s", json->name,
+	     (token >= 0) ? json->tokens[token].line : 0, what);
+	return -EINVAL;
+}
+
+/* Required member of an object, of the given type */
+static int schedule_member(struct sja1105_json *json, int object,
+                           const char *name, int array)
+{
+	char what[MAX_LINE_SIZE];
+	int token;
+
+	token = sja1105_json_member(json, object, name);
+	if (token < 0 || (array && json->tokens[token].type !=
+	                  SJA1105_JSON_ARRAY)) {
+		snprintf(what, sizeof(what), "expected %s\"%s\"",
+		         array ? "an array " : "", name);
+		return schedule_error(json, object, what);
+	}
+	return token;
+}
+
+/* Time in ms, to a nonzero number of schedule delta units */
+static int schedule_delta(struct sja1105_json *json, int object,
+                          const char *name, uint64_t *delta)
+{
+	int rounded;
+	int token;
+	int rc;
+
+	token = schedule_member(json, object, name, 0);
+	if (token < 0) {
+		return token;
+	}
+	rc = sja1105_json_fixed(json, token, SCHEDULE_DELTA_PER_MS, delta,
+	                        &rounded);
+	if (rc < 0) {
+		return rc;
+	}
+	if (rounded) {
+		logi("%s:%d: %s rounded to a multiple of 200 ns", json->name,
+		     json->tokens[token].line, name);
+	}
+	if (*delta == 0) {
+		return schedule_error(json, token, "time interval of 0 not allowed");
+	}
+	return 0;
+}
+
+/* Array of small integers, to a bit mask */
+static int schedule_mask(struct sja1105_json *json, int object,
+                         const char *name, int max, uint64_t *mask)
+{
+	uint64_t value;
+	int array;
+	int token;
+	int rc;
+
+	array = schedule_member(json, object, name, 1);
+	if (array < 0) {
+		return array;
+	}
+	*mask = 0;
+	for (token = sja1105_json_child(json, array); token >= 0;
+	     token = sja1105_json_sibling(json, token)) {
+		rc = sja1105_json_u64(json, token, &value);
+		if (rc < 0) {
+			return rc;
+		}
+		if (value >= (uint64_t) max) {
+			return schedule_error(json, token, "value out of range");
+		}
+		*mask |= 1ull << value;
+	}
+	return 0;
+}
+
+static int schedule_clksrc(struct sja1105_json *json, int root,
+                           uint64_t *clksrc)
+{
+	const char *names[] = {
+		"disabled",
+		"standalone",
+		"as6802",
+		"ptp",
+	};
+	int token;
+	int i;
+
+	token = schedule_member(json, root, "clksrc", 0);
+	if (token < 0) {
+		return token;
+	}
+	for (i = 0; i < (int) ARRAY_SIZE(names); i++) {
+		if (sja1105_json_eq(json, token, names[i])) {
+			*clksrc = i;
+			return 0;
+		}
+	}
+	return schedule_error(json, token, "unknown clksrc value");
+}
+
+static int schedule_timeslot_compile(struct sja1105_json *json, int timeslot,
+                                     struct sja1105_schedule_entry *entry,
+                                     int64_t *window)
+{
+	uint64_t gates_open;
+	uint64_t index;
+	int token;
+	int rc;
+
+	if (json->tokens[timeslot].type != SJA1105_JSON_OBJECT) {
+		return schedule_error(json, timeslot, "expected a timeslot object");
+	}
+	memset(entry, 0, sizeof(*entry));
+	rc = schedule_delta(json, timeslot, "duration-ms", &entry->delta);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = schedule_mask(json, timeslot, "ports", SCHEDULE_PORTS,
+	                   &entry->destports);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = schedule_mask(json, timeslot, "gates-open", SCHEDULE_PRIOS,
+	                   &gates_open);
+	if (rc < 0) {
+		return rc;
+	}
+	/* RESMEDIA holds the gates that are closed */
+	entry->resmedia_en = 1;
+	entry->resmedia = ~gates_open & 0xFF;
+	/* Resolved into WINST and WINEND once the cycle is complete */
+	*window = -1;
+	token = sja1105_json_member(json, timeslot, "vl-window");
+	if (token >= 0) {
+		rc = sja1105_json_u64(json, token, &index);
+		if (rc < 0) {
+			return rc;
+		}
+		*window = index;
+		entry->winstindex = index;
+	}
+	return 0;
+}
+
+/* A virtual link reception window is open from the first to the last
+ * of consecutive timeslots of a cycle which name the same window.
+ */
+static void schedule_windows_resolve(struct sja1105_schedule_entry *entries,
+                                     int64_t *windows, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		if (windows[i] < 0) {
+			continue;
+		}
+		entries[i].winst  = (i == 0 || windows[i - 1] != windows[i]);
+		entries[i].winend = (i == count - 1 ||
+		                     windows[i + 1] != windows[i]);
+	}
+}
+
+static int schedule_compile(struct sja1105_static_config *config,
+                            struct sja1105_json *json)
+{
+	struct sja1105_schedule_entry_points_entry *entry_point;
+	static int64_t windows[MAX_SCHEDULE_COUNT];
+	uint64_t clksrc = 0;
+	int cycles, cycle;
+	int timeslots, timeslot;
+	int num_cycles = 0;
+	int start;
+	int k = 0;
+	int rc;
+	int i;
+
+	if (json->tokens[0].type != SJA1105_JSON_OBJECT) {
+		return schedule_error(json, 0, "expected an object");
+	}
+	rc = schedule_clksrc(json, 0, &clksrc);
+	if (rc < 0) {
+		return rc;
+	}
+	cycles = schedule_member(json, 0, "cycles", 1);
+	if (cycles < 0) {
+		return cycles;
+	}
+	if (json->tokens[cycles].size == 0) {
+		return schedule_error(json, cycles, "no cycles");
+	}
+	if (json->tokens[cycles].size > SCHEDULE_MAX_CYCLES ||
+	    json->tokens[cycles].size > MAX_SCHEDULE_ENTRY_POINTS_COUNT) {
+		return schedule_error(json, cycles, "too many cycles, at most 8");
+	}
+	for (cycle = sja1105_json_child(json, cycles); cycle >= 0;
+	     cycle = sja1105_json_sibling(json, cycle), num_cycles++) {
+		if (json->tokens[cycle].type != SJA1105_JSON_OBJECT) {
+			return schedule_error(json, cycle, "expected a cycle object");
+		}
+		entry_point = &config->schedule_entry_points[num_cycles];
+		memset(entry_point, 0, sizeof(*entry_point));
+		rc = schedule_delta(json, cycle, "start-time-ms",
+		                    &entry_point->delta);
+		if (rc < 0) {
+			return rc;
+		}
+		timeslots = schedule_member(json, cycle, "timeslots", 1);
+		if (timeslots < 0) {
+			return timeslots;
+		}
+		if (json->tokens[timeslots].size == 0) {
+			return schedule_error(json, timeslots, "no timeslots");
+		}
+		if (k + json->tokens[timeslots].size > MAX_SCHEDULE_COUNT) {
+			return schedule_error(json, timeslots,
+			                      "too many timeslots, at most 1024");
+		}
+		start = k;
+		for (timeslot = sja1105_json_child(json, timeslots);
+		     timeslot >= 0;
+		     timeslot = sja1105_json_sibling(json, timeslot), k++) {
+			rc = schedule_timeslot_compile(json, timeslot,
+			                               &config->schedule[k],
+			                               &windows[k]);
+			if (rc < 0) {
+				return rc;
+			}
+		}
+		schedule_windows_resolve(&config->schedule[start],
+		                         &windows[start], k - start);
+		entry_point->subschindx = num_cycles;
+		entry_point->address = start;
+		/* Subschedule i, and any unused one after it, ends
+		 * at the last timeslot of cycle i */
+		for (i = num_cycles; i < SCHEDULE_MAX_CYCLES; i++) {
+			config->schedule_params[0].subscheind[i] = k - 1;
+		}
+	}
+	config->schedule_count = k;
+	config->schedule_entry_points_count = num_cycles;
+	config->schedule_params_count = 1;
+	config->schedule_entry_points_params_count = 1;
+	config->schedule_entry_points_params[0].clksrc = clksrc;
+	config->schedule_entry_points_params[0].actsubsch = num_cycles - 1;
+	logi("Compiled %d cycles, %d timeslots", num_cycles, k);
+	return sja1105_static_config_check(config);
+}
+
+int schedule_parse_args(struct sja1105_spi_setup *spi_setup,
+                        int argc, char **argv)
+{
+	struct sja1105_staging_area staging_area;
+	struct sja1105_json json;
+	int force = 0;
+	int rc = SJA1105_ERR_OK;
+
+	memset(&json, 0, sizeof(json));
+	if (argc < 1 || strcmp(argv[0], "compile") != 0) {
+		goto parse_error;
+	}
+	argc--; argv++;
+	get_flush_mode(spi_setup, &force, &argc, &argv);
+	if (argc != 1) {
+		goto parse_error;
+	}
+	rc = sja1105_json_load(&json, argv[0]);
+	if (rc < 0) {
+		goto invalid_schedule_error;
+	}
+	rc = staging_area_load(spi_setup->staging_area, &staging_area);
+	if (rc < 0) {
+		goto out;
+	}
+	/* All the schedule tables are rewritten in memory, and only
+	 * saved if the whole schedule is valid */
+	rc = schedule_compile(&staging_area.static_config, &json);
+	if (rc < 0) {
+		goto invalid_schedule_error;
+	}
+	rc = staging_area_save_needed(spi_setup, &staging_area, force);
+	if (rc < 0) {
+		goto filesystem_error;
+	}
+	if (rc == 0) {
+		goto out;
+	}
+	rc = staging_area_save(spi_setup->staging_area, &staging_area);
+	if (rc < 0) {
+		goto filesystem_error;
+	}
+	if (spi_setup->flush) {
+		rc = staging_area_flush(spi_setup);
+		if (rc < 0) {
+			goto hardware_left_floating_staging_area_dirty_error;
+		}
+	}
+	rc = SJA1105_ERR_OK;
+out:
+	sja1105_json_free(&json);
+	return rc;
+invalid_schedule_error:
+	sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+	goto out;
+filesystem_error:
+	sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
+	goto out;
+hardware_left_floating_staging_area_dirty_error:
+	sja1105_err_remap(rc, SJA1105_ERR_UPLOAD_FAILED_HW_LEFT_FLOATING_STAGING_AREA_DIRTY);
+	goto out;
+parse_error:
+	sja1105_err_remap(rc, SJA1105_ERR_CMDLINE_PARSE);
+	print_usage();
+	goto out;
+}
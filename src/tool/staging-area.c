@@ -30,11 +30,15 @@
  *****************************************************************************/
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
+#include <libgen.h>
+#include <limits.h>
+#include <errno.h>
 #include <inttypes.h>
 #include "internal.h"
 /* From libsja1105 */
@@ -59,57 +63,141 @@ out:
 	return rc;
 }
 
-static int reliable_read(int fd, char *buf, int len)
-{
-	int bytes = 0;
-	int rc;
-
-	do {
-		rc = read(fd, buf + bytes, len - bytes);
-		if (rc < 0) {
-			loge("read failed");
-			goto out;
-		}
-		bytes += rc;
-	} while (rc);
-out:
-	return rc;
-}
-
-int
-staging_area_hexdump(const char *staging_area_file)
+/* Map the staging area file read-only, so that it can be unpacked
+ * straight from the page cache. The mapping outlives the descriptor.
+ */
+static int
+staging_area_map(const char *staging_area_file, void **buf, size_t *len)
 {
 	struct stat stat;
-	unsigned int len;
-	char *buf;
-	int rc = 0, fd;
+	int rc, fd;
 
 	fd = open(staging_area_file, O_RDONLY);
 	if (fd < 0) {
 		loge("Staging area %s does not exist!", staging_area_file);
-		sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
-		goto out;
+		return -errno;
 	}
-
 	rc = fstat(fd, &stat);
 	if (rc < 0) {
 		loge("could not read file size");
-		sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
-		goto out_close;
+		rc = -errno;
+		goto out;
 	}
+	if (stat.st_size < SIZE_SJA1105_DEVICE_ID) {
+		loge("Staging area %s is truncated", staging_area_file);
+		rc = -EINVAL;
+		goto out;
+	}
+	*len = stat.st_size;
+	*buf = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (*buf == MAP_FAILED) {
+		loge("could not map %s", staging_area_file);
+		rc = -errno;
+		goto out;
+	}
+	rc = 0;
+out:
+	close(fd);
+	return rc;
+}
+
+/* When the resident staging area is active (sja1105-tool batch and the
+ * sja1105d daemon), staging_area_load() and staging_area_save() calls on
+ * the same file are served from memory. The file is only written back
+ * by staging_area_resident_sync().
+ */
+static struct {
+	const char                  *file;
+	struct sja1105_staging_area *staging_area;
+	int                          valid;
+	int                          dirty;
+	/* Packed form of staging_area, or NULL if not known */
+	uint8_t                     *buf;
+	size_t                       len;
+} resident;
+
+/* The packed form of the staging area last compared against the file by
+ * staging_area_unchanged(), which the staging_area_save() right after it
+ * writes out instead of packing the staging area a second time.
+ */
+static struct {
+	struct sja1105_staging_area *staging_area;
+	uint8_t                     *buf;
+	size_t                       len;
+	int                          unchanged;
+} packed;
 
-	len = stat.st_size;
-	buf = (char*) malloc(len * sizeof(char));
-	if (!buf) {
+static uint64_t fingerprint_buf(const uint8_t *buf, size_t len)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= buf[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static int
+staging_area_pack(struct sja1105_staging_area *staging_area,
+                  uint8_t **buf, size_t *len)
+{
+	struct sja1105_static_config *static_config;
+	int prof;
+	int rc;
+
+	static_config = &staging_area->static_config;
+	*len = sja1105_static_config_get_length(static_config);
+
+	*buf = (uint8_t*) malloc(*len * sizeof(uint8_t));
+	if (!*buf) {
 		loge("malloc failed");
-		sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
-		goto out_free_close;
+		return -ENOMEM;
+	}
+	logv("packing static config... %zu bytes", *len);
+	prof = sja1105_profile_begin("pack", NULL);
+	rc = sja1105_static_config_pack(*buf, static_config);
+	sja1105_profile_end(prof);
+	if (rc < 0) {
+		loge("sja1105_static_config_pack failed");
+		free(*buf);
+		*buf = NULL;
+		return rc;
 	}
+	return 0;
+}
 
-	rc = reliable_read(fd, buf, len);
+void staging_area_packed_drop(void)
+{
+	free(packed.buf);
+	memset(&packed, 0, sizeof(packed));
+}
+
+static int
+resident_matches(const char *staging_area_file)
+{
+	return (resident.staging_area != NULL &&
+	        strcmp(resident.file, staging_area_file) == 0);
+}
+
+int
+staging_area_hexdump(const char *staging_area_file)
+{
+	size_t len;
+	void *buf;
+	int rc = 0;
+
+	if (resident_matches(staging_area_file)) {
+		rc = staging_area_resident_sync();
+		if (rc < 0) {
+			goto out;
+		}
+	}
+	rc = staging_area_map(staging_area_file, &buf, &len);
 	if (rc < 0) {
 		sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
-		goto out_free_close;
+		goto out;
 	}
 
 	printf("Static configuration:\n");
@@ -119,15 +207,13 @@ staging_area_hexdump(const char *staging_area_file)
 	if (rc < 0) {
 		loge("error while interpreting config");
 		sja1105_err_remap(rc, SJA1105_ERR_STAGING_AREA_INVALID);
-		goto out;
+		goto out_unmap;
 	}
 
 	logi("static config: dumped %d bytes", rc);
 
-out_free_close:
-	free(buf);
-out_close:
-	close(fd);
+out_unmap:
+	munmap(buf, len);
 out:
 	return rc;
 }
@@ -309,54 +395,42 @@ sja1105_default_staging_area(struct sja1105_staging_area *staging_area,
 	return rc;
 }
 
-int
-staging_area_load(const char *staging_area_file,
-                  struct sja1105_staging_area *staging_area)
+/* If packed_buf is not NULL, it is set to a copy of the file contents */
+static int
+staging_area_read(const char *staging_area_file,
+                  struct sja1105_staging_area *staging_area,
+                  uint8_t **packed_buf, size_t *packed_len)
 {
-	struct sja1105_static_config *static_config;
-	struct stat stat;
-	unsigned int staging_area_len;
-	char *buf;
-	int fd;
+	size_t staging_area_len;
+	void *buf;
+	int prof;
 	int rc;
 
-	static_config = &staging_area->static_config;
-
-	fd = open(staging_area_file, O_RDONLY);
-	if (fd < 0) {
-		loge("Staging area %s does not exist!", staging_area_file);
-		rc = fd;
-		goto filesystem_error1;
-	}
-	rc = fstat(fd, &stat);
-	if (rc < 0) {
-		loge("could not read file size");
-		goto filesystem_error2;
-	}
-	staging_area_len = stat.st_size;
-	buf = (char*) malloc(staging_area_len * sizeof(char));
-	if (!buf) {
-		loge("malloc failed");
-		goto filesystem_error2;
-	}
-	rc = reliable_read(fd, buf, staging_area_len);
+	prof = sja1105_profile_begin("map", NULL);
+	rc = staging_area_map(staging_area_file, &buf, &staging_area_len);
+	sja1105_profile_end(prof);
 	if (rc < 0) {
-		loge("failed to read staging area from file %s",
-		     staging_area_file);
-		goto filesystem_error3;
+		goto filesystem_error;
 	}
 	/* Static config */
-	rc = sja1105_static_config_unpack(buf, staging_area_len, static_config);
+	prof = sja1105_profile_begin("unpack", NULL);
+	rc = sja1105_static_config_unpack(buf, staging_area_len,
+	                                  &staging_area->static_config);
+	sja1105_profile_end(prof);
+	if (rc >= 0 && packed_buf != NULL) {
+		*packed_buf = malloc(staging_area_len);
+		if (*packed_buf != NULL) {
+			memcpy(*packed_buf, buf, staging_area_len);
+			*packed_len = staging_area_len;
+		}
+	}
+	munmap(buf, staging_area_len);
 	if (rc < 0) {
 		loge("error while interpreting config");
 		goto invalid_staging_area_error;
 	}
 	return 0;
-filesystem_error3:
-	free(buf);
-filesystem_error2:
-	close(fd);
-filesystem_error1:
+filesystem_error:
 	sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
 	return rc;
 invalid_staging_area_error:
@@ -364,57 +438,534 @@ invalid_staging_area_error:
 	return rc;
 }
 
-int
-staging_area_save(const char *staging_area_file,
-                  struct sja1105_staging_area *staging_area)
+/* Flush the rename of the staging area to disk as well */
+static int
+staging_area_dir_sync(const char *staging_area_file)
 {
-	struct sja1105_static_config *static_config;
+	char *path, *dir;
+	int rc, fd;
+
+	path = strdup(staging_area_file);
+	if (!path) {
+		return -ENOMEM;
+	}
+	dir = dirname(path);
+	fd = open(dir, O_RDONLY | O_DIRECTORY);
+	if (fd < 0) {
+		rc = -errno;
+		goto out;
+	}
+	rc = fsync(fd);
+	if (rc < 0) {
+		rc = -errno;
+	}
+	close(fd);
+out:
+	if (rc < 0) {
+		loge("could not sync directory %s", dir);
+	}
+	free(path);
+	return rc;
+}
+
+/* Follow a chain of symbolic links whose last target does not exist
+ * (yet), which realpath() refuses to resolve */
+static int
+staging_area_dangling_target(const char *staging_area_file, char *target)
+{
+	char link[PATH_MAX];
+	char base[PATH_MAX];
+	char *dir;
+	ssize_t len;
+	int depth;
+	int rc;
+
+	rc = snprintf(target, PATH_MAX, "%s", staging_area_file);
+	if (rc >= PATH_MAX) {
+		goto too_long;
+	}
+	for (depth = 0; depth < 40; depth++) {
+		len = readlink(target, link, sizeof(link) - 1);
+		if (len < 0) {
+			/* Not a link (anymore): the file to create */
+			return 0;
+		}
+		link[len] = '\0';
+		if (link[0] == '/') {
+			rc = snprintf(target, PATH_MAX, "%s", link);
+		} else {
+			/* Relative to the directory of the link */
+			memcpy(base, target, PATH_MAX);
+			dir = dirname(base);
+			rc = snprintf(target, PATH_MAX, "%s/%s", dir, link);
+		}
+		if (rc >= PATH_MAX) {
+			goto too_long;
+		}
+	}
+	loge("too many levels of symbolic links in %s", staging_area_file);
+	return -ELOOP;
+too_long:
+	loge("staging area path %s too long", staging_area_file);
+	return -ENAMETOOLONG;
+}
+
+/* The new file takes the place of the one the path resolves to, so
+ * that a staging area which is a symbolic link (e.g. into
+ * /lib/firmware) stays one, and it keeps the permissions of the file
+ * it replaces. */
+static int
+staging_area_target_get(const char *staging_area_file, char *target,
+                        mode_t *mode)
+{
+	struct stat st;
+	mode_t mask;
+	int rc;
+
+	if (realpath(staging_area_file, target) == NULL) {
+		if (errno != ENOENT) {
+			rc = -errno;
+			loge("could not resolve %s", staging_area_file);
+			return rc;
+		}
+		/* Saved for the first time, possibly through a link */
+		rc = staging_area_dangling_target(staging_area_file, target);
+		if (rc < 0) {
+			return rc;
+		}
+		/* As if it had been created with open() */
+		mask = umask(0);
+		umask(mask);
+		*mode = 0666 & ~mask;
+		return 0;
+	}
+	if (stat(target, &st) < 0) {
+		rc = -errno;
+		loge("could not stat %s", target);
+		return rc;
+	}
+	*mode = st.st_mode & 07777;
+	return 0;
+}
+
+/* The staging area is first written to a temporary file next to it,
+ * which is then renamed over the old one. Readers (and a crash in the
+ * middle of the write) only ever see either the old or the new file.
+ */
+static int
+staging_area_write_buf(const char *staging_area_file,
+                       uint8_t *buf, size_t staging_area_len)
+{
+	char  target[PATH_MAX];
+	char  tmp_file[PATH_MAX];
+	mode_t mode = 0;
 	int   rc = 0;
-	char *buf;
-	int   static_config_len;
-	int   staging_area_len;
+	int   prof;
 	int   fd;
 
-	static_config     = &staging_area->static_config;
-	static_config_len = sja1105_static_config_get_length(static_config);
-	staging_area_len  = static_config_len;
-
-	buf = (char*) malloc(staging_area_len * sizeof(char));
-	if (!buf) {
-		loge("malloc failed");
+	logv("total staging area size: %zu bytes", staging_area_len);
+	rc = staging_area_target_get(staging_area_file, target, &mode);
+	if (rc < 0) {
+		goto out_1;
+	}
+	rc = snprintf(tmp_file, sizeof(tmp_file), "%s.XXXXXX", target);
+	if (rc >= (int) sizeof(tmp_file)) {
+		loge("staging area path %s too long", target);
+		rc = -ENAMETOOLONG;
 		goto out_1;
 	}
-	logv("saving static config... %d bytes", static_config_len);
-	rc = sja1105_static_config_pack(buf, static_config);
+	fd = mkstemp(tmp_file);
+	if (fd < 0) {
+		loge("could not open %s for write", tmp_file);
+		rc = -errno;
+		goto out_1;
+	}
+	/* mkstemp creates the file as 0600 */
+	rc = fchmod(fd, mode);
 	if (rc < 0) {
-		loge("sja1105_static_config_pack failed");
+		loge("could not set permissions of %s", tmp_file);
+		rc = -errno;
 		goto out_2;
 	}
-
-	logv("total staging area size: %d bytes", staging_area_len);
-	fd = open(staging_area_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-	if (fd < 0) {
-		loge("could not open %s for write", staging_area_file);
-		rc = fd;
+	prof = sja1105_profile_begin("write", NULL);
+	rc = reliable_write(fd, (char*) buf, staging_area_len);
+	sja1105_profile_end(prof);
+	if (rc < 0) {
 		goto out_2;
 	}
-
-	rc = reliable_write(fd, buf, staging_area_len);
+	if (general_config.fsync) {
+		prof = sja1105_profile_begin("fsync", NULL);
+		rc = fsync(fd);
+		sja1105_profile_end(prof);
+		if (rc < 0) {
+			loge("could not sync %s", tmp_file);
+			rc = -errno;
+			goto out_2;
+		}
+	}
+	rc = close(fd);
+	fd = -1;
+	if (rc < 0) {
+		loge("could not close %s", tmp_file);
+		rc = -errno;
+		goto out_2;
+	}
+	prof = sja1105_profile_begin("rename", NULL);
+	rc = rename(tmp_file, target);
+	sja1105_profile_end(prof);
 	if (rc < 0) {
+		loge("could not rename %s to %s", tmp_file, target);
+		rc = -errno;
 		goto out_2;
 	}
+	if (general_config.fsync) {
+		prof = sja1105_profile_begin("fsync", NULL);
+		rc = staging_area_dir_sync(target);
+		sja1105_profile_end(prof);
+		if (rc < 0) {
+			goto out_1;
+		}
+	}
 	logv("done");
-
-	close(fd);
+	goto out_1;
 out_2:
-	free(buf);
+	if (fd >= 0) {
+		close(fd);
+	}
+	unlink(tmp_file);
 out_1:
 	return rc;
 }
 
+static int
+staging_area_write(const char *staging_area_file,
+                   struct sja1105_staging_area *staging_area)
+{
+	size_t len;
+	uint8_t *buf;
+	int rc;
+
+	rc = staging_area_pack(staging_area, &buf, &len);
+	if (rc < 0) {
+		return rc;
+	}
+	rc = staging_area_write_buf(staging_area_file, buf, len);
+	free(buf);
+	return rc;
+}
+
+int
+staging_area_load(const char *staging_area_file,
+                  struct sja1105_staging_area *staging_area)
+{
+	int rc;
+
+	/* A new command: whatever was packed for the last one is stale */
+	staging_area_packed_drop();
+
+	if (!resident_matches(staging_area_file)) {
+		return staging_area_read(staging_area_file, staging_area,
+		                         NULL, NULL);
+	}
+	if (!resident.valid) {
+		/* Staging area file might have appeared in the meantime */
+		rc = staging_area_read(staging_area_file, resident.staging_area,
+		                       &resident.buf, &resident.len);
+		if (rc < 0) {
+			return rc;
+		}
+		resident.valid = 1;
+	}
+	memcpy(staging_area, resident.staging_area, sizeof(*staging_area));
+	return 0;
+}
+
+int
+staging_area_save(const char *staging_area_file,
+                  struct sja1105_staging_area *staging_area)
+{
+	uint8_t *buf = NULL;
+	size_t len = 0;
+	int unchanged = 0;
+	int rc = 0;
+
+	if (packed.staging_area == staging_area) {
+		/* Packed already by staging_area_unchanged() */
+		buf       = packed.buf;
+		len       = packed.len;
+		unchanged = packed.unchanged;
+		packed.buf = NULL;
+		staging_area_packed_drop();
+	}
+	if (unchanged) {
+		logv("staging area unchanged, not rewriting it");
+		goto out;
+	}
+	if (!resident_matches(staging_area_file)) {
+		if (buf != NULL) {
+			rc = staging_area_write_buf(staging_area_file, buf, len);
+		} else {
+			rc = staging_area_write(staging_area_file, staging_area);
+		}
+		goto out;
+	}
+	if (staging_area != resident.staging_area) {
+		memcpy(resident.staging_area, staging_area, sizeof(*staging_area));
+	}
+	free(resident.buf);
+	resident.buf   = buf;
+	resident.len   = len;
+	resident.valid = 1;
+	resident.dirty = 1;
+	return 0;
+out:
+	free(buf);
+	return rc;
+}
+
+int
+staging_area_resident_init(const char *staging_area_file)
+{
+	resident.staging_area = malloc(sizeof(*resident.staging_area));
+	if (resident.staging_area == NULL) {
+		loge("malloc failed");
+		return -ENOMEM;
+	}
+	resident.file  = staging_area_file;
+	resident.dirty = 0;
+	resident.buf   = NULL;
+	/* A missing or invalid staging area is not fatal here:
+	 * commands such as "config new" or "config load" will
+	 * create it. */
+	resident.valid = (staging_area_read(staging_area_file,
+	                                    resident.staging_area,
+	                                    &resident.buf,
+	                                    &resident.len) == 0);
+	return 0;
+}
+
+int staging_area_resident_active(void)
+{
+	return (resident.staging_area != NULL);
+}
+
+int staging_area_resident_dirty(void)
+{
+	return (resident.staging_area != NULL && resident.dirty);
+}
+
+int staging_area_resident_sync(void)
+{
+	int rc;
+
+	if (!staging_area_resident_dirty()) {
+		return 0;
+	}
+	if (resident.buf != NULL) {
+		rc = staging_area_write_buf(resident.file, resident.buf,
+		                            resident.len);
+	} else {
+		rc = staging_area_write(resident.file, resident.staging_area);
+	}
+	if (rc < 0) {
+		sja1105_err_remap(rc, SJA1105_ERR_FILESYSTEM);
+		return rc;
+	}
+	resident.dirty = 0;
+	return 0;
+}
+
+void staging_area_resident_free(void)
+{
+	free(resident.staging_area);
+	free(resident.buf);
+	memset(&resident, 0, sizeof(resident));
+	staging_area_packed_drop();
+}
+
+/* Fingerprint of a staging area is the 64-bit FNV-1a hash of its packed
+ * (on-disk) representation, so two staging areas have the same
+ * fingerprint iff they produce the same firmware file (barring hash
+ * collisions). A CRC32 is no good here, since every packed table
+ * already ends with its own CRC and the residue would be constant.
+ */
+int staging_area_fingerprint(struct sja1105_staging_area *staging_area,
+                             uint64_t *fingerprint)
+{
+	size_t len;
+	uint8_t *buf;
+	int rc;
+
+	rc = staging_area_pack(staging_area, &buf, &len);
+	if (rc < 0) {
+		return rc;
+	}
+	*fingerprint = fingerprint_buf(buf, len);
+	free(buf);
+	return 0;
+}
+
+/* Returns 1 if saving staging_area would leave staging_area_file with the
+ * same contents, and 0 if it would change it or there is no staging area
+ * yet. The staging area is packed only once: the file is compared with
+ * the packed buffer as is, and the following staging_area_save() writes
+ * that same buffer.
+ */
+int staging_area_unchanged(const char *staging_area_file,
+                           struct sja1105_staging_area *staging_area)
+{
+	uint8_t *old_buf = NULL;
+	size_t old_len = 0;
+	int unchanged = 0;
+	uint8_t *buf;
+	size_t len;
+	void *map;
+	int rc;
+
+	staging_area_packed_drop();
+
+	rc = staging_area_pack(staging_area, &buf, &len);
+	if (rc < 0) {
+		return rc;
+	}
+	if (resident_matches(staging_area_file) && resident.valid) {
+		if (resident.buf == NULL) {
+			rc = staging_area_pack(resident.staging_area,
+			                       &resident.buf, &resident.len);
+			if (rc < 0) {
+				free(buf);
+				return rc;
+			}
+		}
+		old_buf = resident.buf;
+		old_len = resident.len;
+		unchanged = (old_len == len && memcmp(old_buf, buf, len) == 0);
+	} else if (access(staging_area_file, F_OK) == 0 &&
+	           staging_area_map(staging_area_file, &map, &old_len) == 0) {
+		/* A file which cannot be mapped just gets overwritten */
+		unchanged = (old_len == len && memcmp(map, buf, len) == 0);
+		munmap(map, old_len);
+	}
+	packed.staging_area = staging_area;
+	packed.buf          = buf;
+	packed.len          = len;
+	packed.unchanged    = unchanged;
+	return unchanged;
+}
+
+/* The fingerprint of the staging area last uploaded to the switch is
+ * recorded next to it, so that re-applying an unchanged staging area
+ * only skips the upload if the switch is already running it.
+ */
+static int
+upload_record_path(const char *staging_area_file, char *path)
+{
+	int rc;
+
+	rc = snprintf(path, PATH_MAX, "%s.uploaded", staging_area_file);
+	if (rc >= PATH_MAX) {
+		loge("staging area path %s too long", staging_area_file);
+		return -ENAMETOOLONG;
+	}
+	return 0;
+}
+
+/* Called before an upload, which leaves the switch in an unknown
+ * state until it completes */
+void staging_area_upload_forget(const char *staging_area_file)
+{
+	char path[PATH_MAX];
+
+	if (upload_record_path(staging_area_file, path) < 0) {
+		return;
+	}
+	if (unlink(path) < 0 && errno != ENOENT) {
+		loge("could not remove %s", path);
+	}
+}
+
+/* Called after a successful upload. The kernel driver read the
+ * staging area from the file, so that is what gets fingerprinted. */
+void staging_area_upload_record(const char *staging_area_file)
+{
+	char path[PATH_MAX];
+	size_t len;
+	FILE *fp;
+	void *buf;
+	int rc;
+
+	if (upload_record_path(staging_area_file, path) < 0) {
+		return;
+	}
+	rc = staging_area_map(staging_area_file, &buf, &len);
+	if (rc < 0) {
+		return;
+	}
+	fp = fopen(path, "w");
+	if (fp == NULL) {
+		loge("could not open %s for write", path);
+		goto out;
+	}
+	fprintf(fp, "%016" PRIx64 "\n", fingerprint_buf(buf, len));
+	if (fclose(fp) != 0) {
+		loge("could not write %s", path);
+		unlink(path);
+	}
+out:
+	munmap(buf, len);
+}
+
+/* Returns 1 if staging_area is what was last uploaded to the switch from
+ * staging_area_file. Must follow a staging_area_unchanged() call on the
+ * same staging area, whose packed buffer it fingerprints.
+ */
+int staging_area_uploaded(const char *staging_area_file,
+                          struct sja1105_staging_area *staging_area)
+{
+	char path[PATH_MAX];
+	uint64_t uploaded;
+	FILE *fp;
+	int rc;
+
+	if (packed.staging_area != staging_area || packed.buf == NULL) {
+		return 0;
+	}
+	if (upload_record_path(staging_area_file, path) < 0) {
+		return 0;
+	}
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		return 0;
+	}
+	rc = fscanf(fp, "%" SCNx64, &uploaded);
+	fclose(fp);
+	if (rc != 1) {
+		return 0;
+	}
+	return (uploaded == fingerprint_buf(packed.buf, packed.len));
+}
+
 int staging_area_flush(struct sja1105_spi_setup *spi_setup)
 {
 	char *value = "1";
-	return sysfs_write(spi_setup, "config_upload", value, strlen(value));
+	int rc;
+
+	/* The kernel driver reads the staging area from the filesystem */
+	rc = staging_area_resident_sync();
+	if (rc < 0) {
+		return rc;
+	}
+	if (spi_setup->defer_flush) {
+		/* Uploaded later, together with the other devices */
+		spi_setup->flush_pending = 1;
+		return 0;
+	}
+	staging_area_upload_forget(spi_setup->staging_area);
+	rc = sysfs_write(spi_setup, "config_upload", value, strlen(value));
+	if (rc < 0) {
+		return rc;
+	}
+	staging_area_upload_record(spi_setup->staging_area);
+	return rc;
 }
 
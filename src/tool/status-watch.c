@@ -0,0 +1,349 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include "internal.h"
+#include <common.h>
+
+/* Number of switch ports */
+#define WATCH_PORT_COUNT 5
+#define WATCH_QUEUE_COUNT 8
+
+enum watch_counter {
+	WATCH_RX_FRAMES = 0,
+	WATCH_RX_BYTES,
+	WATCH_TX_FRAMES,
+	WATCH_TX_BYTES,
+	WATCH_DROPS,
+	WATCH_COUNTER_COUNT,
+};
+
+static const char *watch_counter_names[] = {
+	[WATCH_RX_FRAMES] = "rx_frames",
+	[WATCH_RX_BYTES]  = "rx_bytes",
+	[WATCH_TX_FRAMES] = "tx_frames",
+	[WATCH_TX_BYTES]  = "tx_bytes",
+	[WATCH_DROPS]     = "drops",
+};
+
+/* Port status fields that add up to each watched counter,
+ * with the width of the hardware counter behind them */
+static const struct watch_source {
+	const char *name;
+	enum watch_counter counter;
+	int width;
+} watch_sources[] = {
+	/* The kernel module concatenates the two 32-bit halves */
+	{ "n_rxfrm",        WATCH_RX_FRAMES, 64 },
+	{ "n_rxbyte",       WATCH_RX_BYTES,  64 },
+	{ "n_txfrm",        WATCH_TX_FRAMES, 64 },
+	{ "n_txbyte",       WATCH_TX_BYTES,  64 },
+	{ "n_n664err",      WATCH_DROPS,     32 },
+	{ "n_vlanerr",      WATCH_DROPS,     32 },
+	{ "n_sizerr",       WATCH_DROPS,     32 },
+	{ "n_crcerr",       WATCH_DROPS,     32 },
+	{ "n_vlnotfound",   WATCH_DROPS,     32 },
+	{ "n_ctpolerr",     WATCH_DROPS,     32 },
+	{ "n_polerr",       WATCH_DROPS,     32 },
+	{ "n_qfull",        WATCH_DROPS,     32 },
+	{ "n_part_drop",    WATCH_DROPS,     32 },
+	{ "n_egr_disabled", WATCH_DROPS,     32 },
+	{ "n_not_reach",    WATCH_DROPS,     32 },
+};
+
+#define WATCH_SOURCE_COUNT ARRAY_SIZE(watch_sources)
+
+struct watch_port {
+	/* Position of each source in the port status fields,
+	 * looked up once since the layout does not change */
+	int      field_count;
+	int      source_index[WATCH_SOURCE_COUNT];
+	int      qlevel_index[WATCH_QUEUE_COUNT];
+	int      qlevel_hwm_index[WATCH_QUEUE_COUNT];
+	int      has_qlevel;
+	uint64_t prev[WATCH_SOURCE_COUNT];
+	uint64_t delta[WATCH_COUNTER_COUNT];
+	uint64_t qlevel[WATCH_QUEUE_COUNT];
+	uint64_t qlevel_hwm[WATCH_QUEUE_COUNT];
+};
+
+static void watch_port_resolve(struct watch_port *port,
+                               struct sja1105_status_fields *fields)
+{
+	char name[SJA1105_STATUS_NAME_SIZE];
+	unsigned int i;
+
+	for (i = 0; i < WATCH_SOURCE_COUNT; i++) {
+		port->source_index[i] = sja1105_status_field_index(fields,
+		                        watch_sources[i].name);
+	}
+	/* Queue levels are only reported by P/Q/R/S */
+	port->has_qlevel = 1;
+	for (i = 0; i < WATCH_QUEUE_COUNT; i++) {
+		snprintf(name, sizeof(name), "qlevel_%u", i);
+		port->qlevel_index[i] = sja1105_status_field_index(fields, name);
+		snprintf(name, sizeof(name), "qlevel_hwm_%u", i);
+		port->qlevel_hwm_index[i] = sja1105_status_field_index(fields,
+		                                                       name);
+		if (port->qlevel_index[i] < 0 || port->qlevel_hwm_index[i] < 0) {
+			port->has_qlevel = 0;
+		}
+	}
+	port->field_count = fields->count;
+}
+
+/* Difference between two readouts of a free-running counter
+ * that is width bits wide, across at most one wraparound */
+static uint64_t counter_delta(uint64_t cur, uint64_t prev, int width)
+{
+	uint64_t mask = (width == 64) ? ~0ull : (1ull << width) - 1;
+
+	return (cur - prev) & mask;
+}
+
+static void watch_port_update(struct watch_port *port,
+                              struct sja1105_status_fields *fields,
+                              int first)
+{
+	uint64_t value;
+	unsigned int i;
+	int k;
+
+	if (port->field_count != fields->count) {
+		watch_port_resolve(port, fields);
+	}
+	memset(port->delta, 0, sizeof(port->delta));
+	for (i = 0; i < WATCH_SOURCE_COUNT; i++) {
+		k = port->source_index[i];
+		if (k < 0) {
+			continue;
+		}
+		value = fields->values[k];
+		if (!first) {
+			port->delta[watch_sources[i].counter] +=
+				counter_delta(value, port->prev[i],
+				              watch_sources[i].width);
+		}
+		port->prev[i] = value;
+	}
+	for (i = 0; port->has_qlevel && i < WATCH_QUEUE_COUNT; i++) {
+		port->qlevel[i]     = fields->values[port->qlevel_index[i]];
+		port->qlevel_hwm[i] = fields->values[port->qlevel_hwm_index[i]];
+	}
+}
+
+static uint64_t rate(uint64_t delta, double elapsed)
+{
+	return (uint64_t) (delta / elapsed + 0.5);
+}
+
+static void watch_text_show(struct watch_port *ports, int first, int last,
+                            double elapsed)
+{
+	struct watch_port *port;
+	uint64_t qlevel, hwm;
+	int i, j;
+
+	if (isatty(STDOUT_FILENO)) {
+		/* Redraw in place */
+		printf("\033[H\033[2J");
+	}
+	printf("%-4s %12s %14s %12s %14s %8s %8s %8s\n", "PORT",
+	       "RX_FRAMES/S", "RX_BYTES/S", "TX_FRAMES/S", "TX_BYTES/S",
+	       "DROPS", "DROPS/S", "QLEVEL");
+	for (i = first; i <= last; i++) {
+		port = &ports[i];
+		printf("%-4d %12" PRIu64 " %14" PRIu64 " %12" PRIu64
+		       " %14" PRIu64 " %8" PRIu64 " %8" PRIu64, i,
+		       rate(port->delta[WATCH_RX_FRAMES], elapsed),
+		       rate(port->delta[WATCH_RX_BYTES], elapsed),
+		       rate(port->delta[WATCH_TX_FRAMES], elapsed),
+		       rate(port->delta[WATCH_TX_BYTES], elapsed),
+		       port->delta[WATCH_DROPS],
+		       rate(port->delta[WATCH_DROPS], elapsed));
+		if (!port->has_qlevel) {
+			printf(" %8s\n", "-");
+			continue;
+		}
+		/* Current fill summed over the queues, and the
+		 * highest high-water mark */
+		for (qlevel = hwm = 0, j = 0; j < WATCH_QUEUE_COUNT; j++) {
+			qlevel += port->qlevel[j];
+			if (hwm < port->qlevel_hwm[j]) {
+				hwm = port->qlevel_hwm[j];
+			}
+		}
+		printf(" %4" PRIu64 "/%-4" PRIu64 "\n", qlevel, hwm);
+	}
+	fflush(stdout);
+}
+
+static void watch_port_output(struct sja1105_output *out,
+                              struct watch_port *port, int index,
+                              double elapsed, uint64_t timestamp_ms)
+{
+	char name[32];
+	int i;
+
+	sja1105_output_record_begin(out);
+	if (out->format != SJA1105_OUTPUT_JSON) {
+		/* Rows of all samples share one table */
+		sja1105_output_u64(out, "timestamp_ms", timestamp_ms);
+	}
+	sja1105_output_u64(out, "port", index);
+	for (i = 0; i < WATCH_COUNTER_COUNT; i++) {
+		sja1105_output_u64(out, watch_counter_names[i], port->delta[i]);
+		snprintf(name, sizeof(name), "%s_rate", watch_counter_names[i]);
+		sja1105_output_u64(out, name, rate(port->delta[i], elapsed));
+	}
+	if (port->has_qlevel) {
+		sja1105_output_array(out, "qlevel", port->qlevel,
+		                     WATCH_QUEUE_COUNT);
+		sja1105_output_array(out, "qlevel_hwm", port->qlevel_hwm,
+		                     WATCH_QUEUE_COUNT);
+	} else {
+		sja1105_output_none(out, "qlevel");
+		sja1105_output_none(out, "qlevel_hwm");
+	}
+	sja1105_output_record_end(out);
+}
+
+static double timespec_diff(struct timespec *a, struct timespec *b)
+{
+	return (a->tv_sec - b->tv_sec) + (a->tv_nsec - b->tv_nsec) / 1e9;
+}
+
+static void timespec_add(struct timespec *ts, double seconds)
+{
+	long long nsec = ts->tv_nsec + (long long) (seconds * 1e9);
+
+	ts->tv_sec  += nsec / 1000000000;
+	ts->tv_nsec  = nsec % 1000000000;
+}
+
+/* Samples the port status every interval seconds until interrupted,
+ * and prints what changed since the previous sample. */
+int status_ports_watch(struct sja1105_spi_setup *spi_setup, int port_no,
+                       double interval, enum sja1105_output_format format)
+{
+	static struct sja1105_output output;
+	static struct watch_port ports[WATCH_PORT_COUNT];
+	struct sja1105_status_fields fields;
+	struct timespec next, now, prev;
+	struct timespec wall;
+	uint64_t timestamp_ms;
+	double elapsed;
+	int first = (port_no == -1) ? 0 : port_no;
+	int last  = (port_no == -1) ? WATCH_PORT_COUNT - 1 : port_no;
+	int sample;
+	int rc = 0;
+	int i;
+
+	if (first < 0 || last >= WATCH_PORT_COUNT) {
+		loge("invalid port number %d", port_no);
+		return -EINVAL;
+	}
+	if (interval < 0.01) {
+		loge("Watch interval must be at least 0.01 seconds");
+		return -EINVAL;
+	}
+	/* Keep the sysfs files open in between samples */
+	sysfs_fd_cache_enable();
+	memset(ports, 0, sizeof(ports));
+	if (format == SJA1105_OUTPUT_JSON) {
+		/* One line per sample */
+		output.compact = 1;
+	} else if (format != SJA1105_OUTPUT_TEXT) {
+		sja1105_output_begin(&output, format);
+		sja1105_output_section_begin(&output, "ports", NULL);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	prev = next;
+	for (sample = 0; ; sample++) {
+		for (i = first; i <= last; i++) {
+			rc = sja1105_port_status_read(spi_setup, i, &fields);
+			if (rc < 0) {
+				loge("sja1105_port_status_get failed");
+				goto out;
+			}
+			watch_port_update(&ports[i], &fields, sample == 0);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		elapsed = timespec_diff(&now, &prev);
+		prev = now;
+		if (sample == 0) {
+			/* Nothing to compare against yet */
+		} else if (format == SJA1105_OUTPUT_TEXT) {
+			watch_text_show(ports, first, last, elapsed);
+		} else {
+			clock_gettime(CLOCK_REALTIME, &wall);
+			timestamp_ms = (uint64_t) wall.tv_sec * 1000 +
+			               wall.tv_nsec / 1000000;
+			if (format == SJA1105_OUTPUT_JSON) {
+				sja1105_output_begin(&output, format);
+				sja1105_output_u64(&output, "timestamp_ms",
+				                   timestamp_ms);
+				sja1105_output_u64(&output, "elapsed_us",
+				                   (uint64_t) (elapsed * 1e6));
+				sja1105_output_section_begin(&output, "ports",
+				                             NULL);
+			}
+			for (i = first; i <= last; i++) {
+				watch_port_output(&output, &ports[i], i,
+				                  elapsed, timestamp_ms);
+			}
+			if (format == SJA1105_OUTPUT_JSON) {
+				sja1105_output_section_end(&output);
+				sja1105_output_end(&output);
+			}
+			fflush(stdout);
+		}
+		/* Sleep until an absolute deadline, so that the time
+		 * spent reading does not make the samples drift */
+		timespec_add(&next, interval);
+		if (timespec_diff(&next, &now) < 0) {
+			/* Fell behind, do not try to catch up */
+			next = now;
+		}
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+		                       &next, NULL) == EINTR)
+			;
+	}
+out:
+	sysfs_fd_cache_release();
+	return rc;
+}
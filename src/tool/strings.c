@@ -210,6 +210,114 @@ out:
 	return rc;
 }
 
+/* Decimal number such as "12.5", multiplied by scale and rounded to the
+ * nearest integer. This is done in integer arithmetic, so that values
+ * such as rates and time intervals convert exactly whenever they can.
+ * If rounded is not NULL, it is set when the result is not exact.
+ */
+int reliable_fixed_from_string(uint64_t *to, const char *from,
+                               uint64_t scale, int *rounded)
+{
+	const char *p = from;
+	uint64_t whole = 0;
+	uint64_t frac = 0;
+	uint64_t div = 1;
+	int inexact = 0;
+	int digits = 0;
+
+	for (; isdigit(*p); p++, digits++) {
+		if (whole > (UINT64_MAX - 9) / 10) {
+			goto overflow;
+		}
+		whole = whole * 10 + (*p - '0');
+	}
+	if (*p == '.') {
+		for (p++; isdigit(*p); p++, digits++) {
+			if (div < 1000000000) {
+				frac = frac * 10 + (*p - '0');
+				div *= 10;
+			} else if (*p != '0') {
+				/* Beyond the precision we keep */
+				inexact = 1;
+			}
+		}
+	}
+	if (*p || digits == 0) {
+		loge("No decimal number stored at \"%s\"", from);
+		return -EINVAL;
+	}
+	if (scale && whole > UINT64_MAX / scale) {
+		goto overflow;
+	}
+	*to = whole * scale;
+	/* frac < div <= 10^9, so this cannot overflow for sane scales */
+	if ((frac * scale) % div) {
+		inexact = 1;
+	}
+	if (*to + (frac * scale + div / 2) / div < *to) {
+		goto overflow;
+	}
+	*to += (frac * scale + div / 2) / div;
+	if (rounded != NULL) {
+		*rounded = inexact;
+	}
+	return 0;
+overflow:
+	loge("Integer overflow occured while reading \"%s\"", from);
+	return -EOVERFLOW;
+}
+
+/* Parse a list of indices such as "0,2-4", or "all", into selected[],
+ * which has max elements. Returns the number of selected indices.
+ */
+int read_index_list(const char *list, uint8_t *selected, int max)
+{
+	const char *p = list;
+	char *end;
+	long first, last;
+	int count = 0;
+
+	memset(selected, 0, max);
+	if (strcmp(list, "all") == 0 || strcmp(list, "*") == 0) {
+		memset(selected, 1, max);
+		return max;
+	}
+	while (*p) {
+		first = strtol(p, &end, 0);
+		if (end == p) {
+			goto error;
+		}
+		last = first;
+		p = end;
+		if (*p == '-') {
+			p++;
+			last = strtol(p, &end, 0);
+			if (end == p) {
+				goto error;
+			}
+			p = end;
+		}
+		if (first < 0 || last >= max || first > last) {
+			goto error;
+		}
+		for (; first <= last; first++) {
+			count += !selected[first];
+			selected[first] = 1;
+		}
+		if (*p == ',') {
+			p++;
+		} else if (*p) {
+			goto error;
+		}
+	}
+	if (count) {
+		return count;
+	}
+error:
+	loge("Invalid list \"%s\", expected e.g. 0,2-%d or all", list, max - 1);
+	return -EINVAL;
+}
+
 int read_array(char *array_str, uint64_t *array_val, int max_count)
 {
 	int   count;
@@ -60,6 +60,7 @@ struct fields_set {
 	int debug;
 	int entries_per_line;
 	int screen_width;
+	int fsync;
 };
 
 static void
@@ -74,13 +75,14 @@ config_set_defaults(struct sja1105_spi_setup *spi_setup,
 		struct_ptr->field = value; \
 	}
 	SET_DEFAULT_VAL(spi_setup, device_id, default_device_id, logv, "0x%" PRIx64);
-	SET_DEFAULT_VAL(spi_setup, device, default_device, logi, "%s");
-	SET_DEFAULT_VAL(spi_setup, staging_area, default_staging_area, logi, "%s");
-	SET_DEFAULT_VAL(spi_setup, flush, 0, logi, "%d");
-	SET_DEFAULT_VAL(general_conf, verbose, 0, logi, "%d");
-	SET_DEFAULT_VAL(general_conf, debug, 0, logi, "%d");
-	SET_DEFAULT_VAL(general_conf, entries_per_line, 1, logi, "%d");
-	SET_DEFAULT_VAL(general_conf, screen_width, 80, logi, "%d");
+	SET_DEFAULT_VAL(spi_setup, device, default_device, logv, "%s");
+	SET_DEFAULT_VAL(spi_setup, staging_area, default_staging_area, logv, "%s");
+	SET_DEFAULT_VAL(spi_setup, flush, 0, logv, "%d");
+	SET_DEFAULT_VAL(general_conf, verbose, 0, logv, "%d");
+	SET_DEFAULT_VAL(general_conf, debug, 0, logv, "%d");
+	SET_DEFAULT_VAL(general_conf, entries_per_line, 1, logv, "%d");
+	SET_DEFAULT_VAL(general_conf, screen_width, 80, logv, "%d");
+	SET_DEFAULT_VAL(general_conf, fsync, 1, logv, "%d");
 }
 
 static inline int
@@ -167,6 +169,17 @@ parse_general_config(struct general_config *general_conf,
 		}
 		general_conf->screen_width = tmp;
 		fields_set->screen_width = 1;
+	} else if (strcmp(key, "fsync") == 0) {
+		if (strcmp(value, "false") == 0) {
+			general_conf->fsync = 0;
+		} else if (strcmp(value, "true") == 0) {
+			general_conf->fsync = 1;
+		} else {
+			loge("Invalid value \"%s\" for fsync. "
+			     "Expected true or false.", value);
+			return -1;
+		}
+		fields_set->fsync = 1;
 	} else {
 		loge("Invalid key \"%s\"", key);
 		return -1;
@@ -195,27 +208,100 @@ static inline int parse_key_val(struct sja1105_spi_setup *spi_setup,
 	return 0;
 }
 
+/* "[setup <name>]" starts the section of a named device. Returns its
+ * entry in the device list, adding it if it is new.
+ */
+static int
+device_section(struct sja1105_device_list *devices, char *section_hdr)
+{
+	char *name;
+	char *end;
+	int i;
+
+	name = section_hdr + strlen("[setup ");
+	end = strchr(name, ']');
+	if (end == NULL || end[1] != '\0') {
+		loge("Invalid section header \"%s\"", section_hdr);
+		return -EINVAL;
+	}
+	*end = '\0';
+	name = trimwhitespace(name);
+	if (strlen(name) == 0 || strcmp(name, "all") == 0) {
+		loge("Invalid device name \"%s\"", name);
+		return -EINVAL;
+	}
+	for (i = 0; i < devices->count; i++) {
+		if (strcmp(devices->devices[i].name, name) == 0) {
+			return i;
+		}
+	}
+	if (devices->count == SJA1105_MAX_DEVICES) {
+		loge("Too many devices, at most %d are supported",
+		     SJA1105_MAX_DEVICES);
+		return -ERANGE;
+	}
+	devices->devices[i].name = strdup(name);
+	devices->count++;
+	return i;
+}
+
+/* Named devices take the device_id and auto_flush of the [setup]
+ * section unless they override them. Each one has to point to its
+ * own switch and staging area, though.
+ */
+static int
+device_set_defaults(struct sja1105_device_list *devices,
+                    struct fields_set *device_fields,
+                    struct sja1105_spi_setup *spi_setup)
+{
+	struct sja1105_spi_setup *device;
+	int i;
+
+	for (i = 0; i < devices->count; i++) {
+		device = &devices->devices[i];
+		if (!device_fields[i].device ||
+		    !device_fields[i].staging_area) {
+			loge("Device %s: both device and staging_area "
+			     "must be set", device->name);
+			return -EINVAL;
+		}
+		if (!device_fields[i].device_id) {
+			device->device_id = spi_setup->device_id;
+		}
+		if (!device_fields[i].flush) {
+			device->flush = spi_setup->flush;
+		}
+	}
+	return 0;
+}
+
 int read_config_file(char *filename, struct sja1105_spi_setup *spi_setup,
+                     struct sja1105_device_list *devices,
                      struct general_config *general_conf)
 {
+	struct fields_set device_fields[SJA1105_MAX_DEVICES];
 	struct fields_set fields_set;
+	struct sja1105_spi_setup *setup = spi_setup;
+	struct fields_set *setup_fields = &fields_set;
 	char  line[MAX_LINE_SIZE];
 	int   line_num = 0;
-	int   rc;
+	int   rc = 0;
 	char *section_hdr = NULL;
 	char *key, *value;
 	char *p;
 	FILE *fd;
 
+	memset(spi_setup, 0, sizeof(*spi_setup));
+	memset(general_conf, 0, sizeof(*general_conf));
+	memset(&fields_set, 0, sizeof(fields_set));
+	memset(devices, 0, sizeof(*devices));
+	memset(device_fields, 0, sizeof(device_fields));
 	fd = fopen(filename, "r");
 	if (!fd) {
 		printf("%s not present, loading default config\n", filename);
 		rc = -ENOENT;
 		goto default_conf;
 	}
-	memset(spi_setup, 0, sizeof(*spi_setup));
-	memset(general_conf, 0, sizeof(*general_conf));
-	memset(&fields_set, 0, sizeof(fields_set));
 	while (fgets(line, MAX_LINE_SIZE, fd)) {
 		p = trimwhitespace(line);
 		if (strlen(p) == 0 || p == NULL) {
@@ -227,6 +313,18 @@ int read_config_file(char *filename, struct sja1105_spi_setup *spi_setup,
 				free(section_hdr);
 			}
 			section_hdr = strdup(p);
+			setup = spi_setup;
+			setup_fields = &fields_set;
+			if (strncmp(p, "[setup ", strlen("[setup ")) == 0) {
+				rc = device_section(devices, p);
+				if (rc < 0) {
+					goto out;
+				}
+				setup = &devices->devices[rc];
+				setup_fields = &device_fields[rc];
+				/* Same keys as in [setup] */
+				strcpy(section_hdr, "[setup]");
+			}
 			continue;
 		}
 		if (p[0] == '#') {
@@ -244,8 +342,8 @@ int read_config_file(char *filename, struct sja1105_spi_setup *spi_setup,
 		}
 		key   = trimwhitespace(p);
 		value = trimwhitespace(value);
-		rc = parse_key_val(spi_setup, general_conf,
-		                   key, value, section_hdr, &fields_set);
+		rc = parse_key_val(setup, general_conf,
+		                   key, value, section_hdr, setup_fields);
 		if (rc < 0) {
 			loge("Could not parse line %d: \"%s\"", line_num, line);
 			rc = -EINVAL;
@@ -265,6 +363,16 @@ default_conf:
 		 * entries not specified in the config file. */
 	}
 	config_set_defaults(spi_setup, general_conf, &fields_set);
+	if (device_set_defaults(devices, device_fields, spi_setup) < 0) {
+		/* Better no named devices than half-configured ones */
+		for (rc = 0; rc < devices->count; rc++) {
+			free((char*) devices->devices[rc].name);
+			free((char*) devices->devices[rc].device);
+			free((char*) devices->devices[rc].staging_area);
+		}
+		memset(devices, 0, sizeof(*devices));
+		rc = -EINVAL;
+	}
 	return rc;
 }
 
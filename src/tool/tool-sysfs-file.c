@@ -34,9 +34,103 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
 #include <common.h>
 #include "internal.h"
 
+/* When enabled (by long-running users such as the daemon), sysfs
+ * attributes are opened once and then accessed with pread/pwrite
+ * at offset 0, which makes the kernel regenerate the attribute
+ * contents on every read. Enabling is counted, so that a command
+ * run inside the daemon (e.g. status --watch) does not close the
+ * daemon's files when it returns.
+ */
+#define SYSFS_FD_CACHE_SIZE 16
+
+static struct sysfs_fd_cache_entry {
+	char file_name[PATH_MAX];
+	int  flags;
+	int  fd;
+} sysfs_fd_cache[SYSFS_FD_CACHE_SIZE];
+static int sysfs_fd_cache_count;
+static int sysfs_fd_cache_enabled;
+/* Parallel uploads (--device all) write config_upload from
+ * several threads, possibly inside the daemon */
+static pthread_mutex_t sysfs_fd_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void sysfs_fd_cache_enable(void)
+{
+	pthread_mutex_lock(&sysfs_fd_cache_lock);
+	sysfs_fd_cache_enabled++;
+	pthread_mutex_unlock(&sysfs_fd_cache_lock);
+}
+
+/* Undo one sysfs_fd_cache_enable(). The files are closed
+ * once the last user is gone. */
+void sysfs_fd_cache_release(void)
+{
+	int i;
+
+	pthread_mutex_lock(&sysfs_fd_cache_lock);
+	if (sysfs_fd_cache_enabled == 0 || --sysfs_fd_cache_enabled) {
+		goto out;
+	}
+	for (i = 0; i < sysfs_fd_cache_count; i++) {
+		close(sysfs_fd_cache[i].fd);
+	}
+	sysfs_fd_cache_count = 0;
+out:
+	pthread_mutex_unlock(&sysfs_fd_cache_lock);
+}
+
+static int sysfs_open(const char *file_name, int flags)
+{
+	struct sysfs_fd_cache_entry *entry;
+	int fd;
+	int i;
+
+	pthread_mutex_lock(&sysfs_fd_cache_lock);
+	if (!sysfs_fd_cache_enabled) {
+		fd = open(file_name, flags);
+		goto out;
+	}
+	for (i = 0; i < sysfs_fd_cache_count; i++) {
+		entry = &sysfs_fd_cache[i];
+		if (entry->flags == flags &&
+		    strcmp(entry->file_name, file_name) == 0) {
+			fd = entry->fd;
+			goto out;
+		}
+	}
+	fd = open(file_name, flags);
+	if (fd < 0 || sysfs_fd_cache_count == SYSFS_FD_CACHE_SIZE) {
+		goto out;
+	}
+	entry = &sysfs_fd_cache[sysfs_fd_cache_count++];
+	snprintf(entry->file_name, PATH_MAX, "%s", file_name);
+	entry->flags = flags;
+	entry->fd    = fd;
+out:
+	pthread_mutex_unlock(&sysfs_fd_cache_lock);
+	return fd;
+}
+
+static void sysfs_close(int fd)
+{
+	int i;
+
+	pthread_mutex_lock(&sysfs_fd_cache_lock);
+	for (i = 0; i < sysfs_fd_cache_count; i++) {
+		if (sysfs_fd_cache[i].fd == fd) {
+			goto out;
+		}
+	}
+	close(fd);
+out:
+	pthread_mutex_unlock(&sysfs_fd_cache_lock);
+}
+
 /*
  * Read data from a sysfs file.
  * return: >0: number of bytes read, -1: failed
@@ -46,26 +140,29 @@ int sysfs_read(struct sja1105_spi_setup *spi_setup, char* name,
 {
 	int rc;
 	int fd;
+	int prof;
 	char file_name[PATH_MAX];
 
+	prof = sja1105_profile_begin("sysfs-read", name);
 	snprintf(file_name, PATH_MAX, "%s/%s",
 	         spi_setup->device, name);
-	fd = open(file_name, O_RDONLY);
+	fd = sysfs_open(file_name, O_RDONLY);
 	if (fd < 0) {
 		logv("%s: could not open file %s", __FUNCTION__, file_name);
 		rc = -1;
 		goto out;
 	}
 
-	rc = read(fd, buf, len);
+	rc = pread(fd, buf, len, 0);
 	if (rc <= 0) {
 		logv("%s: could not read file %s", __FUNCTION__, file_name);
 		rc = -1;
 		goto out_close;
 	}
 out_close:
-	close(fd);
+	sysfs_close(fd);
 out:
+	sja1105_profile_end(prof);
 	return rc;
 }
 
@@ -78,18 +175,21 @@ int sysfs_write(struct sja1105_spi_setup *spi_setup, char* name,
 {
 	int rc;
 	int fd;
+	int prof;
 	char file_name[PATH_MAX];
 
+	/* A write to config_upload blocks for the whole upload */
+	prof = sja1105_profile_begin("sysfs-write", name);
 	snprintf(file_name, PATH_MAX, "%s/%s",
 	         spi_setup->device, name);
-	fd = open(file_name, O_WRONLY);
+	fd = sysfs_open(file_name, O_WRONLY);
 	if (fd < 0) {
 		logv("%s: could not open file %s", __FUNCTION__, file_name);
 		rc = -1;
 		goto out;
 	}
 
-	rc = write(fd, buf, len);
+	rc = pwrite(fd, buf, len, 0);
 	if (rc != (int)len) {
 		logv("%s: could not write file %s", __FUNCTION__, file_name);
 		rc = -1;
@@ -97,7 +197,72 @@ int sysfs_write(struct sja1105_spi_setup *spi_setup, char* name,
 	}
 	rc = 0;
 out_close:
-	close(fd);
+	sysfs_close(fd);
 out:
+	sja1105_profile_end(prof);
 	return rc;
 }
+
+/*
+ * Read or write a range of a binary sysfs file. These transfer at most
+ * a page per system call, so loop until done.
+ * Return: number of bytes transferred (less than len only at the end of
+ *         the file), -errno: failed
+ */
+static ssize_t
+sysfs_access_at(struct sja1105_spi_setup *spi_setup, char *name,
+                char *buf, size_t len, off_t offset, int write)
+{
+	char file_name[PATH_MAX];
+	size_t done = 0;
+	ssize_t rc;
+	int prof;
+	int fd;
+
+	prof = sja1105_profile_begin(write ? "sysfs-write" : "sysfs-read",
+	                             name);
+	snprintf(file_name, PATH_MAX, "%s/%s",
+	         spi_setup->device, name);
+	fd = sysfs_open(file_name, write ? O_WRONLY : O_RDONLY);
+	if (fd < 0) {
+		rc = -errno;
+		logv("%s: could not open file %s", __FUNCTION__, file_name);
+		goto out;
+	}
+	while (done < len) {
+		if (write) {
+			rc = pwrite(fd, buf + done, len - done, offset + done);
+		} else {
+			rc = pread(fd, buf + done, len - done, offset + done);
+		}
+		if (rc < 0) {
+			rc = -errno;
+			logv("%s: could not access file %s at 0x%lx",
+			     __FUNCTION__, file_name,
+			     (unsigned long) (offset + done));
+			goto out_close;
+		}
+		if (rc == 0) {
+			break;
+		}
+		done += rc;
+	}
+	rc = done;
+out_close:
+	sysfs_close(fd);
+out:
+	sja1105_profile_end(prof);
+	return rc;
+}
+
+ssize_t sysfs_read_at(struct sja1105_spi_setup *spi_setup, char *name,
+                      char *buf, size_t len, off_t offset)
+{
+	return sysfs_access_at(spi_setup, name, buf, len, offset, 0);
+}
+
+ssize_t sysfs_write_at(struct sja1105_spi_setup *spi_setup, char *name,
+                       char *buf, size_t len, off_t offset)
+{
+	return sysfs_access_at(spi_setup, name, buf, len, offset, 1);
+}
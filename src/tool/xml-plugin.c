@@ -0,0 +1,97 @@
+/******************************************************************************
+ * Copyright (c) 2017, NXP Semiconductors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include "xml/read/external.h"
+#include <common.h>
+
+/* XML import is the only user of libxml2, which with its own dependencies
+ * takes a noticeable share of the startup time of every command on slow
+ * flash. It is therefore built as a plugin, and only loaded by the
+ * commands that read XML. SJA1105_PLUGIN_DIR in the environment
+ * overrides where it is looked for, e.g. to run from the build tree.
+ */
+#ifndef SJA1105_PLUGIN_DIR
+#define SJA1105_PLUGIN_DIR "/usr/lib/sja1105"
+#endif
+
+static sja1105_xml_plugin_read_t *xml_plugin_read(void)
+{
+	static sja1105_xml_plugin_read_t *read;
+	char path[MAX_LINE_SIZE];
+	const char *dir;
+	void *handle;
+	int prof;
+
+	if (read != NULL) {
+		return read;
+	}
+	dir = getenv("SJA1105_PLUGIN_DIR");
+	if (dir == NULL || *dir == '\0') {
+		dir = SJA1105_PLUGIN_DIR;
+	}
+	snprintf(path, sizeof(path), "%s/%s", dir, SJA1105_XML_PLUGIN);
+	prof = sja1105_profile_begin("xml-plugin", NULL);
+	handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+	sja1105_profile_end(prof);
+	if (handle == NULL) {
+		loge("XML support is not available: %s", dlerror());
+		return NULL;
+	}
+	read = (sja1105_xml_plugin_read_t*) dlsym(handle,
+	                                          SJA1105_XML_PLUGIN_READ);
+	if (read == NULL) {
+		loge("%s: %s", path, dlerror());
+		dlclose(handle);
+	}
+	return read;
+}
+
+int
+sja1105_staging_area_read_xml(const char *xml_file,
+                              struct sja1105_staging_area *staging_area,
+                              int merge, int jobs)
+{
+	sja1105_xml_plugin_read_t *read = xml_plugin_read();
+
+	if (read == NULL) {
+		return -ENOSYS;
+	}
+	return read(xml_file, staging_area, merge, jobs);
+}
+
+int
+sja1105_staging_area_from_xml(const char *xml_file,
+                              struct sja1105_staging_area *staging_area)
+{
+	return sja1105_staging_area_read_xml(xml_file, staging_area, 0, 1);
+}
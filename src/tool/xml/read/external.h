@@ -31,8 +31,19 @@
 #ifndef _CONFIG_XML_READ_EXTERNAL_H
 #define _CONFIG_XML_READ_EXTERNAL_H
 
-#include "internal.h"
+/* No libxml2 here: the reader is a plugin, loaded by xml-plugin.c
+ * the first time an XML file is read */
+#include <tool/internal.h>
 
 int sja1105_staging_area_from_xml(const char*, struct sja1105_staging_area*);
+int sja1105_staging_area_read_xml(const char*, struct sja1105_staging_area*,
+                                  int merge, int jobs);
+
+/* Implemented by the plugin */
+#define SJA1105_XML_PLUGIN      "sja1105-xml.so"
+#define SJA1105_XML_PLUGIN_READ "sja1105_xml_plugin_read"
+typedef int sja1105_xml_plugin_read_t(const char*,
+                                      struct sja1105_staging_area*,
+                                      int merge, int jobs);
 
 #endif
@@ -35,33 +35,14 @@
 #include <string.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 /* These are our include files */
 #include <lib/include/static-config.h>
 #include <common.h>
 /* This is the top-level _SJA1105_TOOL_INTERNAL header */
 #include <tool/internal.h>
+#include "external.h"
 
-int schedule_table_parse(xmlNode*, struct sja1105_static_config*);
-int schedule_entry_points_table_parse(xmlNode*, struct sja1105_static_config*);
-int schedule_entry_points_parameters_table_parse(xmlNode*, struct sja1105_static_config*);
-int vl_lookup_table_parse(xmlNode*, struct sja1105_static_config*);
-int vl_policing_table_parse(xmlNode*, struct sja1105_static_config*);
-int vl_forwarding_table_parse(xmlNode*, struct sja1105_static_config*);
-int l2_address_lookup_table_parse(xmlNode*, struct sja1105_static_config*);
-int l2_policing_table_parse(xmlNode*, struct sja1105_static_config*);
-int vlan_lookup_table_parse(xmlNode*, struct sja1105_static_config*);
-int l2_forwarding_table_parse(xmlNode*, struct sja1105_static_config*);
-int mac_configuration_table_parse(xmlNode*, struct sja1105_static_config*);
-int schedule_parameters_table_parse(xmlNode*, struct sja1105_static_config*);
-int schedule_entry_points_parameters_parse(xmlNode*, struct sja1105_static_config*);
-int vl_fw_params_table_parse(xmlNode*, struct sja1105_static_config*);
-int l2_address_lookup_parameters_table_parse(xmlNode*, struct sja1105_static_config*);
-int l2_forwarding_parameters_table_parse(xmlNode*, struct sja1105_static_config*);
-int avb_parameters_table_parse(xmlNode*, struct sja1105_static_config*);
-int clock_synchronization_parameters_table_parse(xmlNode*, struct sja1105_static_config*);
-int general_parameters_table_parse(xmlNode*, struct sja1105_static_config*);
-int retagging_table_parse(xmlNode*, struct sja1105_static_config*);
-int xml_read_field(void*, char*, xmlNode*);
-int xml_read_array(void*, int, char*, xmlNode*);
+sja1105_xml_plugin_read_t sja1105_xml_plugin_read;
 
 #endif
@@ -33,6 +33,7 @@
 
 #include "internal.h"
 
-int sja1105_staging_area_to_xml(char*, struct sja1105_staging_area*);
+int sja1105_staging_area_to_xml(const char*, struct sja1105_staging_area*,
+                                int compact);
 
 #endif
@@ -32,7 +32,6 @@
 #define _CONFIG_XML_WRITE_INTERNAL
 
 #include <stdio.h>
-#include <libxml/xmlwriter.h>
 #include <stdint.h>
 #include <inttypes.h>
 /* These are our include files */
@@ -41,27 +40,4 @@
 /* This is the top-level _SJA1105_TOOL_INTERNAL header */
 #include <tool/internal.h>
 
-int xml_write_field(xmlTextWriterPtr, char*, uint64_t);
-int xml_write_array(xmlTextWriterPtr, char*, uint64_t*, int);
-int schedule_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int schedule_entry_points_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int schedule_entry_points_parameters_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int vl_lookup_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int vl_policing_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int vl_forwarding_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int l2_address_lookup_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int l2_policing_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int vlan_lookup_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int l2_forwarding_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int mac_configuration_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int schedule_parameters_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int schedule_entry_points_parameters_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int vl_forwarding_parameters_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int l2_address_lookup_parameters_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int l2_forwarding_parameters_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int avb_parameters_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int clock_synchronization_parameters_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int general_parameters_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-int retagging_table_write(xmlTextWriterPtr, struct sja1105_static_config *config);
-
 #endif
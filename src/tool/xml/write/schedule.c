@@ -1,62 +0,0 @@
-/******************************************************************************
- * Copyright (c) 2016, NXP Semiconductors
- * All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are met:
- *
- * 1. Redistributions of source code must retain the above copyright notice,
- * this list of conditions and the following disclaimer.
- *
- * 2. Redistributions in binary form must reproduce the above copyright notice,
- * this list of conditions and the following disclaimer in the documentation
- * and/or other materials provided with the distribution.
- *
- * 3. Neither the name of the copyright holder nor the names of its
- * contributors may be used to endorse or promote products derived from this
- * software without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
- * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
- * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
- * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
- * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
- * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
- * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
- * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
- * POSSIBILITY OF SUCH DAMAGE.
- *****************************************************************************/
-#include "internal.h"
-
-int
-schedule_table_write(xmlTextWriterPtr writer,
-                     struct sja1105_static_config *config)
-{
-	int rc = 0;
-	int i;
-
-	logv("writing %d Schedule entries", config->schedule_count);
-	for (i = 0; i < config->schedule_count; i++) {
-		rc |= xmlTextWriterStartElement(writer, BAD_CAST "entry");
-		rc |= xml_write_field(writer, "index",       i);
-		rc |= xml_write_field(writer, "winstindex",  config->schedule[i].winstindex);
-		rc |= xml_write_field(writer, "winend",      config->schedule[i].winend);
-		rc |= xml_write_field(writer, "winst",       config->schedule[i].winst);
-		rc |= xml_write_field(writer, "destports",   config->schedule[i].destports);
-		rc |= xml_write_field(writer, "setvalid",    config->schedule[i].setvalid);
-		rc |= xml_write_field(writer, "txen",        config->schedule[i].txen);
-		rc |= xml_write_field(writer, "resmedia_en", config->schedule[i].resmedia_en);
-		rc |= xml_write_field(writer, "resmedia",    config->schedule[i].resmedia);
-		rc |= xml_write_field(writer, "vlindex",     config->schedule[i].vlindex);
-		rc |= xml_write_field(writer, "delta",       config->schedule[i].delta);
-		rc |= xmlTextWriterEndElement(writer);
-		if (rc < 0) {
-			loge("error while writing Schedule Table element %d", i);
-			return -EINVAL;
-		}
-	}
-	return 0;
-}
-
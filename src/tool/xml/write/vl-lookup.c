@@ -1,67 +0,0 @@
-/******************************************************************************
- * Copyright (c) 2017, NXP Semiconductors
- * All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are met:
- *
- * 1. Redistributions of source code must retain the above copyright notice,
- * this list of conditions and the following disclaimer.
- *
- * 2. Redistributions in binary form must reproduce the above copyright notice,
- * this list of conditions and the following disclaimer in the documentation
- * and/or other materials provided with the distribution.
- *
- * 3. Neither the name of the copyright holder nor the names of its
- * contributors may be used to endorse or promote products derived from this
- * software without specific prior written permission.
- *
- * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
- * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
- * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
- * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
- * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
- * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
- * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
- * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
- * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
- * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
- * POSSIBILITY OF SUCH DAMAGE.
- *****************************************************************************/
-#include "internal.h"
-
-int
-vl_lookup_table_write(xmlTextWriterPtr writer,
-                      struct sja1105_static_config *config)
-{
-	struct sja1105_vl_lookup_entry *entry;
-	int rc = 0;
-	int i;
-
-	logv("writing %d VL Lookup entries", config->vl_lookup_count);
-	for (i = 0; i < config->vl_lookup_count; i++) {
-		rc |= xmlTextWriterStartElement(writer, BAD_CAST "entry");
-		rc |= xml_write_field(writer, "index", i);
-		entry = &config->vl_lookup[i];
-		if (entry->format == 0) {
-			rc |= xml_write_field(writer, "destports",  entry->destports);
-			rc |= xml_write_field(writer, "iscritical", entry->iscritical);
-			rc |= xml_write_field(writer, "macaddr",    entry->macaddr);
-			rc |= xml_write_field(writer, "vlanid",     entry->vlanid);
-			rc |= xml_write_field(writer, "port",       entry->port);
-			rc |= xml_write_field(writer, "vlanprior",  entry->vlanprior);
-		} else {
-			rc |= xml_write_field(writer, "egrmirr",    entry->egrmirr);
-			rc |= xml_write_field(writer, "ingrmirr",   entry->ingrmirr);
-			rc |= xml_write_field(writer, "vlid",       entry->vlid);
-			rc |= xml_write_field(writer, "port",       entry->port);
-		}
-		rc |= xmlTextWriterEndElement(writer);
-		if (rc < 0) {
-			loge("error while writing VL Lookup Table element %d", i);
-			return -EINVAL;
-		}
-	}
-	return 0;
-}
-